@@ -0,0 +1,208 @@
+#pragma once
+#ifndef SQBRA_BITMATRIX_H
+#define SQBRA_BITMATRIX_H
+
+/*
+ *  BITMATRIX.H
+ *  This file declares the bit matrix type of the SquareBracket language and its commands. Every entry is one bit
+ *  (0 or 1) and every row is a run of 64-bit words, so a matrix needs 64 (double) or 128 (long double) times less
+ *  memory than a matrix of numbers. The commands work on whole words: 64 entries with one instruction.
+ *  The bits behind the last column of a row are always zero. The header is shared by the interpreter and programs
+ *  translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Names.h"
+
+const size_t BITMATRIX_PARALLEL = 1 << 20; // bit matrices with fewer entries are processed by one thread
+
+struct BitMatrix {
+    std::vector<uint64_t> words;
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t stride = 0; // number of words of a row
+
+    //! Pointer to the First Word of a Row
+    uint64_t* row(size_t i){ return words.data() + i * stride; }
+    const uint64_t* row(size_t i) const { return words.data() + i * stride; }
+
+    //! Check Whether the Indices Address an Entry of the Matrix
+    bool contains(int i, int j) const { return i >= 0 && j >= 0 && (size_t)i < rows && (size_t)j < cols; }
+
+    //! Entry Without Bounds Check
+    bool get(size_t i, size_t j) const { return (words[i * stride + j / 64] >> (j % 64)) & 1; }
+
+    //! Set an Entry Without Bounds Check
+    void set(size_t i, size_t j, bool value){
+        uint64_t bit = uint64_t(1) << (j % 64);
+        uint64_t& word = words[i * stride + j / 64];
+        word = value ? word | bit : word & ~bit;
+    }
+
+    //! Bits of the Last Word of a Row that Belong to the Matrix
+    uint64_t lastMask() const { return cols % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (cols % 64)) - 1; }
+
+    //! Exchange the Entries and Dimensions with Another Bit Matrix
+    void swap(BitMatrix& other){
+        words.swap(other.words);
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(stride, other.stride);
+    }
+
+    //! Change the Dimensions; Existing Entries Keep Their Position, New Entries are Zero
+    void resize(size_t newRows, size_t newCols){
+        BitMatrix result;
+        result.rows = newRows;
+        result.cols = newCols;
+        result.stride = (newCols + 63) / 64;
+        result.words.assign(newRows * result.stride, 0);
+        size_t keep = std::min(stride, result.stride);
+        for(size_t i = 0; i < rows && i < newRows && keep > 0; i++){
+            std::copy(row(i), row(i) + keep, result.row(i));
+            result.row(i)[keep - 1] &= result.lastMask();
+        }
+        swap(result);
+    }
+};
+
+//! Operation of bmand, bmor and bmxor
+enum class BitOp { AND, OR, XOR };
+
+//! Terminate if Two Bit Matrices Differ in their Dimensions
+inline void checkSameDimensions(const BitMatrix* a, const BitMatrix* b){
+    if(a->rows != b->rows || a->cols != b->cols){
+        std::cerr << "Error: bit matrices <" << containerName(a) << "> and <" << containerName(b) << "> differ in their dimensions (" << a->rows << "x" << a->cols << " and " << b->rows << "x" << b->cols << ")." << std::endl;
+        exit(0);
+    }
+}
+
+//! Give dst the Dimensions of src
+inline void shapeLike(BitMatrix* dst, const BitMatrix* src){
+    if(dst->rows != src->rows || dst->cols != src->cols){
+        dst->resize(src->rows, src->cols);
+    }
+}
+
+//! dst = a op b for Two Bit Matrices of the Same Dimensions
+inline void bitsBinary(BitMatrix* dst, const BitMatrix* a, const BitMatrix* b, BitOp op){
+    checkSameDimensions(a, b);
+    shapeLike(dst, a);
+    const uint64_t* x = a->words.data();
+    const uint64_t* y = b->words.data();
+    uint64_t* out = dst->words.data();
+    size_t n = a->words.size();
+    switch(op){
+        case BitOp::AND: for(size_t k = 0; k < n; k++){ out[k] = x[k] & y[k]; } break;
+        case BitOp::OR: for(size_t k = 0; k < n; k++){ out[k] = x[k] | y[k]; } break;
+        case BitOp::XOR: for(size_t k = 0; k < n; k++){ out[k] = x[k] ^ y[k]; } break;
+    }
+}
+
+//! dst = not src (the Bits Behind the Last Column Stay Zero)
+inline void bitsNot(BitMatrix* dst, const BitMatrix* src){
+    shapeLike(dst, src);
+    for(size_t k = 0; k < src->words.size(); k++){
+        dst->words[k] = ~src->words[k];
+    }
+    if(dst->stride > 0){
+        for(size_t i = 0; i < dst->rows; i++){
+            dst->row(i)[dst->stride - 1] &= dst->lastMask();
+        }
+    }
+}
+
+//! Number of Entries that are 1
+inline size_t bitsCount(const BitMatrix* bits){
+    size_t count = 0;
+    for(uint64_t word : bits->words){
+        count += (size_t)__builtin_popcountll(word);
+    }
+    return count;
+}
+
+//! Add One Bit per Entry to the Bit-Sliced Counters s0 ... s3 (Entry Counts 0 ... 15)
+inline void bitsAdd(uint64_t x, uint64_t& s0, uint64_t& s1, uint64_t& s2, uint64_t& s3){
+    uint64_t carry = s0 & x;
+    s0 ^= x;
+    uint64_t carry2 = s1 & carry;
+    s1 ^= carry;
+    s3 |= s2 & carry2;
+    s2 ^= carry2;
+}
+
+//! Add the Left, Right and (center) Middle Neighbours of a Word of a Row to the Counters
+inline void bitsAddRow(const uint64_t* row, size_t w, size_t stride, bool center, uint64_t& s0, uint64_t& s1, uint64_t& s2, uint64_t& s3){
+    uint64_t word = row[w];
+    uint64_t previous = w > 0 ? row[w - 1] : 0;
+    uint64_t next = w + 1 < stride ? row[w + 1] : 0;
+    bitsAdd((word << 1) | (previous >> 63), s0, s1, s2, s3); // bit j holds the entry of column j - 1
+    bitsAdd((word >> 1) | (next << 63), s0, s1, s2, s3);     // bit j holds the entry of column j + 1
+    if(center){
+        bitsAdd(word, s0, s1, s2, s3);
+    }
+}
+
+//! dst[i][j] = 1 if the Number of the 8 Neighbours of src[i][j] that are 1 is in counts (Bit c of counts for c Neighbours)
+//! Neighbours outside the matrix are 0; dst may be src
+template<typename Runner>
+void bitsNeighbours(BitMatrix* dst, const BitMatrix* src, unsigned counts, size_t threads, const Runner& run){
+    if(dst == src){
+        BitMatrix result;
+        bitsNeighbours(&result, src, counts, threads, run);
+        dst->swap(result);
+        return;
+    }
+    shapeLike(dst, src);
+    size_t rows = src->rows;
+    size_t stride = src->stride;
+    if(rows == 0 || stride == 0){
+        return;
+    }
+    std::vector<unsigned> selected;
+    for(unsigned c = 0; c <= 8; c++){
+        if(counts & (1u << c)){
+            selected.push_back(c);
+        }
+    }
+    size_t tasks = rows * src->cols < BITMATRIX_PARALLEL ? 1 : std::min(rows, 4 * threads);
+    run(tasks, [&](size_t task){
+        for(size_t i = task * rows / tasks; i < (task + 1) * rows / tasks; i++){
+            uint64_t* out = dst->row(i);
+            for(size_t w = 0; w < stride; w++){
+                uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                if(i > 0){
+                    bitsAddRow(src->row(i - 1), w, stride, true, s0, s1, s2, s3);
+                }
+                bitsAddRow(src->row(i), w, stride, false, s0, s1, s2, s3);
+                if(i + 1 < rows){
+                    bitsAddRow(src->row(i + 1), w, stride, true, s0, s1, s2, s3);
+                }
+                uint64_t result = 0;
+                for(unsigned c : selected){
+                    result |= (c & 1 ? s0 : ~s0) & (c & 2 ? s1 : ~s1) & (c & 4 ? s2 : ~s2) & (c & 8 ? s3 : ~s3);
+                }
+                out[w] = result;
+            }
+            out[stride - 1] &= dst->lastMask();
+        }
+    });
+}
+
+//! Bit Set of the Neighbour Counts Given as Digits (for example "23" for 2 or 3 Neighbours)
+inline unsigned bitsCounts(const std::string& digits){
+    unsigned counts = 0;
+    for(char c : digits){
+        counts |= 1u << (c - '0');
+    }
+    return counts;
+}
+
+#endif //SQBRA_BITMATRIX_H
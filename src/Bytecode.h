@@ -0,0 +1,97 @@
+#pragma once
+#ifndef SQBRA_BYTECODE_H
+#define SQBRA_BYTECODE_H
+
+/*
+ *  BYTECODE.H
+ *  This file declares the instruction set, the compiler and the virtual machine of the bytecode engine.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Tokens.h"
+
+// OPCODES (all instructions of the register machine)
+
+enum class OpCode : uint8_t {
+    MOVE,       // R[a] = R[b]
+    LOADV,      // R[a] = *p
+    LOADL,      // R[a] = list p [ R[b] ]
+    LOADM,      // R[a] = matrix p [ R[b] ][ R[c] ]
+    LOADD,      // R[a] = dictionary p [ R[b] ]
+    LOADB,      // R[a] = bit matrix p [ R[b] ][ R[c] ]
+    LOADT,      // R[a] = typed list p [ R[b] ] or typed matrix p [ R[b] ][ R[c] ]
+    LOADS,      // R[a] = sparse matrix p [ R[b] ][ R[c] ]
+    STOREV,     // *p = R[a]
+    STOREL,     // list p [ R[b] ] = R[a]
+    STOREM,     // matrix p [ R[b] ][ R[c] ] = R[a]
+    STOREB,     // bit matrix p [ R[b] ][ R[c] ] = R[a] > 0
+    STORET,     // typed list p [ R[b] ] or typed matrix p [ R[b] ][ R[c] ] = R[a]
+    INCV,       // *p = *p + 1
+    DECV,       // *p = *p - 1
+    INCR,       // R[a] = R[a] + 1
+    DECR,       // R[a] = R[a] - 1
+    TRUNC,      // R[a] = (int)R[a]
+    TRUTH,      // R[a] = R[a] > 0
+    ADD,        // R[a] = R[b] + R[c]
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    POW,
+    EQ,
+    NEQ,
+    LARGER,
+    LARGEREQ,
+    LESS,
+    LESSEQ,
+    ANDJ,       // if !(R[a] > 0) { R[a] = 0; pc = b }
+    ORJ,        // if R[a] > 0 { R[a] = 1; pc = b }
+    JMP,        // pc = b
+    JMPF,       // if !(R[a] > 0) pc = b
+    JMPFV,      // if !(*p > 0) pc = b
+    JMPNIF,     // if !if_state pc = b
+    SETIF,      // if_state = a
+    DEFUN,      // bind function name a to chunk b
+    CALL,       // call function name a
+    RET,        // return from the current function (or end the program)
+    EXIT,       // terminate the program
+    CMD         // execute the command node p with the tree walker
+};
+
+struct Instruction {
+    OpCode op;
+    int a;
+    int b;
+    int c;
+    void* p;
+};
+
+template<typename T>
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<T> constants;           // preloaded into the registers directly above the temporaries
+    int registers = 0;                  // number of temporaries
+};
+
+template<typename T>
+struct Program {
+    std::vector<Chunk<T>*> chunks;      // chunk 0 is the main program, the others are function bodies
+    std::vector<std::string> functions; // function names, indexed by the operand of DEFUN and CALL
+};
+
+/// FUNCTIONS
+
+template<typename T>
+Program<T>* compileProgram(Node* root);
+
+template<typename T>
+void runProgram(Program<T>* program);
+
+template<typename T>
+void printBytecode(Program<T>* program);
+
+#endif //SQBRA_BYTECODE_H
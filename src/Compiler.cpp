@@ -0,0 +1,420 @@
+/*
+ *  COMPILER.CPP
+ *  This file contains the bytecode compiler for the SquareBracket language.
+ *  The compiler translates the parsed tree into flat register code which is executed by the virtual machine.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Bytecode.h"
+#include "Recurser.h"
+
+template<typename T>
+Program<T>* compiledProgram; // program that is currently compiled
+
+template<typename T>
+void compileBlock(Chunk<T>* chunk, Node* block, int top);
+
+template<typename T>
+void compileExpressionTo(Chunk<T>* chunk, MathNode* node, int dst);
+
+// AUXILIARY FUNCTIONS ##############################################################
+
+//! Append an Instruction to the Chunk and Return its Position
+template<typename T>
+inline int emit(Chunk<T>* chunk, OpCode op, int a = 0, int b = 0, int c = 0, void* p = nullptr){
+    chunk->code.push_back(Instruction{op, a, b, c, p});
+    return (int)chunk->code.size() - 1;
+}
+
+//! Let a Jump Instruction Point to the Next Instruction
+template<typename T>
+inline void patchJump(Chunk<T>* chunk, int position){
+    chunk->code[position].b = (int)chunk->code.size();
+}
+
+//! Reserve a Register in the Chunk
+template<typename T>
+inline void useRegister(Chunk<T>* chunk, int reg){
+    if(reg + 1 > chunk->registers){
+        chunk->registers = reg + 1;
+    }
+}
+
+//! Add a Constant to the Constant Pool (or Reuse an Existing One)
+template<typename T>
+inline int addConstant(Chunk<T>* chunk, T value){
+    for(int i = 0; i < chunk->constants.size(); i++){
+        if(chunk->constants[i] == value){
+            return i;
+        }
+    }
+    chunk->constants.push_back(value);
+    return (int)chunk->constants.size() - 1;
+}
+
+//! Get the Index of a Function Name
+template<typename T>
+inline int functionIndex(const std::string& name){
+    for(int i = 0; i < compiledProgram<T>->functions.size(); i++){
+        if(compiledProgram<T>->functions[i] == name){
+            return i;
+        }
+    }
+    compiledProgram<T>->functions.push_back(name);
+    return (int)compiledProgram<T>->functions.size() - 1;
+}
+
+//! Encode a Constant as Register Operand (Resolved by relocateConstants Once the Chunk is Complete)
+inline int constantRegister(int constant){
+    return -1 - constant;
+}
+
+//! Map an Operator of the MathTree to its Opcode
+inline OpCode operatorCode(MathOperatorType opt){
+    switch(opt){
+        case MathOperatorType::PLUS: return OpCode::ADD;
+        case MathOperatorType::MINUS: return OpCode::SUB;
+        case MathOperatorType::MULT: return OpCode::MUL;
+        case MathOperatorType::DIV: return OpCode::DIV;
+        case MathOperatorType::MOD: return OpCode::MOD;
+        case MathOperatorType::EXP: return OpCode::POW;
+        case MathOperatorType::EQ: return OpCode::EQ;
+        case MathOperatorType::NEQ: return OpCode::NEQ;
+        case MathOperatorType::LARGER: return OpCode::LARGER;
+        case MathOperatorType::LARGEREQ: return OpCode::LARGEREQ;
+        case MathOperatorType::LESS: return OpCode::LESS;
+        default: return OpCode::LESSEQ;
+    }
+}
+
+// EXPRESSIONS ######################################################################
+
+//! Compile a MathTree and Return the Register Holding its Value (Registers From dst Upwards are Temporaries)
+template<typename T>
+int compileExpression(Chunk<T>* chunk, MathNode* node, int dst){
+    int left;
+    int right;
+    switch(node->type){
+        case MathNodeType::Constant:
+            return constantRegister(addConstant(chunk, (T)node->constant));
+        case MathNodeType::Variable:
+            useRegister(chunk, dst);
+            emit(chunk, OpCode::LOADV, dst, 0, 0, node->variable);
+            return dst;
+        case MathNodeType::Array:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            emit(chunk, OpCode::LOADL, dst, left, 0, node->variable);
+            return dst;
+        case MathNodeType::Matrix:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            right = compileExpression(chunk, node->right, dst + 1);
+            emit(chunk, OpCode::LOADM, dst, left, right, node->variable);
+            return dst;
+        case MathNodeType::Typed:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            right = node->right != nullptr ? compileExpression(chunk, node->right, dst + 1) : 0;
+            emit(chunk, OpCode::LOADT, dst, left, right, node->variable);
+            return dst;
+        case MathNodeType::Sparse:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            right = compileExpression(chunk, node->right, dst + 1);
+            emit(chunk, OpCode::LOADS, dst, left, right, node->variable);
+            return dst;
+        case MathNodeType::BitMatrix:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            right = compileExpression(chunk, node->right, dst + 1);
+            emit(chunk, OpCode::LOADB, dst, left, right, node->variable);
+            return dst;
+        case MathNodeType::Dict:
+            useRegister(chunk, dst);
+            left = compileExpression(chunk, node->left, dst);
+            emit(chunk, OpCode::LOADD, dst, left, 0, node->variable);
+            return dst;
+        case MathNodeType::Operator:
+            useRegister(chunk, dst);
+            if(node->opt == MathOperatorType::AND || node->opt == MathOperatorType::OR){
+                // short circuit evaluation like in calculateExpression()
+                compileExpressionTo(chunk, node->left, dst);
+                int jump = emit(chunk, node->opt == MathOperatorType::AND ? OpCode::ANDJ : OpCode::ORJ, dst);
+                compileExpressionTo(chunk, node->right, dst);
+                emit(chunk, OpCode::TRUTH, dst);
+                patchJump(chunk, jump);
+            }else{
+                left = compileExpression(chunk, node->left, dst);
+                right = compileExpression(chunk, node->right, dst + 1);
+                emit(chunk, operatorCode(node->opt), dst, left, right);
+            }
+            return dst;
+        case MathNodeType::WholeList:
+        case MathNodeType::WholeMatrix:
+        case MathNodeType::Select:
+            // only scalar expressions are compiled to registers; whole-array assignments run compileArrayExpression
+            std::cerr << "Error: whole lists, matrices and where() can only be assigned to a whole list or matrix with set." << std::endl;
+            exit(0);
+    }
+    return dst;
+}
+
+//! Compile a MathTree so that its Value Ends Up in Register dst
+template<typename T>
+void compileExpressionTo(Chunk<T>* chunk, MathNode* node, int dst){
+    int reg = compileExpression(chunk, node, dst);
+    if(reg != dst){
+        useRegister(chunk, dst);
+        emit(chunk, OpCode::MOVE, dst, reg);
+    }
+}
+
+//! Store Register src into a Variable, List or Matrix Entry (Uses Registers From top Upwards)
+template<typename T>
+void compileStore(Chunk<T>* chunk, MathNode* varlist, int src, int top){
+    int left;
+    int right;
+    if(varlist->type == MathNodeType::Variable){
+        emit(chunk, OpCode::STOREV, src, 0, 0, varlist->variable);
+    }else if(varlist->type == MathNodeType::Array){
+        left = compileExpression(chunk, varlist->left, top);
+        emit(chunk, OpCode::STOREL, src, left, 0, varlist->variable);
+    }else if(varlist->type == MathNodeType::Typed){
+        left = compileExpression(chunk, varlist->left, top);
+        right = varlist->right != nullptr ? compileExpression(chunk, varlist->right, top + 1) : 0;
+        emit(chunk, OpCode::STORET, src, left, right, varlist->variable);
+    }else if(varlist->type == MathNodeType::BitMatrix){
+        left = compileExpression(chunk, varlist->left, top);
+        right = compileExpression(chunk, varlist->right, top + 1);
+        emit(chunk, OpCode::STOREB, src, left, right, varlist->variable);
+    }else{
+        left = compileExpression(chunk, varlist->left, top);
+        right = compileExpression(chunk, varlist->right, top + 1);
+        emit(chunk, OpCode::STOREM, src, left, right, varlist->variable);
+    }
+}
+
+//! Add a Constant Step to a Variable, List or Matrix Entry (INC / DEC)
+template<typename T>
+void compileStep(Chunk<T>* chunk, MathNode* varlist, bool increment, int top){
+    if(varlist->type == MathNodeType::Variable){
+        emit(chunk, increment ? OpCode::INCV : OpCode::DECV, 0, 0, 0, varlist->variable);
+    }else{
+        compileExpressionTo(chunk, varlist, top);
+        emit(chunk, increment ? OpCode::INCR : OpCode::DECR, top);
+        compileStore(chunk, varlist, top, top + 1);
+    }
+}
+
+//! Jump to target (patched later) if the Variable or List Entry is not Larger Than Zero
+template<typename T>
+int compileLoopTest(Chunk<T>* chunk, MathNode* varlist, int top){
+    if(varlist->type == MathNodeType::Variable){
+        return emit(chunk, OpCode::JMPFV, 0, -1, 0, varlist->variable);
+    }
+    return emit(chunk, OpCode::JMPF, compileExpression(chunk, varlist, top), -1);
+}
+
+//! Move the Constant Operands to the Registers Directly Above the Temporaries
+template<typename T>
+void relocateConstants(Chunk<T>* chunk){
+    for(Instruction& in : chunk->code){
+        // jump targets and function indices are never negative, so only register operands are rewritten
+        if(in.a < 0){ in.a = chunk->registers - 1 - in.a; }
+        if(in.b < 0){ in.b = chunk->registers - 1 - in.b; }
+        if(in.c < 0){ in.c = chunk->registers - 1 - in.c; }
+    }
+}
+
+// STATEMENTS #######################################################################
+
+//! Compile a Single Statement; Registers Below top Hold Live Loop Counters
+template<typename T>
+void compileStatement(Chunk<T>* chunk, Node* node, int top){
+    int start;
+    int jump;
+    int jump2;
+    int reg;
+    switch(node->type){
+        case EXEC:
+        case ROOT:
+            compileBlock(chunk, node, top);
+            break;
+        case END:
+            break;
+        case CVAR:
+            reg = compileExpression(chunk, node->children[1]->expression, top);
+            emit(chunk, OpCode::STOREV, reg, 0, 0, node->children[0]->value);
+            break;
+        case MVAR:
+            reg = compileExpression(chunk, node->children[1]->expression, top);
+            for(T* var : *(std::vector<T*>*)node->children[0]->value){
+                emit(chunk, OpCode::STOREV, reg, 0, 0, var);
+            }
+            break;
+        case SET:
+            reg = compileExpression(chunk, node->children[1]->expression, top);
+            compileStore(chunk, node->children[0]->expression, reg, top + 1);
+            break;
+        case INC:
+            compileStep(chunk, node->children[0]->expression, true, top);
+            break;
+        case DEC:
+            compileStep(chunk, node->children[0]->expression, false, top);
+            break;
+        case LOOP:
+            start = (int)chunk->code.size();
+            jump = compileLoopTest(chunk, node->children[0]->expression, top);
+            compileBlock(chunk, node->children[1], top);
+            compileStep(chunk, node->children[0]->expression, false, top);
+            emit(chunk, OpCode::JMP, 0, start);
+            patchJump(chunk, jump);
+            break;
+        case AUTOLOOP:
+            reg = compileExpression(chunk, node->children[1]->expression, top);
+            compileStore(chunk, node->children[0]->expression, reg, top + 1);
+            start = (int)chunk->code.size();
+            jump = compileLoopTest(chunk, node->children[0]->expression, top);
+            compileBlock(chunk, node->children[2], top);
+            compileStep(chunk, node->children[0]->expression, false, top);
+            emit(chunk, OpCode::JMP, 0, start);
+            patchJump(chunk, jump);
+            break;
+        case SLOOP:
+            // the counter lives in register top, the body uses the registers above
+            compileExpressionTo(chunk, node->children[0]->expression, top);
+            emit(chunk, OpCode::TRUNC, top);
+            start = (int)chunk->code.size();
+            jump = emit(chunk, OpCode::JMPF, top, -1);
+            compileBlock(chunk, node->children[1], top + 1);
+            emit(chunk, OpCode::DECR, top);
+            emit(chunk, OpCode::JMP, 0, start);
+            patchJump(chunk, jump);
+            break;
+        case WHILE:
+            start = (int)chunk->code.size();
+            reg = compileExpression(chunk, node->children[0]->expression, top);
+            jump = emit(chunk, OpCode::JMPF, reg, -1);
+            compileBlock(chunk, node->children[1], top);
+            emit(chunk, OpCode::JMP, 0, start);
+            patchJump(chunk, jump);
+            break;
+        case IF:
+            reg = compileExpression(chunk, node->children[0]->expression, top);
+            jump = emit(chunk, OpCode::JMPF, reg, -1);
+            emit(chunk, OpCode::SETIF, 0);
+            compileBlock(chunk, node->children[1], top);
+            jump2 = emit(chunk, OpCode::JMP, 0, -1);
+            patchJump(chunk, jump);
+            emit(chunk, OpCode::SETIF, 1);
+            patchJump(chunk, jump2);
+            break;
+        case ELIF:
+            start = emit(chunk, OpCode::JMPNIF, 0, -1);
+            reg = compileExpression(chunk, node->children[0]->expression, top);
+            jump = emit(chunk, OpCode::JMPF, reg, -1);
+            emit(chunk, OpCode::SETIF, 0);
+            compileBlock(chunk, node->children[1], top);
+            jump2 = emit(chunk, OpCode::JMP, 0, -1);
+            patchJump(chunk, jump);
+            emit(chunk, OpCode::SETIF, 1);
+            patchJump(chunk, jump2);
+            patchJump(chunk, start);
+            break;
+        case ELSE:
+            jump = emit(chunk, OpCode::JMPNIF, 0, -1);
+            emit(chunk, OpCode::SETIF, 0);
+            compileBlock(chunk, node->children[0], top);
+            patchJump(chunk, jump);
+            break;
+        case FUNCT: {
+            auto body = new Chunk<T>;
+            compiledProgram<T>->chunks.push_back(body);
+            int chunkid = (int)compiledProgram<T>->chunks.size() - 1;
+            compileBlock(body, node->children[1], 0);
+            emit(body, OpCode::RET);
+            relocateConstants(body);
+            emit(chunk, OpCode::DEFUN, functionIndex<T>(*(std::string*)node->children[0]->value), chunkid);
+            funcs[*(std::string*)node->children[0]->value] = node->children[1]; // ploop bodies run on the tree walker and copy the tree of the function
+            break;
+        }
+        case CALL:
+            emit(chunk, OpCode::CALL, functionIndex<T>(*(std::string*)node->children[0]->value));
+            emit(chunk, OpCode::SETIF, 0);
+            break;
+        case LEAVE:
+            emit(chunk, OpCode::RET);
+            break;
+        case EXIT:
+            emit(chunk, OpCode::EXIT);
+            break;
+        default:
+            // all other commands are executed by the tree walker
+            emit(chunk, OpCode::CMD, 0, 0, 0, node);
+            break;
+    }
+}
+
+//! Compile All Statements of a Block
+template<typename T>
+void compileBlock(Chunk<T>* chunk, Node* block, int top){
+    for(Node* statement : block->children){
+        compileStatement(chunk, statement, top);
+    }
+}
+
+//! Compile the Parsed Tree to Bytecode
+template<typename T>
+Program<T>* compileProgram(Node* root){
+    compiledProgram<T> = new Program<T>;
+    auto main = new Chunk<T>;
+    compiledProgram<T>->chunks.push_back(main);
+    compileBlock(main, root, 0);
+    emit(main, OpCode::RET);
+    relocateConstants(main);
+    return compiledProgram<T>;
+}
+
+// PRINT FUNCTIONS ##################################################################
+
+//! Get the Name of an Opcode
+std::string getOpCodeName(OpCode op){
+    static const char* names[] = {"MOVE", "LOADV", "LOADL", "LOADM", "LOADD", "LOADB", "LOADT", "LOADS", "STOREV",
+                                  "STOREL", "STOREM", "STOREB", "STORET", "INCV", "DECV", "INCR", "DECR", "TRUNC",
+                                  "TRUTH", "ADD", "SUB", "MUL", "DIV", "MOD", "POW", "EQ", "NEQ", "LARGER",
+                                  "LARGEREQ", "LESS", "LESSEQ", "ANDJ", "ORJ", "JMP", "JMPF", "JMPFV", "JMPNIF",
+                                  "SETIF", "DEFUN", "CALL", "RET", "EXIT", "CMD"};
+    return names[(int)op];
+}
+
+//! Print the Compiled Bytecode of All Chunks
+template<typename T>
+void printBytecode(Program<T>* program){
+    std::cout << "SquareBracket Compiler (Version 2.2.3) -- © 2023 Patrick De Smet" << std::endl << std::endl;
+    for(int c = 0; c < program->chunks.size(); c++){
+        Chunk<T>* chunk = program->chunks[c];
+        std::cout << "CHUNK " << c << " (" << chunk->registers << " registers, " << chunk->constants.size() << " constants)" << std::endl;
+        for(int k = 0; k < chunk->constants.size(); k++){
+            std::cout << "  R" << chunk->registers + k << " = " << chunk->constants[k] << std::endl;
+        }
+        for(int i = 0; i < chunk->code.size(); i++){
+            const Instruction& in = chunk->code[i];
+            std::cout << "  " << i << "\t" << getOpCodeName(in.op) << "\t" << in.a << " " << in.b << " " << in.c;
+            if(in.op == OpCode::DEFUN || in.op == OpCode::CALL){
+                std::cout << "\t; " << program->functions[in.a];
+            }else if(in.p != nullptr){
+                std::cout << "\t; <" << in.p << ">";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template Program<double>* compileProgram<double>(Node* root);
+template Program<long double>* compileProgram<long double>(Node* root);
+template void printBytecode<double>(Program<double>* program);
+template void printBytecode<long double>(Program<long double>* program);
@@ -0,0 +1,808 @@
+/*
+ *  DEPENDENCE.CPP
+ *  This file contains the dependence analysis of the flag --auto-parallel.
+ *  An autoloop or sloop runs in parallel if no iteration depends on another one: scalar variables are either private to an
+ *  iteration or sums, and every written list or matrix entry belongs to a single value of the loop counter.
+ *  It also contains the read and write sets that decide whether spawned functions can run concurrently.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <set>
+
+#include "Parallel.h"
+
+bool auto_parallel = false;
+
+// ANALYSIS OF A LOOP BODY ##########################################################
+
+//! Index of the Form coefficient * counter + offset
+struct AffineIndex {
+    bool valid;
+    long double coefficient;
+    long double offset;
+};
+
+template<typename T>
+struct LoopAnalysis {
+    T* counter = nullptr;                               // nullptr for sloop
+    std::unordered_map<std::string, Node*>* functions;  // functions declared before the loop
+    std::vector<std::string> calling;                   // functions whose body is being analyzed (detects recursion)
+    std::vector<T*> written;                            // scalar variables written in the body (in order of appearance)
+    std::set<T*> exposed;                               // variables that may be read before they are written in an iteration
+    std::set<T*> used;                                  // variables that are used outside of sum updates
+    std::set<T*> updated;                               // variables changed by set v (v + e), set v (v - e), inc v or dec v
+    std::vector<MathNode*> accesses;                    // all accesses to list and matrix entries
+    std::set<void*> changed;                            // lists and matrices whose entries are written
+    std::string reason;                                 // why the loop stays serial (empty if it can run in parallel)
+};
+
+//! Name of a Variable, List or Matrix for the Report
+template<typename T>
+std::string nameOf(void* pointer){
+    for(auto& entry : vars<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : ars<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : mars<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : dicts<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : heaps<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : bmats<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : typeds<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    for(auto& entry : sparses<T>){
+        if(entry.second == pointer){ return entry.first; }
+    }
+    return "?";
+}
+
+//! Keep the First Reason Why the Loop Cannot Run in Parallel
+template<typename T>
+void reject(LoopAnalysis<T>& analysis, const std::string& reason){
+    if(analysis.reason.empty()){
+        analysis.reason = reason;
+    }
+}
+
+//! Check Whether an Expression Reads a Variable
+bool mentions(MathNode* node, void* variable){
+    if(node == nullptr){
+        return false;
+    }
+    if(node->type == MathNodeType::Variable && node->variable == variable){
+        return true;
+    }
+    return mentions(node->left, variable) || mentions(node->right, variable) || mentions(node->otherwise, variable);
+}
+
+template<typename T>
+void readExpression(MathNode* node, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    if(node == nullptr){
+        return;
+    }
+    if(node->type == MathNodeType::Variable){
+        T* variable = (T*)node->variable;
+        if(defined.find(variable) == defined.end()){
+            analysis.exposed.insert(variable);
+        }
+        analysis.used.insert(variable);
+    }else if(node->type == MathNodeType::Array || node->type == MathNodeType::Matrix || node->type == MathNodeType::Typed){
+        analysis.accesses.push_back(node);
+    }
+    if((node->type == MathNodeType::Matrix || node->type == MathNodeType::WholeMatrix) && ((Matrix<T>*)node->variable)->view){
+        reject(analysis, "the body uses the matrix view <" + nameOf<T>(node->variable) + ">"); // a view shares the entries of another matrix
+    }
+    readExpression(node->left, defined, analysis);
+    readExpression(node->right, defined, analysis);
+    readExpression(node->otherwise, defined, analysis);
+}
+
+//! Record a Write to a Scalar Variable
+template<typename T>
+void writeVariable(T* variable, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    if(std::find(analysis.written.begin(), analysis.written.end(), variable) == analysis.written.end()){
+        analysis.written.push_back(variable);
+    }
+    defined.insert(variable);
+}
+
+//! Record the Target of a Command (reads: the command uses the old value as well)
+template<typename T>
+void writeTarget(MathNode* target, bool reads, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    if(target->type == MathNodeType::Variable){
+        if(reads){
+            readExpression(target, defined, analysis);
+        }
+        analysis.used.insert((T*)target->variable);
+        writeVariable((T*)target->variable, defined, analysis);
+    }else if(target->type == MathNodeType::BitMatrix){
+        reject(analysis, "the body sets entries of a bit matrix"); // neighbouring entries share one word
+    }else{
+        readExpression(target, defined, analysis);
+        analysis.changed.insert(target->variable);
+    }
+}
+
+//! Record set v (v + e), set v (e + v), set v (v - e), inc v and dec v; Returns false for Other Assignments
+template<typename T>
+bool sumUpdate(MathNode* target, MathNode* expression, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    if(target->type != MathNodeType::Variable){
+        return false;
+    }
+    MathNode* rest = nullptr;
+    if(expression != nullptr){
+        if(expression->type != MathNodeType::Operator){
+            return false;
+        }
+        bool left = expression->left->type == MathNodeType::Variable && expression->left->variable == target->variable;
+        bool right = expression->right->type == MathNodeType::Variable && expression->right->variable == target->variable;
+        if(expression->opt == MathOperatorType::PLUS && left){
+            rest = expression->right;
+        }else if(expression->opt == MathOperatorType::PLUS && right){
+            rest = expression->left;
+        }else if(expression->opt == MathOperatorType::MINUS && left){
+            rest = expression->right;
+        }else{
+            return false;
+        }
+        if(mentions(rest, target->variable)){
+            return false;
+        }
+    }
+    T* variable = (T*)target->variable;
+    readExpression(rest, defined, analysis);
+    if(defined.find(variable) == defined.end()){
+        analysis.exposed.insert(variable);
+    }
+    analysis.updated.insert(variable);
+    writeVariable(variable, defined, analysis);
+    return true;
+}
+
+//! Check Whether a Loop with this Count Runs at Least Once (whole: the count is truncated like in sloop)
+bool runsOnce(MathNode* count, bool whole){
+    return count->type == MathNodeType::Constant && (whole ? count->constant >= 1 : count->constant > 0);
+}
+
+template<typename T>
+void analyzeBlock(Node* block, std::set<T*>& defined, LoopAnalysis<T>& analysis);
+
+template<typename T>
+void analyzeStatement(Node* statement, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    std::set<T*> inner;
+    switch(statement->type){
+        case CVAR:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            analysis.used.insert((T*)statement->children[0]->value);
+            writeVariable((T*)statement->children[0]->value, defined, analysis);
+            break;
+        case MVAR:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            for(T* variable : *(std::vector<T*>*)statement->children[0]->value){
+                analysis.used.insert(variable);
+                writeVariable(variable, defined, analysis);
+            }
+            break;
+        case SET:
+            if(!sumUpdate(statement->children[0]->expression, statement->children[1]->expression, defined, analysis)){
+                readExpression(statement->children[1]->expression, defined, analysis);
+                writeTarget(statement->children[0]->expression, false, defined, analysis);
+            }
+            break;
+        case INC:
+        case DEC:
+            if(!sumUpdate(statement->children[0]->expression, (MathNode*)nullptr, defined, analysis)){
+                writeTarget(statement->children[0]->expression, true, defined, analysis);
+            }
+            break;
+        case CEIL:
+        case FLOOR:
+        case ABS:
+            writeTarget(statement->children[0]->expression, true, defined, analysis);
+            break;
+        case ROUND:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            writeTarget(statement->children[0]->expression, true, defined, analysis);
+            break;
+        case LOG:
+        case XROOT:
+        case RANDOM:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            readExpression(statement->children[2]->expression, defined, analysis);
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            break;
+        case SIN:
+        case COS:
+        case TAN:
+        case CSC:
+        case SEC:
+        case COT:
+        case ASIN:
+        case ACOS:
+        case ATAN:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            break;
+        case GETL:
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            break;
+        case GETDIM:
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            writeTarget(statement->children[1]->expression, false, defined, analysis);
+            break;
+        case IF:
+        case ELIF:
+        case WHILE:
+            readExpression(statement->children[0]->expression, defined, analysis);
+            inner = defined;
+            analyzeBlock(statement->children[1], inner, analysis);
+            break;
+        case ELSE:
+            inner = defined;
+            analyzeBlock(statement->children[0], inner, analysis);
+            break;
+        case LOOP:
+            inner = defined;
+            writeTarget(statement->children[0]->expression, true, inner, analysis);
+            analyzeBlock(statement->children[1], inner, analysis);
+            break;
+        case AUTOLOOP:
+        case PLOOP:
+            readExpression(statement->children[1]->expression, defined, analysis);
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            if(runsOnce(statement->children[1]->expression, false)){
+                analyzeBlock(statement->children[2], defined, analysis); // the writes of the body happen in every iteration
+            }else{
+                inner = defined;
+                analyzeBlock(statement->children[2], inner, analysis);
+            }
+            break;
+        case SLOOP:
+            readExpression(statement->children[0]->expression, defined, analysis);
+            if(runsOnce(statement->children[0]->expression, true)){
+                analyzeBlock(statement->children[1], defined, analysis);
+            }else{
+                inner = defined;
+                analyzeBlock(statement->children[1], inner, analysis);
+            }
+            break;
+        case CALL: {
+            std::string name = *(std::string*)statement->children[0]->value;
+            if(analysis.functions->find(name) == analysis.functions->end()){
+                reject(analysis, "function <" + name + "> is not declared before the loop");
+            }else if(std::find(analysis.calling.begin(), analysis.calling.end(), name) != analysis.calling.end()){
+                reject(analysis, "function <" + name + "> is recursive");
+            }else{
+                analysis.calling.push_back(name);
+                analyzeBlock((*analysis.functions)[name], defined, analysis); // the body runs like written in place of the call
+                analysis.calling.pop_back();
+            }
+            break;
+        }
+        case END:
+            break;
+        case PRINT:
+        case PRINTB:
+        case PRINTV:
+        case PRINTM:
+        case NEWL:
+            reject(analysis, "the body prints");
+            break;
+        case INPUT:
+            reject(analysis, "the body reads input");
+            break;
+        case PUSH:
+        case POP:
+        case CHSL:
+            reject(analysis, "the body changes the length of a list");
+            break;
+        case CLIST:
+        case CMAT:
+        case LDEF:
+        case MDEF:
+        case MVIEW:
+        case MMAT:
+            reject(analysis, "the body declares a list or matrix");
+            break;
+        case READF:
+        case WRITEF:
+            reject(analysis, "the body accesses files");
+            break;
+        case CDICT:
+        case DSET:
+        case DDEL:
+            reject(analysis, "the body changes a dictionary");
+            break;
+        case DGET:
+        case DHAS:
+            for(size_t i = 2; i < statement->children.size(); i++){
+                readExpression(statement->children[i]->expression, defined, analysis);
+            }
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            break;
+        case DLEN:
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            break;
+        case CHEAP:
+        case HPUSH:
+        case HPOP:
+            reject(analysis, "the body changes a heap");
+            break;
+        case CBMAT:
+        case BMAND:
+        case BMOR:
+        case BMXOR:
+        case BMNOT:
+        case BMNEIGH:
+            reject(analysis, "the body changes a bit matrix");
+            break;
+        case CSPARSE:
+            reject(analysis, "the body changes a sparse matrix");
+            break;
+        case BMCOUNT:
+        case HPEEK:
+        case HLEN:
+            writeTarget(statement->children[0]->expression, false, defined, analysis);
+            if(statement->children.size() > 2){
+                writeTarget(statement->children[2]->expression, false, defined, analysis);
+            }
+            break;
+        case SLEEP:
+            reject(analysis, "the body sleeps");
+            break;
+        case EXIT:
+        case LEAVE:
+            reject(analysis, "the body can end the loop early");
+            break;
+        case FUNCT:
+            reject(analysis, "the body declares a function");
+            break;
+        case LADD: case LSUB: case LMUL: case LDIV: case LAXPY: case LCLAMP: case LCMP:
+        case MADD: case MSUB: case MMUL: case MDIV: case MAXPY: case MCLAMP: case MCMP:
+        case VSIN: case VCOS: case VTAN: case VEXP: case VLOG: case VXROOT:
+        case SETARRAY: case LCOPY: case MCOPY: case LFILL: case MFILL:
+            reject(analysis, "the body assigns a whole list or matrix");
+            break;
+        case LSUM: case LMIN: case LMAX: case LARGMAX: case LMEAN: case LVAR: case LDOT: case LBSEARCH: case MDET:
+            reject(analysis, "the body reads a whole list or matrix in one command");
+            break;
+        case MATMUL: case MSOLVE: case MINV: case MTRANS: case MLU:
+            reject(analysis, "the body runs a matrix algorithm (matmul, msolve, minv, mtrans or mlu)");
+            break;
+        case FFT: case IFFT: case LCONV: case STENCIL: case SPMV: case LSCAN:
+            reject(analysis, "the body transforms a whole list or matrix");
+            break;
+        case LSORT: case LSORTIDX: case LUNIQUE: case LUNION: case LINTERSECT:
+            reject(analysis, "the body sorts or combines whole lists");
+            break;
+        case LSWAP: case MSWAP:
+            reject(analysis, "the body swaps two lists or matrices");
+            break;
+        case SPAWN: case JOIN:
+            reject(analysis, "the body spawns or joins tasks");
+            break;
+        default:
+            reject(analysis, "the body contains a command the analysis does not know");
+            break;
+    }
+}
+
+template<typename T>
+void analyzeBlock(Node* block, std::set<T*>& defined, LoopAnalysis<T>& analysis){
+    for(Node* statement : block->children){
+        analyzeStatement(statement, defined, analysis);
+    }
+}
+
+// LIST AND MATRIX ENTRIES ##########################################################
+
+//! Write an Index as coefficient * counter + offset (invalid if it depends on anything but the counter)
+template<typename T>
+AffineIndex affineIndex(MathNode* node, T* counter){
+    if(node->type == MathNodeType::Constant){
+        return AffineIndex{true, 0, node->constant};
+    }
+    if(node->type == MathNodeType::Variable && counter != nullptr && node->variable == counter){
+        return AffineIndex{true, 1, 0};
+    }
+    if(node->type != MathNodeType::Operator || node->left == nullptr || node->right == nullptr){
+        return AffineIndex{false, 0, 0};
+    }
+    AffineIndex left = affineIndex(node->left, counter);
+    AffineIndex right = affineIndex(node->right, counter);
+    if(!left.valid || !right.valid){
+        return AffineIndex{false, 0, 0};
+    }
+    switch(node->opt){
+        case MathOperatorType::PLUS:
+            return AffineIndex{true, left.coefficient + right.coefficient, left.offset + right.offset};
+        case MathOperatorType::MINUS:
+            return AffineIndex{true, left.coefficient - right.coefficient, left.offset - right.offset};
+        case MathOperatorType::MULT:
+            if(left.coefficient == 0){
+                return AffineIndex{true, right.coefficient * left.offset, right.offset * left.offset};
+            }else if(right.coefficient == 0){
+                return AffineIndex{true, left.coefficient * right.offset, left.offset * right.offset};
+            }
+            return AffineIndex{false, 0, 0}; // the product of two multiples of the counter is not affine
+        default:
+            return AffineIndex{false, 0, 0};
+    }
+}
+
+//! Check Whether all Accesses to a List or Matrix Use the Same Whole Multiple of the Counter in one Dimension
+template<typename T>
+bool separatesIterations(void* container, LoopAnalysis<T>& analysis){
+    for(int dimension = 0; dimension < 2; dimension++){
+        bool separated = true;
+        bool first = true;
+        AffineIndex expected{false, 0, 0};
+        for(MathNode* access : analysis.accesses){
+            if(access->variable != container){
+                continue;
+            }
+            MathNode* index = dimension == 0 ? access->left : access->right;
+            if(index == nullptr){
+                separated = false;
+                break;
+            }
+            AffineIndex form = affineIndex(index, analysis.counter);
+            if(first){
+                expected = form;
+                first = false;
+                separated = form.valid && form.coefficient != 0 && form.coefficient == floor(form.coefficient) && form.offset == floor(form.offset);
+            }else if(!form.valid || form.coefficient != expected.coefficient || form.offset != expected.offset){
+                separated = false;
+            }
+            if(!separated){
+                break;
+            }
+        }
+        if(separated){
+            return true;
+        }
+    }
+    return false;
+}
+
+// TRANSFORMATION ###################################################################
+
+//! Analyze a Loop and Turn it into a Parallel Loop if its Iterations are Independent
+template<typename T>
+bool parallelizeLoop(Node* loop, std::unordered_map<std::string, Node*>& functions){
+    LoopAnalysis<T> analysis;
+    analysis.functions = &functions;
+    Node* body = loop->children[loop->type == AUTOLOOP ? 2 : 1];
+    std::string kind = loop->type == AUTOLOOP ? "autoloop" : "sloop";
+    std::set<T*> defined;
+    if(loop->type == AUTOLOOP){
+        if(loop->children[0]->expression->type != MathNodeType::Variable){
+            reject(analysis, "the counter is a list or matrix entry");
+        }else{
+            analysis.counter = (T*)loop->children[0]->expression->variable;
+            defined.insert(analysis.counter);
+        }
+    }
+    if(!body->children.empty() && (body->children[0]->type == ELIF || body->children[0]->type == ELSE)){
+        reject(analysis, "the first elif or else depends on the previous iteration");
+    }
+    analyzeBlock(body, defined, analysis);
+
+    auto info = new ParallelLoop<T>;
+    info->automatic = true;
+    std::string privates;
+    std::string sums;
+    for(T* variable : analysis.written){
+        if(variable == analysis.counter){
+            reject(analysis, "the body changes the counter <" + nameOf<T>(variable) + ">");
+        }else if(analysis.updated.find(variable) != analysis.updated.end() && analysis.used.find(variable) == analysis.used.end()
+                 && analysis.exposed.find(variable) != analysis.exposed.end()){
+            info->reductions.push_back(Reduction<T>{ReductionType::SUM, variable});
+            sums += " " + nameOf<T>(variable);
+        }else if(analysis.exposed.find(variable) != analysis.exposed.end()){
+            reject(analysis, "variable <" + nameOf<T>(variable) + "> is carried from one iteration to the next");
+        }else if(defined.find(variable) == defined.end()){
+            // after the loop every variable must hold its value of the last iteration
+            reject(analysis, "variable <" + nameOf<T>(variable) + "> is not written in every iteration");
+        }else{
+            privates += " " + nameOf<T>(variable);
+        }
+    }
+    for(void* container : analysis.changed){
+        if(!separatesIterations(container, analysis)){
+            reject(analysis, "entries of <" + nameOf<T>(container) + "> may be shared by several iterations");
+        }
+    }
+
+    if(!analysis.reason.empty()){
+        delete info;
+        std::cerr << "Auto-parallel: line <" << loop->line << "> " << kind << " stays serial - " << analysis.reason << std::endl;
+        return false;
+    }
+    std::cerr << "Auto-parallel: line <" << loop->line << "> " << kind << " runs in parallel";
+    if(!privates.empty()){
+        std::cerr << " - private:" << privates;
+    }
+    if(!sums.empty()){
+        std::cerr << " - sum:" << sums;
+    }
+    std::cerr << std::endl;
+
+    if(loop->type == SLOOP){
+        // sloop has no counter, the parallel loop counts with a hidden variable
+        Node* counter = new Node;
+        counter->type = VARLIST;
+        counter->expression = new MathNode(MathNodeType::Variable, (void*)new T(0));
+        loop->children.insert(loop->children.begin(), counter);
+        info->wholeCount = true;
+    }
+    loop->type = PLOOP;
+    loop->value = info;
+    return true;
+}
+
+//! Visit all Loops; the Body of a Loop that Stays Serial is Visited as well
+template<typename T>
+void parallelizeBlock(Node* block, std::unordered_map<std::string, Node*>& functions, bool top){
+    for(Node* statement : block->children){
+        switch(statement->type){
+            case FUNCT:
+                if(top){
+                    functions[*(std::string*)statement->children[0]->value] = statement->children[1]; // declared before every later loop
+                }
+                parallelizeBlock<T>(statement->children[1], functions, false);
+                break;
+            case AUTOLOOP:
+                if(!parallelizeLoop<T>(statement, functions)){
+                    parallelizeBlock<T>(statement->children[2], functions, false);
+                }
+                break;
+            case SLOOP:
+                if(!parallelizeLoop<T>(statement, functions)){
+                    parallelizeBlock<T>(statement->children[1], functions, false);
+                }
+                break;
+            case IF:
+            case ELIF:
+            case WHILE:
+            case LOOP:
+                parallelizeBlock<T>(statement->children[1], functions, false);
+                break;
+            case ELSE:
+                parallelizeBlock<T>(statement->children[0], functions, false);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+template<typename T>
+void parallelizeLoops(Node* root){
+    std::unordered_map<std::string, Node*> functions;
+    parallelizeBlock<T>(root, functions, true);
+}
+
+// READ AND WRITE SETS OF TASKS ####################################################
+
+char output_resource; // stands for the output in AccessSets (tasks buffer their output, so only the code before join conflicts)
+char files_resource;  // stands for all files in AccessSets
+
+template<typename T>
+void readAccesses(MathNode* node, AccessSets& accesses){
+    if(node == nullptr){
+        return;
+    }
+    if(node->type != MathNodeType::Constant && node->type != MathNodeType::Operator && node->type != MathNodeType::Select){
+        accesses.reads.insert(node->variable);
+    }
+    if((node->type == MathNodeType::Matrix || node->type == MathNodeType::WholeMatrix) && ((Matrix<T>*)node->variable)->view){
+        accesses.serial = true; // the entries belong to another matrix
+    }
+    readAccesses<T>(node->left, accesses);
+    readAccesses<T>(node->right, accesses);
+    readAccesses<T>(node->otherwise, accesses);
+}
+
+//! Check Whether a Command Writes the Container (List, Matrix, Dictionary, Heap or Bit Matrix) of its Child
+bool writesContainer(TokenType type, int child){
+    switch(type){
+        case PUSH:
+        case POP:
+        case HPOP:
+            return child == 1;
+        case HPUSH:
+            return child == 2;
+        case MLU: case FFT: case IFFT: case LSWAP: case MSWAP: case MVIEW:
+            return child <= 1;
+        case CLIST: case CMAT: case LDEF: case MDEF: case READF: case CHSL: case SETARRAY:
+        case LADD: case LSUB: case LMUL: case LDIV: case LAXPY: case LCLAMP: case LCMP:
+        case MADD: case MSUB: case MMUL: case MDIV: case MAXPY: case MCLAMP: case MCMP:
+        case VSIN: case VCOS: case VTAN: case VEXP: case VLOG: case VXROOT: case MATMUL:
+        case MSOLVE: case MINV: case MTRANS: case LCONV: case STENCIL:
+        case LSUM: case LMIN: case LMAX: case LARGMAX: case LMEAN: case LVAR: case LDOT: case LSCAN:
+        case LSORT: case LSORTIDX: case LUNIQUE: case LUNION: case LINTERSECT:
+        case CDICT: case DSET: case DDEL: case CHEAP:
+        case CBMAT: case BMAND: case BMOR: case BMXOR: case BMNOT: case BMNEIGH:
+        case CSPARSE: case SPMV: case MMAT: case LCOPY: case MCOPY: case LFILL: case MFILL:
+            return child == 0;
+        default:
+            return false;
+    }
+}
+
+template<typename T>
+void collectAccesses(Node* statement, AccessSets& accesses, std::unordered_map<std::string, Node*>& functions, std::vector<std::string>& calling);
+
+//! Add the Accesses of a Function Body like it was Written in Place of the Call
+template<typename T>
+void collectCall(const std::string& name, AccessSets& accesses, std::unordered_map<std::string, Node*>& functions, std::vector<std::string>& calling){
+    if(functions.find(name) == functions.end() || std::find(calling.begin(), calling.end(), name) != calling.end()){
+        accesses.serial = true; // unknown or recursive
+        return;
+    }
+    calling.push_back(name);
+    for(Node* statement : functions[name]->children){
+        collectAccesses<T>(statement, accesses, functions, calling);
+    }
+    calling.pop_back();
+}
+
+template<typename T>
+void collectAccesses(Node* statement, AccessSets& accesses, std::unordered_map<std::string, Node*>& functions, std::vector<std::string>& calling){
+    switch(statement->type){
+        case CALL:
+            collectCall<T>(*(std::string*)statement->children[0]->value, accesses, functions, calling);
+            return;
+        case INPUT:
+        case EXIT:
+        case LEAVE:
+        case FUNCT:
+        case SPAWN:
+        case JOIN:
+            accesses.serial = true;
+            return;
+        case PRINT:
+        case PRINTB:
+        case PRINTV:
+        case PRINTM:
+        case NEWL:
+            accesses.writes.insert(&output_resource);
+            break;
+        case READF:
+        case WRITEF:
+        case MMAT:
+            accesses.writes.insert(&files_resource);
+            break;
+        default:
+            break;
+    }
+    for(int i = 0; i < (int)statement->children.size(); i++){
+        Node* child = statement->children[i];
+        switch(child->type){
+            case EXPRESSION:
+                readAccesses<T>(child->expression, accesses);
+                break;
+            case VARLIST:
+                readAccesses<T>(child->expression, accesses); // most commands read their target as well
+                accesses.writes.insert(child->expression->variable);
+                break;
+            case VARIABLE:
+                accesses.writes.insert(child->value);
+                break;
+            case VARIABLES:
+                for(T* variable : *(std::vector<T*>*)child->value){
+                    accesses.writes.insert(variable);
+                }
+                break;
+            case LISTIDENT:
+            case MATIDENT:
+            case DICTIDENT:
+            case HEAPIDENT:
+            case BMATIDENT:
+            case TYPEDIDENT:
+            case SPARSEIDENT:
+                if(child->type == MATIDENT && ((Matrix<T>*)child->value)->view){
+                    accesses.serial = true;
+                }
+                if(writesContainer(statement->type, i)){
+                    accesses.writes.insert(child->value);
+                }else{
+                    accesses.reads.insert(child->value);
+                }
+                break;
+            case EXEC:
+            case ROOT:
+                for(Node* inner : child->children){
+                    collectAccesses<T>(inner, accesses, functions, calling);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+//! Check Whether one Side Writes what the Other Side Reads or Writes
+bool conflicts(const AccessSets& first, const AccessSets& second, bool output){
+    for(int side = 0; side < 2; side++){
+        const AccessSets& writer = side == 0 ? first : second;
+        const AccessSets& other = side == 0 ? second : first;
+        for(void* resource : writer.writes){
+            if(resource == &output_resource && !output){
+                continue;
+            }
+            if(other.reads.count(resource) > 0 || other.writes.count(resource) > 0){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<typename T>
+void prepareBlock(Node* block, std::unordered_map<std::string, Node*>& functions, bool top){
+    for(size_t k = 0; k < block->children.size(); k++){
+        Node* statement = block->children[k];
+        if(statement->type == FUNCT && top){
+            functions[*(std::string*)statement->children[0]->value] = statement->children[1];
+        }
+        if(statement->type == SPAWN){
+            std::string name = *(std::string*)statement->children[0]->value;
+            if(functions.find(name) == functions.end()){
+                std::cerr << "Error: function <" << name << "> must be declared before it is spawned" << std::endl;
+                exit(0);
+            }
+            auto task = new SpawnTask<T>;
+            task->body = functions[name];
+            std::vector<std::string> calling;
+            collectCall<T>(name, task->accesses, functions, calling);
+
+            // the task may run as late as the next join, so it must not conflict with the statements in between
+            AccessSets between;
+            size_t next = k + 1;
+            for(; next < block->children.size() && block->children[next]->type != JOIN; next++){
+                Node* later = block->children[next];
+                if(later->type == SPAWN){
+                    collectCall<T>(*(std::string*)later->children[0]->value, between, functions, calling);
+                }else{
+                    collectAccesses<T>(later, between, functions, calling);
+                }
+            }
+            if(next == block->children.size()){
+                std::cerr << "Error: spawn <" << name << "> requires a join in the same block" << std::endl;
+                exit(0);
+            }
+            task->serial = task->accesses.serial || between.serial || conflicts(task->accesses, between, true);
+            statement->value = task;
+        }
+        for(Node* child : statement->children){
+            if(child->type == EXEC){
+                prepareBlock<T>(child, functions, false);
+            }
+        }
+    }
+}
+
+template<typename T>
+void prepareTasks(Node* root){
+    std::unordered_map<std::string, Node*> functions;
+    prepareBlock<T>(root, functions, true);
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template void parallelizeLoops<double>(Node* root);
+template void parallelizeLoops<long double>(Node* root);
+template void prepareTasks<double>(Node* root);
+template void prepareTasks<long double>(Node* root);
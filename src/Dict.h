@@ -0,0 +1,163 @@
+#pragma once
+#ifndef SQBRA_DICT_H
+#define SQBRA_DICT_H
+
+/*
+ *  DICT.H
+ *  This file declares the dictionary type of the SquareBracket language: a hash table from numbers to numbers.
+ *  All entries live in one array (open addressing with linear probing) that is at most half full, so a lookup
+ *  usually reads one or two neighbouring slots. Removed entries are closed by moving the following entries of the
+ *  same run back, so the table never contains deleted markers.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Names.h"
+
+const size_t DICT_MIN_CAPACITY = 16; // number of slots of the first table (always a power of two)
+
+template<typename T>
+struct Dict {
+    struct Slot {
+        T key;
+        T value;
+        bool used;
+    };
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    //! Number of Entries
+    size_t size() const { return count; }
+
+    //! Remove all Entries
+    void clear(){
+        slots.clear();
+        count = 0;
+    }
+
+    //! Hash of a Key (0 and -0 are the same key; long double keys are hashed with their double value)
+    static uint64_t hash(T key){
+        double d = (double)key;
+        if(d == 0){
+            d = 0;
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        // finalizer of MurmurHash3: every bit of the key changes about half of the bits of the hash
+        bits ^= bits >> 33;
+        bits *= 0xff51afd7ed558ccdULL;
+        bits ^= bits >> 33;
+        bits *= 0xc4ceb9fe1a85ec53ULL;
+        bits ^= bits >> 33;
+        return bits;
+    }
+
+    //! Pointer to the Value of a Key (nullptr if the Key is Missing)
+    T* find(T key){
+        if(count == 0){
+            return nullptr;
+        }
+        size_t mask = slots.size() - 1;
+        for(size_t i = hash(key) & mask; slots[i].used; i = (i + 1) & mask){
+            if(slots[i].key == key){
+                return &slots[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    //! Value of a Key; a Missing Key is Added with the Value 0
+    T& insert(T key){
+        if(2 * (count + 1) > slots.size()){
+            grow();
+        }
+        size_t mask = slots.size() - 1;
+        size_t i = hash(key) & mask;
+        for(; slots[i].used; i = (i + 1) & mask){
+            if(slots[i].key == key){
+                return slots[i].value;
+            }
+        }
+        slots[i] = Slot{key, T(0), true};
+        count++;
+        return slots[i].value;
+    }
+
+    //! Remove a Key; Returns False if it is Missing
+    bool erase(T key){
+        if(count == 0){
+            return false;
+        }
+        size_t mask = slots.size() - 1;
+        size_t i = hash(key) & mask;
+        for(; !slots[i].used || slots[i].key != key; i = (i + 1) & mask){
+            if(!slots[i].used){
+                return false;
+            }
+        }
+        // move back every following entry of the run that may not stay behind the gap
+        for(size_t j = (i + 1) & mask; slots[j].used; j = (j + 1) & mask){
+            size_t home = hash(slots[j].key) & mask;
+            if(((j - home) & mask) >= ((j - i) & mask)){
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].used = false;
+        count--;
+        return true;
+    }
+
+private:
+    //! Double the Number of Slots and Insert all Entries Again
+    void grow(){
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.empty() ? DICT_MIN_CAPACITY : 2 * old.size(), Slot{T(0), T(0), false});
+        size_t mask = slots.size() - 1;
+        for(const Slot& slot : old){
+            if(slot.used){
+                size_t i = hash(slot.key) & mask;
+                while(slots[i].used){
+                    i = (i + 1) & mask;
+                }
+                slots[i] = slot;
+            }
+        }
+    }
+};
+
+//! Value of a Key (With the Error of the Interpreter if it is Missing)
+template<typename T>
+inline T dictGet(Dict<T>* dict, T key){
+    T* value = dict->find(key);
+    if(value == nullptr){
+        std::cerr << "Error: key <" << key << "> is not in dictionary <" << containerName(dict) << ">." << std::endl;
+        exit(0);
+    }
+    return *value;
+}
+
+//! Value of a Key, or fallback if it is Missing
+template<typename T>
+inline T dictGet(Dict<T>* dict, T key, T fallback){
+    T* value = dict->find(key);
+    return value == nullptr ? fallback : *value;
+}
+
+//! Set the Value of a Key (nan is not a Valid Key: it is not Equal to Itself)
+template<typename T>
+inline void dictSet(Dict<T>* dict, T key, T value){
+    if(key != key){
+        std::cerr << "Error: nan is not a valid key for dictionary <" << containerName(dict) << ">." << std::endl;
+        exit(0);
+    }
+    dict->insert(key) = value;
+}
+
+#endif //SQBRA_DICT_H
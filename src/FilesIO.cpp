@@ -28,47 +28,188 @@ std::string extract_list_string(const std::string& input) {
     return input.substr(start_pos + 1, end_pos - start_pos - 1);
 }
 
-//! Read and input csv files as matrices
-void read_csv(const std::string& filename, std::vector<std::vector<long double>*>* output) {
+//! Append rows to a matrix (short rows are filled up with zeros)
+template<typename T>
+void append_rows(Matrix<T>* matrix, const std::vector<std::vector<T> >& rows) {
+    size_t first = matrix->rows;
+    size_t cols = matrix->cols;
+    for (const auto& row : rows) {
+        cols = std::max(cols, row.size());
+    }
+    matrix->resize(first + rows.size(), cols);
+    for (size_t i = 0; i < rows.size(); i++) {
+        std::copy(rows[i].begin(), rows[i].end(), matrix->row(first + i));
+    }
+}
+
+//! Convert the values of a line of a csv file
+template<typename T>
+void parse_csv_line(const std::string& line, std::vector<T>& linevector) {
+    linevector.clear();
+    std::istringstream ss(line);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        try {
+            T value = (T)std::stold(token);
+            linevector.push_back(value);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Failed to convert token to long double: " << token << std::endl;
+            exit(0);
+        }
+    }
+}
+
+//! Open a csv file for reading
+std::ifstream open_csv(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Unable to open file: " << filename << std::endl;
         exit(0);
     }
+    return file;
+}
+
+//! Read the rows of a csv file
+template<typename T>
+std::vector<std::vector<T> > read_csv_rows(const std::string& filename) {
+    std::ifstream file = open_csv(filename);
+    std::vector<std::vector<T> > rows;
     std::string line;
     while (std::getline(file, line)) {
-        auto linevector = new std::vector<long double>;
-        std::istringstream ss(line);
-        std::string token;
-        while (std::getline(ss, token, ',')) {
-            try {
-                long double value = std::stold(token);
-                linevector->push_back(value);
-            } catch (const std::exception& e) {
-                std::cerr << "Error: Failed to convert token to long double: " << token << std::endl;
-                exit(0);
-            }
+        std::vector<T> linevector;
+        parse_csv_line(line, linevector);
+        rows.push_back(linevector);
+    }
+    return rows;
+}
+
+//! Read a csv file line by line into the rows of a file-backed matrix, starting at its first row (its dimensions stay,
+//! short rows are filled up with zeros)
+template<typename T>
+void read_csv_mapped(const std::string& filename, Matrix<T>* output) {
+    std::ifstream file = open_csv(filename);
+    std::vector<T> linevector;
+    std::string line;
+    size_t tile = std::max<size_t>(MAPPED_TILE / std::max<size_t>(output->cols * sizeof(T), 1), 1);
+    size_t i = 0;
+    for (; std::getline(file, line); i++) {
+        parse_csv_line(line, linevector);
+        if (i >= output->rows || linevector.size() > output->cols) {
+            std::cerr << "Error: line " << i + 1 << " of " << filename << " does not fit into file-backed matrix <" << output << "> (" << output->rows << "x" << output->cols << ")." << std::endl;
+            exit(0);
+        }
+        std::copy(linevector.begin(), linevector.end(), output->row(i));
+        std::fill(output->row(i) + linevector.size(), output->row(i) + output->cols, T(0)); // short rows are filled up with zeros
+        if ((i + 1) % tile == 0) {
+            output->adviseRows(i + 1 - tile, i + 1, true);
         }
-        output->push_back(linevector);
     }
+    output->adviseRows(i - i % tile, i, true);
+}
+
+//! Read and input csv files as matrices
+template<typename T>
+void read_csv(const std::string& filename, Matrix<T>* output) {
+    if (output->mapped != 0) {
+        read_csv_mapped(filename, output);
+        return;
+    }
+    append_rows(output, read_csv_rows<T>(filename));
+}
+
+//! Read and input csv files as typed matrices (every value is converted to the type of the entries)
+void read_csv(const std::string& filename, TypedArray* output) {
+    std::vector<std::vector<long double> > rows = read_csv_rows<long double>(filename);
+    size_t first = output->rows;
+    size_t cols = output->cols;
+    for (const auto& row : rows) {
+        cols = std::max(cols, row.size());
+    }
+    output->resize(first + rows.size(), cols);
+    for (size_t i = 0; i < rows.size(); i++) {
+        for (size_t j = 0; j < rows[i].size(); j++) {
+            typedStore(output, (first + i) * cols + j, rows[i][j]);
+        }
+    }
+}
+
+//! Read a csv file of entries row,col,value into a sparse matrix (the dimensions grow to hold every entry)
+template<typename T>
+void read_csv(const std::string& filename, SparseMatrix<T>* output) {
+    std::vector<T> r, c, v;
+    sparseTriplets(output, r, c, v);
+    size_t rows = output->rows;
+    size_t cols = output->cols;
+    std::vector<std::vector<T> > lines = read_csv_rows<T>(filename);
+    for (size_t k = 0; k < lines.size(); k++) {
+        const std::vector<T>& line = lines[k];
+        if (line.empty()) {
+            continue;
+        }
+        if (line.size() != 3 || !(line[0] >= 0) || !(line[1] >= 0)) {
+            std::cerr << "Error: line " << k + 1 << " of " << filename << " is not an entry row,col,value." << std::endl;
+            exit(0);
+        }
+        r.push_back(line[0]);
+        c.push_back(line[1]);
+        v.push_back(line[2]);
+        rows = std::max(rows, (size_t)line[0] + 1);
+        cols = std::max(cols, (size_t)line[1] + 1);
+    }
+    sparseBuild(output, rows, cols, r, c, v);
 }
 
 //! Write matrices to csv files
-void write_csv(const std::string& filename, std::vector<std::vector<long double>*>* numbers) {
+template<typename T>
+void write_csv(const std::string& filename, Matrix<T>* numbers) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file: " << filename << std::endl;
+        exit(0);
+    }
+    forRowTiles(numbers->rows, {numbers}, [&](size_t first, size_t last){
+        for (size_t i = first; i < last; i++){
+            const T* row = numbers->row(i);
+            for (size_t x = 0; x < numbers->cols; x++){
+                file << row[x];
+                if (x < numbers->cols - 1){
+                    file << ",";
+                }
+            }
+            if(i < numbers->rows - 1){
+                file << "\n";
+            }else{
+                file << " ";
+            }
+        }
+    });
+    // Remove the last comma
+    file.seekp(-1, std::ios_base::end);
+    file << std::endl;
+}
+
+//! Write typed matrices to csv files (integers exactly, floating point numbers with all digits of their type)
+void write_csv(const std::string& filename, TypedArray* numbers) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Unable to open file: " << filename << std::endl;
         exit(0);
     }
-    for (int i = 0; i < numbers->size(); i++){
-        std::vector<long double>* subvector = (*numbers)[i];
-        for (int x = 0; x < subvector->size(); x++){
-            file << (*subvector)[x];
-            if (x < subvector->size() - 1){
+    file.precision(numbers->type == ElementType::F32 ? 9 : 17);
+    for (size_t i = 0; i < numbers->rows; i++){
+        for (size_t x = 0; x < numbers->cols; x++){
+            size_t k = i * numbers->cols + x;
+            switch (numbers->type) {
+                case ElementType::I32: file << ((const int32_t*)numbers->bytes.data())[k]; break;
+                case ElementType::I64: file << ((const int64_t*)numbers->bytes.data())[k]; break;
+                case ElementType::F32: file << ((const float*)numbers->bytes.data())[k]; break;
+                default: file << ((const double*)numbers->bytes.data())[k]; break;
+            }
+            if (x < numbers->cols - 1){
                 file << ",";
             }
         }
-        if(i < numbers->size() - 1){
+        if(i < numbers->rows - 1){
             file << "\n";
         }else{
             file << " ";
@@ -80,12 +221,13 @@ void write_csv(const std::string& filename, std::vector<std::vector<long double>
 }
 
 //! Parse a string [0.32, 0.435, 3.141] to a list
-void parse_numbers(const std::string& input, std::vector<long double>* output) {
+template<typename T>
+void parse_numbers(const std::string& input, std::vector<T>* output) {
     std::istringstream ss(input);
     std::string token;
     while (std::getline(ss, token, ',')) {
         try {
-            long double value = std::stold(token);
+            T value = (T)std::stold(token);
             output->push_back(value);
         } catch (const std::exception& e) {
             // Handle conversion error
@@ -94,11 +236,13 @@ void parse_numbers(const std::string& input, std::vector<long double>* output) {
 }
 
 //! Parse a string [[1,2,3],[4,5,6],[7,8,9]] to a matrix
-void parse_matrix(std::string& matrix_string, std::vector<std::vector<long double>* >* matrix){
+template<typename T>
+void parse_matrix(std::string& matrix_string, Matrix<T>* matrix){
     // Remove the outermost brackets from the matrix string
     std::string stripped_string = matrix_string.substr(1, matrix_string.length() - 2);
 
     // Split the matrix string into rows
+    std::vector<std::vector<T> > rows;
     std::stringstream row_stream(stripped_string);
     std::string row_string;
     while (std::getline(row_stream, row_string, ']'))
@@ -111,17 +255,31 @@ void parse_matrix(std::string& matrix_string, std::vector<std::vector<long doubl
         // Remove the leading "[" character from each row string
         row_string = row_string.substr(1);
 
-        // Parse the row string into a vector of long doubles
-        auto row = new std::vector<long double>();
+        // Parse the row string into a vector of numbers
+        std::vector<T> row;
         std::stringstream value_stream(row_string);
         std::string value_string;
         while (std::getline(value_stream, value_string, ','))
         {
-            long double value = std::stold(value_string);
-            row->push_back(value);
+            T value = (T)std::stold(value_string);
+            row.push_back(value);
         }
-
-        // Add the row to the matrix
-        matrix->push_back(row);
+        rows.push_back(row);
     }
+
+    // Add the rows to the matrix
+    append_rows(matrix, rows);
 }
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template void read_csv<double>(const std::string& filename, Matrix<double>* output);
+template void read_csv<long double>(const std::string& filename, Matrix<long double>* output);
+template void read_csv<double>(const std::string& filename, SparseMatrix<double>* output);
+template void read_csv<long double>(const std::string& filename, SparseMatrix<long double>* output);
+template void write_csv<double>(const std::string& filename, Matrix<double>* numbers);
+template void write_csv<long double>(const std::string& filename, Matrix<long double>* numbers);
+template void parse_numbers<double>(const std::string& input, std::vector<double>* output);
+template void parse_numbers<long double>(const std::string& input, std::vector<long double>* output);
+template void parse_matrix<double>(std::string& matrix_string, Matrix<double>* matrix);
+template void parse_matrix<long double>(std::string& matrix_string, Matrix<long double>* matrix);
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef SQBRA_HEAP_H
+#define SQBRA_HEAP_H
+
+/*
+ *  HEAP.H
+ *  This file declares the heap type of the SquareBracket language: a priority queue of numbers that always returns
+ *  the value with the smallest priority first (values with equal priorities in the order they were pushed).
+ *  It is a 4-ary heap: every node has four children that lie next to each other, so the heap is only half as deep
+ *  as a binary heap, and the priorities are stored apart from the values, so every step down compares four
+ *  neighbouring priorities of one or two cache lines.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Names.h"
+
+const size_t HEAP_ARITY = 4; // children of every node
+
+template<typename T>
+struct Heap {
+    std::vector<T> priorities;
+    std::vector<T> values;
+    std::vector<uint64_t> order; // number of the push: breaks ties between equal priorities
+    uint64_t pushed = 0;
+
+    //! Number of Entries
+    size_t size() const { return priorities.size(); }
+
+    //! Remove all Entries
+    void clear(){
+        priorities.clear();
+        values.clear();
+        order.clear();
+        pushed = 0;
+    }
+
+    //! Check Whether the Entry at Position i Leaves Before an Entry with the Given Priority and Number
+    bool before(size_t i, T priority, uint64_t number) const {
+        return priorities[i] < priority || (priorities[i] == priority && order[i] < number);
+    }
+
+    //! Add a Value (the Hole of the New Entry Moves Up Until its Parent Leaves Before it)
+    void push(T value, T priority){
+        uint64_t number = pushed++;
+        size_t i = size();
+        priorities.push_back(priority);
+        values.push_back(value);
+        order.push_back(number);
+        while(i > 0){
+            size_t parent = (i - 1) / HEAP_ARITY;
+            if(before(parent, priority, number)){
+                break;
+            }
+            move(parent, i);
+            i = parent;
+        }
+        place(i, value, priority, number);
+    }
+
+    //! Remove the Entry with the Smallest Priority (the Last Entry Moves Down From the Root)
+    void pop(){
+        size_t n = size() - 1;
+        T priority = priorities[n];
+        T value = values[n];
+        uint64_t number = order[n];
+        priorities.pop_back();
+        values.pop_back();
+        order.pop_back();
+        if(n == 0){
+            return;
+        }
+        size_t i = 0;
+        for(;;){
+            size_t first = HEAP_ARITY * i + 1;
+            if(first >= n){
+                break;
+            }
+            size_t last = std::min(first + HEAP_ARITY, n);
+            size_t best = first;
+            for(size_t child = first + 1; child < last; child++){
+                if(before(child, priorities[best], order[best])){
+                    best = child;
+                }
+            }
+            if(!before(best, priority, number)){
+                break;
+            }
+            move(best, i);
+            i = best;
+        }
+        place(i, value, priority, number);
+    }
+
+private:
+    void move(size_t from, size_t to){
+        priorities[to] = priorities[from];
+        values[to] = values[from];
+        order[to] = order[from];
+    }
+
+    void place(size_t i, T value, T priority, uint64_t number){
+        priorities[i] = priority;
+        values[i] = value;
+        order[i] = number;
+    }
+};
+
+//! Add a Value with a Priority (nan is not a Valid Priority: it cannot be Compared)
+template<typename T>
+inline void heapPush(Heap<T>* heap, T value, T priority){
+    if(priority != priority){
+        std::cerr << "Error: nan is not a valid priority for heap <" << containerName(heap) << ">." << std::endl;
+        exit(0);
+    }
+    heap->push(value, priority);
+}
+
+//! Check that the Heap has an Entry (With the Error of the Interpreter Otherwise)
+template<typename T>
+inline Heap<T>* heapFront(Heap<T>* heap){
+    if(heap->size() == 0){
+        std::cerr << "Error: heap <" << containerName(heap) << "> is empty." << std::endl;
+        exit(0);
+    }
+    return heap;
+}
+
+#endif //SQBRA_HEAP_H
@@ -0,0 +1,349 @@
+/*
+ *  JIT.CPP
+ *  This file contains the just-in-time compiler for the SquareBracket language.
+ *  Hot expressions and loops whose bodies only contain SET, INC and DEC are translated to x87 machine code,
+ *  which computes with the same 80 bit precision as the interpreter. Everything else stays interpreted.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Jit.h"
+
+bool jit_enabled = false;
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+
+typedef std::vector<uint8_t> MachineCode;
+
+const int X87_REGISTERS = 8;
+
+// AUXILIARY FUNCTIONS ##############################################################
+
+//! Append Raw Bytes to the Machine Code
+inline void emitBytes(MachineCode& code, std::initializer_list<uint8_t> bytes){
+    code.insert(code.end(), bytes.begin(), bytes.end());
+}
+
+//! Append a 32 Bit Value to the Machine Code
+inline void emitImm32(MachineCode& code, int32_t value){
+    for(int i = 0; i < 4; i++){
+        code.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+//! Load an Address into rax (movabs rax, imm64)
+inline void emitAddress(MachineCode& code, void* address){
+    auto value = (uint64_t)address;
+    emitBytes(code, {0x48, 0xB8});
+    for(int i = 0; i < 8; i++){
+        code.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+//! Emit a Jump with 32 Bit Displacement and Return the Position of the Displacement
+inline size_t emitJump(MachineCode& code, std::initializer_list<uint8_t> opcode){
+    emitBytes(code, opcode);
+    emitImm32(code, 0);
+    return code.size() - 4;
+}
+
+//! Let the Displacement at Position pos Point to target
+inline void patchJump(MachineCode& code, size_t pos, size_t target){
+    auto rel = (int32_t)(target - (pos + 4));
+    std::memcpy(&code[pos], &rel, 4);
+}
+
+//! Copy the Machine Code to Executable Memory
+void* makeExecutable(const MachineCode& code){
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t size = (code.size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED){
+        return nullptr;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if(mprotect(memory, size, PROT_READ | PROT_EXEC) != 0){
+        munmap(memory, size);
+        return nullptr;
+    }
+    return memory;
+}
+
+// X87 CODE GENERATION ##############################################################
+
+struct X87State {
+    int depth = 0; // number of values on the x87 register stack
+    bool overflow = false;
+};
+
+//! Track a Push on the x87 Register Stack
+inline void push(X87State& st, int n = 1){
+    st.depth += n;
+    if(st.depth > X87_REGISTERS){
+        st.overflow = true;
+    }
+}
+
+//! Push the long double at address (fld tbyte [rax])
+inline void emitLoad(MachineCode& code, X87State& st, void* address){
+    emitAddress(code, address);
+    emitBytes(code, {0xDB, 0x28});
+    push(st);
+}
+
+//! Pop st(0) to the long double at address (fstp tbyte [rax])
+inline void emitStore(MachineCode& code, X87State& st, void* address){
+    emitAddress(code, address);
+    emitBytes(code, {0xDB, 0x38});
+    st.depth--;
+}
+
+//! Replace st(1) and st(0) by the Result of st(1) <op> st(0)
+bool emitArithmetic(MachineCode& code, X87State& st, MathCode op){
+    switch(op){
+        case MathCode::ADD: emitBytes(code, {0xDE, 0xC1}); break; // faddp st(1), st
+        case MathCode::SUB: emitBytes(code, {0xDE, 0xE9}); break; // fsubp st(1), st
+        case MathCode::MULT: emitBytes(code, {0xDE, 0xC9}); break; // fmulp st(1), st
+        case MathCode::DIV: emitBytes(code, {0xDE, 0xF9}); break; // fdivp st(1), st
+        default: return false;
+    }
+    st.depth--;
+    return true;
+}
+
+//! Replace st(1) = a and st(0) = b by 1 or 0 Depending on the Comparison a <op> b (NaN Compares False)
+bool emitComparison(MachineCode& code, X87State& st, MathCode op){
+    if(op == MathCode::LARGER || op == MathCode::LARGEREQ){
+        emitBytes(code, {0xD9, 0xC9}); // fxch st(1) -> compare a with b
+    }else if(op != MathCode::LESS && op != MathCode::LESSEQ && op != MathCode::EQ && op != MathCode::NEQ){
+        return false;
+    }
+    emitBytes(code, {0xDF, 0xE9}); // fucomip st, st(1)
+    emitBytes(code, {0xDD, 0xD8}); // fstp st(0)
+    if(op == MathCode::NEQ){
+        emitBytes(code, {0xD9, 0xE8, 0xD9, 0xEE}); // fld1, fldz
+        emitBytes(code, {0xDB, 0xC9}); // fcmovne st, st(1)
+        emitBytes(code, {0xDA, 0xD9}); // fcmovu st, st(1)
+    }else{
+        emitBytes(code, {0xD9, 0xEE, 0xD9, 0xE8}); // fldz, fld1
+        if(op == MathCode::EQ){
+            emitBytes(code, {0xDB, 0xC9}); // fcmovne st, st(1)
+            emitBytes(code, {0xDA, 0xD9}); // fcmovu st, st(1)
+        }else if(op == MathCode::LARGER || op == MathCode::LESS){
+            emitBytes(code, {0xDA, 0xD1}); // fcmovbe st, st(1)
+        }else{
+            emitBytes(code, {0xDA, 0xC1}); // fcmovb st, st(1)
+        }
+    }
+    emitBytes(code, {0xDD, 0xD9}); // fstp st(1)
+    st.depth -= 2;
+    push(st, 2); // fldz and fld1 replace the operands
+    st.depth -= 1;
+    return true;
+}
+
+//! Replace st(0) by 1 if it is Larger Than 0, Otherwise by 0
+inline void emitTruth(MachineCode& code, X87State& st){
+    emitBytes(code, {0xD9, 0xEE}); // fldz
+    push(st);
+    emitComparison(code, st, MathCode::LARGER);
+}
+
+//! Pop st(0) and Jump if it is not Larger Than 0 (Returns the Position of the Displacement)
+inline size_t emitJumpIfFalse(MachineCode& code, X87State& st){
+    emitBytes(code, {0xD9, 0xEE}); // fldz
+    push(st);
+    emitBytes(code, {0xD9, 0xC9}); // fxch st(1)
+    emitBytes(code, {0xDF, 0xE9}); // fucomip st, st(1)
+    emitBytes(code, {0xDD, 0xD8}); // fstp st(0)
+    st.depth -= 2;
+    return emitJump(code, {0x0F, 0x86}); // jbe
+}
+
+//! Map the ...P Variant of an Operator to the Operator
+inline MathCode withoutPointer(MathCode op){
+    return (MathCode)((int)op - (int)MathCode::ADDP + (int)MathCode::ADD);
+}
+
+//! Emit the x87 Code of a Flattened Expression, Leaving its Value in st(0)
+bool emitProgram(MachineCode& code, X87State& st, const MathProgram<long double>* program){
+    std::vector<size_t> offsets;              // machine code offset of each instruction
+    std::vector<std::pair<size_t, int> > jumps; // displacement position and target instruction
+    for(const MathInstr& in : program->code){
+        offsets.push_back(code.size());
+        MathCode op = in.code;
+        switch(op){
+            case MathCode::PUSH:
+                emitLoad(code, st, in.variable);
+                break;
+            case MathCode::ADD: case MathCode::SUB: case MathCode::MULT: case MathCode::DIV:
+                emitArithmetic(code, st, op);
+                break;
+            case MathCode::ADDP: case MathCode::SUBP: case MathCode::MULTP: case MathCode::DIVP:
+                emitLoad(code, st, in.variable);
+                emitArithmetic(code, st, withoutPointer(op));
+                break;
+            case MathCode::EQ: case MathCode::NEQ: case MathCode::LARGER: case MathCode::LARGEREQ: case MathCode::LESS: case MathCode::LESSEQ:
+                emitComparison(code, st, op);
+                break;
+            case MathCode::EQP: case MathCode::NEQP: case MathCode::LARGERP: case MathCode::LARGEREQP: case MathCode::LESSP: case MathCode::LESSEQP:
+                emitLoad(code, st, in.variable);
+                emitComparison(code, st, withoutPointer(op));
+                break;
+            case MathCode::TRUTH:
+                emitTruth(code, st);
+                break;
+            case MathCode::ANDJ:
+            case MathCode::ORJ:
+                // keep the truth value as result if the right side is skipped, otherwise drop it
+                emitTruth(code, st);
+                emitBytes(code, {0xD9, 0xEE}); // fldz
+                push(st);
+                emitBytes(code, {0xDF, 0xE9}); // fucomip st, st(1)
+                st.depth--;
+                jumps.emplace_back(emitJump(code, {0x0F, (uint8_t)(op == MathCode::ANDJ ? 0x84 : 0x85)}), in.jump); // je / jne
+                emitBytes(code, {0xDD, 0xD8}); // fstp st(0)
+                st.depth--;
+                break;
+            default:
+                return false; // lists, matrices, MOD and EXP need calls and stay interpreted
+        }
+    }
+    offsets.push_back(code.size());
+    for(auto& jump : jumps){
+        patchJump(code, jump.first, offsets[jump.second]);
+    }
+    return !st.overflow;
+}
+
+//! Emit the Code of an Arbitrary MathTree Root (Leaves are not Flattened)
+bool emitExpression(MachineCode& code, X87State& st, MathNode* root){
+    if(root->program != nullptr){
+        return emitProgram(code, st, (MathProgram<long double>*)root->program);
+    }else if(root->type == MathNodeType::Constant){
+        emitLoad(code, st, &root->constant);
+        return true;
+    }else if(root->type == MathNodeType::Variable){
+        emitLoad(code, st, root->variable);
+        return true;
+    }
+    return false;
+}
+
+//! Emit a Body Consisting Only of SET, INC and DEC on Variables
+bool emitBody(MachineCode& code, X87State& st, Node* exec){
+    for(Node* statement : exec->children){
+        if(statement->type == END){
+            continue;
+        }
+        if(statement->type != SET && statement->type != INC && statement->type != DEC){
+            return false;
+        }
+        MathNode* target = statement->children[0]->expression;
+        if(target->type != MathNodeType::Variable){
+            return false;
+        }
+        if(statement->type == SET){
+            if(!emitExpression(code, st, statement->children[1]->expression)){
+                return false;
+            }
+        }else{
+            emitLoad(code, st, target->variable);
+            emitBytes(code, {0xD9, 0xE8}); // fld1
+            push(st);
+            emitArithmetic(code, st, statement->type == INC ? MathCode::ADD : MathCode::SUB);
+        }
+        emitStore(code, st, target->variable);
+    }
+    return !st.overflow;
+}
+
+// INTERFACE ########################################################################
+
+bool jitSupported(){
+    return true;
+}
+
+//! Compile a Flattened Expression to a Function Returning its Value in st(0)
+bool jitCompileExpression(MathProgram<long double>* program){
+    MachineCode code;
+    X87State st;
+    if(!emitProgram(code, st, program)){
+        return false;
+    }
+    emitBytes(code, {0xC3}); // ret
+    program->native = (long double (*)())makeExecutable(code);
+    return program->native != nullptr;
+}
+
+//! Compile the Rest of a LOOP, AUTOLOOP, SLOOP or WHILE to a Function (Takes the Remaining SLOOP Count)
+bool jitCompileLoop(Node* loop){
+    MachineCode code;
+    X87State st;
+    size_t top;
+    size_t exit;
+    if(loop->type == LOOP || loop->type == AUTOLOOP){
+        MathNode* counter = loop->children[0]->expression;
+        if(counter->type != MathNodeType::Variable){
+            return false;
+        }
+        top = code.size();
+        emitLoad(code, st, counter->variable);
+        exit = emitJumpIfFalse(code, st);
+        if(!emitBody(code, st, loop->children[loop->type == LOOP ? 1 : 2])){
+            return false;
+        }
+        emitLoad(code, st, counter->variable);
+        emitBytes(code, {0xD9, 0xE8}); // fld1
+        push(st);
+        emitArithmetic(code, st, MathCode::SUB);
+        emitStore(code, st, counter->variable);
+    }else if(loop->type == SLOOP){
+        emitBytes(code, {0x89, 0xF9}); // mov ecx, edi
+        top = code.size();
+        emitBytes(code, {0x85, 0xC9}); // test ecx, ecx
+        exit = emitJump(code, {0x0F, 0x8E}); // jle
+        if(!emitBody(code, st, loop->children[1])){
+            return false;
+        }
+        emitBytes(code, {0xFF, 0xC9}); // dec ecx
+    }else if(loop->type == WHILE){
+        top = code.size();
+        if(!emitExpression(code, st, loop->children[0]->expression)){
+            return false;
+        }
+        exit = emitJumpIfFalse(code, st);
+        if(!emitBody(code, st, loop->children[1])){
+            return false;
+        }
+    }else{
+        return false;
+    }
+    patchJump(code, emitJump(code, {0xE9}), top); // jmp top
+    patchJump(code, exit, code.size());
+    emitBytes(code, {0xC3}); // ret
+    if(st.overflow){
+        return false;
+    }
+    loop->native = (void (*)(int))makeExecutable(code);
+    return loop->native != nullptr;
+}
+
+#else
+
+bool jitSupported(){
+    return false;
+}
+
+bool jitCompileExpression(MathProgram<long double>* program){
+    return false;
+}
+
+bool jitCompileLoop(Node* loop){
+    return false;
+}
+
+#endif
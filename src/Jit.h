@@ -0,0 +1,23 @@
+#pragma once
+#ifndef SQBRA_JIT_H
+#define SQBRA_JIT_H
+
+/*
+ *  JIT.H
+ *  This file declares the just-in-time compiler for hot expressions and simple loops (x86-64 Linux only).
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Tokens.h"
+
+extern bool jit_enabled; // set by the flag --jit
+
+const int JIT_THRESHOLD = 1000; // evaluations of an expression or iterations of a loop before it is compiled
+
+bool jitSupported();
+
+bool jitCompileExpression(MathProgram<long double>* program);
+
+bool jitCompileLoop(Node* loop);
+
+#endif //SQBRA_JIT_H
@@ -0,0 +1,444 @@
+#pragma once
+#ifndef SQBRA_KERNELS_H
+#define SQBRA_KERNELS_H
+
+/*
+ *  KERNELS.H
+ *  This file contains the bulk kernels that operate on whole lists and matrices.
+ *  Kernels for double use AVX2 (if the processor supports it) or SSE2 on x86-64; long double and all other
+ *  platforms use the scalar loops. The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#include "Mapped.h"
+#include "Names.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SQBRA_SIMD 1
+#define SQBRA_AVX2 __attribute__((target("avx2")))
+#endif
+
+// ELEMENT OPERATIONS ###############################################################
+// Every operation has a scalar form for all precisions and SSE2/AVX2 forms for double.
+// Comparisons return 1 or 0 like the operators of an expression.
+
+struct KernelAdd {
+    template<typename T> static T apply(T a, T b){ return a + b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_add_pd(a, b); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_add_pd(a, b); }
+#endif
+};
+
+struct KernelSub {
+    template<typename T> static T apply(T a, T b){ return a - b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_sub_pd(a, b); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_sub_pd(a, b); }
+#endif
+};
+
+struct KernelMul {
+    template<typename T> static T apply(T a, T b){ return a * b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_mul_pd(a, b); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_mul_pd(a, b); }
+#endif
+};
+
+struct KernelDiv {
+    template<typename T> static T apply(T a, T b){ return a / b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_div_pd(a, b); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_div_pd(a, b); }
+#endif
+};
+
+struct KernelEq {
+    template<typename T> static T apply(T a, T b){ return a == b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmpeq_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+struct KernelNeq {
+    template<typename T> static T apply(T a, T b){ return a != b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmpneq_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+struct KernelLess {
+    template<typename T> static T apply(T a, T b){ return a < b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmplt_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+struct KernelLessEq {
+    template<typename T> static T apply(T a, T b){ return a <= b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmple_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+struct KernelLarger {
+    template<typename T> static T apply(T a, T b){ return a > b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmpgt_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+struct KernelLargerEq {
+    template<typename T> static T apply(T a, T b){ return a >= b; }
+#ifdef SQBRA_SIMD
+    static __m128d apply(__m128d a, __m128d b){ return _mm_and_pd(_mm_cmpge_pd(a, b), _mm_set1_pd(1.0)); }
+    SQBRA_AVX2 static __m256d apply(__m256d a, __m256d b){ return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ), _mm256_set1_pd(1.0)); }
+#endif
+};
+
+// SIMD LOOPS (double) ##############################################################
+
+#ifdef SQBRA_SIMD
+//! Check Once Whether the Processor Supports AVX2
+inline bool kernelAvx2(){
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+template<typename Op>
+SQBRA_AVX2 void binaryAvx2(const double* a, const double* b, double* dst, size_t n){
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(dst + i, Op::apply(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    for(; i < n; i++){
+        dst[i] = Op::apply(a[i], b[i]);
+    }
+}
+
+template<typename Op>
+void binarySse2(const double* a, const double* b, double* dst, size_t n){
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2){
+        _mm_storeu_pd(dst + i, Op::apply(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    for(; i < n; i++){
+        dst[i] = Op::apply(a[i], b[i]);
+    }
+}
+
+template<typename Op>
+SQBRA_AVX2 void binaryScalarAvx2(const double* a, double b, double* dst, size_t n){
+    __m256d vb = _mm256_set1_pd(b);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(dst + i, Op::apply(_mm256_loadu_pd(a + i), vb));
+    }
+    for(; i < n; i++){
+        dst[i] = Op::apply(a[i], b);
+    }
+}
+
+template<typename Op>
+void binaryScalarSse2(const double* a, double b, double* dst, size_t n){
+    __m128d vb = _mm_set1_pd(b);
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2){
+        _mm_storeu_pd(dst + i, Op::apply(_mm_loadu_pd(a + i), vb));
+    }
+    for(; i < n; i++){
+        dst[i] = Op::apply(a[i], b);
+    }
+}
+
+SQBRA_AVX2 inline void axpyAvx2(double alpha, const double* x, double* y, size_t n){
+    __m256d va = _mm256_set1_pd(alpha);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_mul_pd(va, _mm256_loadu_pd(x + i)), _mm256_loadu_pd(y + i)));
+    }
+    for(; i < n; i++){
+        y[i] = alpha * x[i] + y[i];
+    }
+}
+
+inline void axpySse2(double alpha, const double* x, double* y, size_t n){
+    __m128d va = _mm_set1_pd(alpha);
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2){
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(x + i)), _mm_loadu_pd(y + i)));
+    }
+    for(; i < n; i++){
+        y[i] = alpha * x[i] + y[i];
+    }
+}
+
+// max(lo, x) and min(hi, x) return x if x is NaN, like the scalar loop
+SQBRA_AVX2 inline void clampAvx2(const double* src, double lo, double hi, double* dst, size_t n){
+    __m256d vlo = _mm256_set1_pd(lo);
+    __m256d vhi = _mm256_set1_pd(hi);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(dst + i, _mm256_min_pd(vhi, _mm256_max_pd(vlo, _mm256_loadu_pd(src + i))));
+    }
+    for(; i < n; i++){
+        dst[i] = src[i] < lo ? lo : (hi < src[i] ? hi : src[i]);
+    }
+}
+
+inline void clampSse2(const double* src, double lo, double hi, double* dst, size_t n){
+    __m128d vlo = _mm_set1_pd(lo);
+    __m128d vhi = _mm_set1_pd(hi);
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2){
+        _mm_storeu_pd(dst + i, _mm_min_pd(vhi, _mm_max_pd(vlo, _mm_loadu_pd(src + i))));
+    }
+    for(; i < n; i++){
+        dst[i] = src[i] < lo ? lo : (hi < src[i] ? hi : src[i]);
+    }
+}
+#endif
+
+// KERNELS (n contiguous elements, dst may be identical to an operand) ##############
+
+//! Elementwise Operation of Two Arrays: dst[i] = a[i] op b[i]
+template<typename Op, typename T>
+void kernelBinary(const T* a, const T* b, T* dst, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        return kernelAvx2() ? binaryAvx2<Op>(a, b, dst, n) : binarySse2<Op>(a, b, dst, n);
+    }
+#endif
+    for(size_t i = 0; i < n; i++){
+        dst[i] = Op::apply(a[i], b[i]);
+    }
+}
+
+//! Elementwise Operation of an Array and a Value: dst[i] = a[i] op b
+template<typename Op, typename T>
+void kernelBinaryScalar(const T* a, T b, T* dst, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        return kernelAvx2() ? binaryScalarAvx2<Op>(a, b, dst, n) : binaryScalarSse2<Op>(a, b, dst, n);
+    }
+#endif
+    for(size_t i = 0; i < n; i++){
+        dst[i] = Op::apply(a[i], b);
+    }
+}
+
+//! Scaled Addition: y[i] = alpha * x[i] + y[i]
+template<typename T>
+void kernelAxpy(T alpha, const T* x, T* y, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        return kernelAvx2() ? axpyAvx2(alpha, x, y, n) : axpySse2(alpha, x, y, n);
+    }
+#endif
+    for(size_t i = 0; i < n; i++){
+        y[i] = alpha * x[i] + y[i];
+    }
+}
+
+//! Limit Every Element to the Interval [lo, hi]
+template<typename T>
+void kernelClamp(const T* src, T lo, T hi, T* dst, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        return kernelAvx2() ? clampAvx2(src, lo, hi, dst, n) : clampSse2(src, lo, hi, dst, n);
+    }
+#endif
+    for(size_t i = 0; i < n; i++){
+        dst[i] = src[i] < lo ? lo : (hi < src[i] ? hi : src[i]);
+    }
+}
+
+// LISTS ############################################################################
+
+//! Terminate if Two Lists Differ in Length
+template<typename T>
+void checkSameLength(const std::vector<T>* a, const std::vector<T>* b){
+    if(a->size() != b->size()){
+        std::cerr << "Error: lists <" << containerName(a) << "> and <" << containerName(b) << "> differ in length (" << a->size() << " and " << b->size() << ")." << std::endl;
+        exit(0);
+    }
+}
+
+//! dst = a op b for Two Lists of the Same Length
+template<typename Op, typename T>
+void listBinary(std::vector<T>* dst, const std::vector<T>* a, const std::vector<T>* b){
+    checkSameLength(a, b);
+    dst->resize(a->size());
+    kernelBinary<Op>(a->data(), b->data(), dst->data(), a->size());
+}
+
+//! dst = a op b for a List and a Value
+template<typename Op, typename T>
+void listBinaryScalar(std::vector<T>* dst, const std::vector<T>* a, T b){
+    dst->resize(a->size());
+    kernelBinaryScalar<Op>(a->data(), b, dst->data(), a->size());
+}
+
+//! y = alpha * x + y
+template<typename T>
+void listAxpy(std::vector<T>* y, T alpha, const std::vector<T>* x){
+    checkSameLength(y, x);
+    kernelAxpy(alpha, x->data(), y->data(), x->size());
+}
+
+//! dst = src Limited to [lo, hi]
+template<typename T>
+void listClamp(std::vector<T>* dst, const std::vector<T>* src, T lo, T hi){
+    dst->resize(src->size());
+    kernelClamp(src->data(), lo, hi, dst->data(), src->size());
+}
+
+// MATRICES (row by row in tiles, the padding of the rows stays zero) ###############
+
+//! Terminate if Two Matrices Differ in their Dimensions
+template<typename T>
+void checkSameDimensions(const Matrix<T>* a, const Matrix<T>* b){
+    if(a->rows != b->rows || a->cols != b->cols){
+        std::cerr << "Error: matrices <" << containerName(a) << "> and <" << containerName(b) << "> differ in their dimensions (" << a->rows << "x" << a->cols << " and " << b->rows << "x" << b->cols << ")." << std::endl;
+        exit(0);
+    }
+}
+
+//! Give dst the Dimensions of src
+template<typename T>
+void shapeLike(Matrix<T>* dst, const Matrix<T>* src){
+    if(dst->rows != src->rows || dst->cols != src->cols){
+        dst->resize(src->rows, src->cols);
+    }
+}
+
+//! dst = a op b for Two Matrices of the Same Dimensions
+template<typename Op, typename T>
+void matrixBinary(Matrix<T>* dst, const Matrix<T>* a, const Matrix<T>* b){
+    checkSameDimensions(a, b);
+    shapeLike(dst, a);
+    forRowTiles(a->rows, {dst, a, b}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            kernelBinary<Op>(a->row(i), b->row(i), dst->row(i), a->cols);
+        }
+    });
+}
+
+//! dst = a op b for a Matrix and a Value
+template<typename Op, typename T>
+void matrixBinaryScalar(Matrix<T>* dst, const Matrix<T>* a, T b){
+    shapeLike(dst, a);
+    forRowTiles(a->rows, {dst, a}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            kernelBinaryScalar<Op>(a->row(i), b, dst->row(i), a->cols);
+        }
+    });
+}
+
+//! y = alpha * x + y
+template<typename T>
+void matrixAxpy(Matrix<T>* y, T alpha, const Matrix<T>* x){
+    checkSameDimensions(y, x);
+    forRowTiles(x->rows, {y, x}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            kernelAxpy(alpha, x->row(i), y->row(i), x->cols);
+        }
+    });
+}
+
+//! dst = src Limited to [lo, hi]
+template<typename T>
+void matrixClamp(Matrix<T>* dst, const Matrix<T>* src, T lo, T hi){
+    shapeLike(dst, src);
+    forRowTiles(src->rows, {dst, src}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            kernelClamp(src->row(i), lo, hi, dst->row(i), src->cols);
+        }
+    });
+}
+
+// COPY, FILL AND VIEWS #############################################################
+
+//! dst = src for Lists (One Block Copy)
+template<typename T>
+void listCopy(std::vector<T>* dst, const std::vector<T>* src){
+    if(dst != src){
+        dst->assign(src->begin(), src->end());
+    }
+}
+
+//! Set all Entries of a List to a Value
+template<typename T>
+void listFill(std::vector<T>* list, T value){
+    std::fill(list->begin(), list->end(), value);
+}
+
+//! dst = src for Matrices, One Block Copy per Row (Views of the Same Matrix may Overlap)
+template<typename T>
+void matrixCopy(Matrix<T>* dst, const Matrix<T>* src){
+    if(dst == src){
+        return;
+    }
+    if(src->base == dst && (dst->rows != src->rows || dst->cols != src->cols)){
+        Matrix<T> copy; // the new dimensions free the entries the view shows
+        matrixCopy(&copy, src);
+        matrixCopy(dst, &copy);
+        return;
+    }
+    shapeLike(dst, src);
+    if(src->base != nullptr && src->base == dst->base && dst->data > src->data){
+        for(size_t i = src->rows; i-- > 0;){ // overlapping rows are copied before they are overwritten
+            std::memmove((void*)dst->row(i), src->row(i), src->cols * sizeof(T));
+        }
+        return;
+    }
+    forRowTiles(src->rows, {dst, src}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            std::memmove((void*)dst->row(i), src->row(i), src->cols * sizeof(T));
+        }
+    });
+}
+
+//! Move a Result Computed into a Temporary into dst (Copied if dst is a View or has Views, so they Keep Their Entries)
+template<typename T>
+void matrixAssign(Matrix<T>* dst, Matrix<T>* result){
+    if(dst->view || !dst->views.empty()){
+        matrixCopy(dst, result);
+    }else{
+        dst->swap(*result);
+    }
+}
+
+//! Set all Entries of a Matrix to a Value
+template<typename T>
+void matrixFill(Matrix<T>* matrix, T value){
+    forRowTiles(matrix->rows, {matrix}, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; i++){
+            std::fill(matrix->row(i), matrix->row(i) + matrix->cols, value);
+        }
+    });
+}
+
+//! Let a View Show rows x cols Entries of source Starting at Entry (i, j)
+template<typename T>
+void matrixView(Matrix<T>* view, Matrix<T>* source, int i, int j, int rows, int cols){
+    if(i < 0 || j < 0 || rows < 0 || cols < 0 || (size_t)i + rows > source->rows || (size_t)j + cols > source->cols){
+        std::cerr << "Error: block of " << rows << "x" << cols << " entries at <" << i << "," << j << "> lies outside of matrix <" << containerName(source) << "> (" << source->rows << "x" << source->cols << ")." << std::endl;
+        exit(0);
+    }
+    view->show(*source, i, j, rows, cols);
+}
+
+#endif //SQBRA_KERNELS_H
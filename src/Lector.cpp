@@ -6,6 +6,7 @@
  */
 
 #include "Lexer.h"
+#include "TypedArray.h"
 
 bool error;
 
@@ -56,6 +57,15 @@ inline void checkFlowSyntax(std::vector<std::string> line, int lcount){
             std::cout << "False autoloop statement: line <" << lcount << "> - correct usage: autoloop <var> <initvar> do [" << std::endl;
             error = true;
         }
+    }else if(line[0] == "ploop"){
+        bool correct = line.size() >= 5 && line.size() % 2 == 1 && line[line.size()-2] == "do" && line[line.size()-1] == "[";
+        for(int i = 3; correct && i < line.size() - 2; i += 2){
+            correct = line[i] == "sum" || line[i] == "min" || line[i] == "max";
+        }
+        if(!correct){
+            std::cout << "False ploop statement: line <" << lcount << "> - correct usage: ploop <var> <initvar> [sum|min|max <var>] ... do [" << std::endl;
+            error = true;
+        }
     }else if(line[0] == "while"){
         if(line[line.size()-1] != "[" || (line.size() != 4 && line.size() != 3)){
             std::cout << "False while statement: line <" << lcount << "> - correct usage: while (statement) (do) [" << std::endl;
@@ -76,14 +86,15 @@ inline void checkFlowSyntax(std::vector<std::string> line, int lcount){
 
 //! Check Syntax of Commands that declare Variables
 inline void checkVarSyntax(std::vector<std::string> line, int lcount){
+    ElementType element;
     if(line[0] == "cvar" && line.size() != 3){
         std::cout << "False declaration of variable: line <" << lcount << "> - correct usage: cvar <var> <value>" << std::endl;
         error = true;
-    }else if(line[0] == "clist" && line.size() != 3) {
-        std::cout << "False declaration of list: line <" << lcount << "> - correct usage: clist <name> <length>" << std::endl;
+    }else if(line[0] == "clist" && ((line.size() != 3 && line.size() != 4) || (line.size() == 4 && !elementType(line[3], element)))) {
+        std::cout << "False declaration of list: line <" << lcount << "> - correct usage: clist <name> <length> (i32|i64|f32|f64)" << std::endl;
         error = true;
-    }else if(line[0] == "cmat" && line.size() != 4){
-        std::cout << "False declaration of matrix: line <" << lcount << "> - correct usage: cmat <name> <dim1> <dim2>" << std::endl;
+    }else if(line[0] == "cmat" && ((line.size() != 4 && line.size() != 5) || (line.size() == 5 && !elementType(line[4], element)))){
+        std::cout << "False declaration of matrix: line <" << lcount << "> - correct usage: cmat <name> <dim1> <dim2> (i32|i64|f32|f64)" << std::endl;
         error = true;
     }else if(line[0] == "getl" && line.size() != 3){
         std::cout << "False 'getl' command: line <" << lcount << "> - correct usage: getl <var> <list>" << std::endl;
@@ -168,6 +179,9 @@ inline void checkFunctionSyntax(std::vector<std::string> line, int lcount){
     }else if(line[0] == "call" && line.size() != 2) {
         std::cout << "False call of function: line <" << lcount << "> - correct usage: call <function_name>" << std::endl;
         error = true;
+    }else if(line[0] == "spawn" && line.size() != 2) {
+        std::cout << "False spawn of function: line <" << lcount << "> - correct usage: spawn <function_name>" << std::endl;
+        error = true;
     }
 }
 
@@ -187,6 +201,238 @@ inline void checkRANDOMSyntax(const std::vector<std::string>& line, int lcount){
     }
 }
 
+//! Check Syntax of Elementwise Commands on Whole Lists and Matrices
+inline void checkElementwiseSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    if(token == "laxpy" || token == "maxpy"){
+        if(line.size() != 4){
+            std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <factor> <source>" << std::endl;
+            error = true;
+        }
+    }else if(token == "lclamp" || token == "mclamp"){
+        if(line.size() != 5){
+            std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <source> <min> <max>" << std::endl;
+            error = true;
+        }
+    }else if(token == "lcmp" || token == "mcmp"){
+        if(line.size() != 5){
+            std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <source> <operator> <source or value>" << std::endl;
+            error = true;
+        }else if(line[3] != "=" && line[3] != "==" && line[3] != "!=" && line[3] != "<" && line[3] != "<=" && line[3] != ">" && line[3] != ">="){
+            std::cout << "False operator: line <" << lcount << "> - " << token << " compares with =, !=, <, <=, > or >=" << std::endl;
+            error = true;
+        }
+    }else if(line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <source> <source or value>" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of Functions Applied to Whole Lists and Matrices
+inline void checkVectorMathSyntax(const std::vector<std::string>& line, int lcount){
+    if((line[0] == "vlog" || line[0] == "vxroot") && line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << line[0] << " <target> <source> <" << (line[0] == "vlog" ? "base" : "root") << ">" << std::endl;
+        error = true;
+    }else if(line[0] != "vlog" && line[0] != "vxroot" && line.size() != 3){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << line[0] << " <target> <source>" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Matrix Multiplication
+inline void checkMatmulSyntax(const std::vector<std::string>& line, int lcount){
+    if((line.size() != 4 && line.size() != 5) || (line.size() == 5 && line[4] != "nn" && line[4] != "tn" && line[4] != "nt" && line[4] != "tt")){
+        std::cout << "False usage: <" << lcount << "> - correct usage: matmul <target> <matrix> <matrix> [nn|tn|nt|tt]" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Linear Algebra Commands on Matrices
+inline void checkLinalgSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    if((token == "msolve" || token == "mlu") && line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << (token == "msolve" ? "msolve <target> <matrix> <source>" : "mlu <target> <list> <matrix>") << std::endl;
+        error = true;
+    }else if(token != "msolve" && token != "mlu" && line.size() != 3){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <matrix>" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Fourier Transform and the Convolution of Lists
+inline void checkSpectralSyntax(const std::vector<std::string>& line, int lcount){
+    if(line[0] == "lconv" && line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: lconv <target> <list> <list>" << std::endl;
+        error = true;
+    }else if(line[0] != "lconv" && line.size() != 3){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << line[0] << " <real part> <imaginary part>" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Stencil
+inline void checkStencilSyntax(const std::vector<std::string>& line, int lcount){
+    if((line.size() != 4 && line.size() != 5) || (line.size() == 5 && line[4] != "zero" && line[4] != "wrap" && line[4] != "clamp")){
+        std::cout << "False usage: <" << lcount << "> - correct usage: stencil <target> <matrix> <kernel> [zero|wrap|clamp]" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Reductions and Prefix Sums (Options: rows or cols, exclusive for lscan, kahan for sums)
+inline void checkReductionSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    size_t operands = token == "ldot" ? 4 : 3;
+    bool sums = token == "lsum" || token == "lmean" || token == "lvar" || token == "ldot" || token == "lscan";
+    bool valid = line.size() >= operands;
+    bool axis = false, exclusive = false, kahan = false;
+    for(size_t i = operands; valid && i < line.size(); i++){
+        if((line[i] == "rows" || line[i] == "cols") && !axis){
+            axis = true;
+        }else if(line[i] == "exclusive" && token == "lscan" && !exclusive){
+            exclusive = true;
+        }else if(line[i] == "kahan" && sums && !kahan){
+            kahan = true;
+        }else{
+            valid = false;
+        }
+    }
+    if(!valid){
+        std::string options = std::string(" [rows|cols]") + (token == "lscan" ? " [exclusive]" : "") + (sums ? " [kahan]" : "");
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << token << (token == "ldot" ? " <target> <source> <source>" : " <target> <source>") << options << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of Sorting, Binary Search and Set Operations
+inline void checkSortSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    if(token == "lsort" || token == "lsortidx"){
+        if((line.size() != 3 && line.size() != 4) || (line.size() == 4 && line[3] != "asc" && line[3] != "desc")){
+            std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <list> [asc|desc]" << std::endl;
+            error = true;
+        }
+    }else if(token == "lbsearch" && line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: lbsearch <target> <sorted list> <value>" << std::endl;
+        error = true;
+    }else if(token == "lunique" && line.size() != 3){
+        std::cout << "False usage: <" << lcount << "> - correct usage: lunique <target> <list>" << std::endl;
+        error = true;
+    }else if((token == "lunion" || token == "lintersect") && line.size() != 4){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << token << " <target> <list> <list>" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Dictionary Commands
+inline void checkDictSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    std::string usage;
+    if(token == "cdict" && line.size() != 2){
+        usage = "cdict <name>";
+    }else if(token == "dset" && line.size() != 4){
+        usage = "dset <dictionary> <key> <value>";
+    }else if(token == "ddel" && line.size() != 3){
+        usage = "ddel <dictionary> <key>";
+    }else if(token == "dget" && line.size() != 4 && line.size() != 5){
+        usage = "dget <target> <dictionary> <key> [default]";
+    }else if(token == "dhas" && line.size() != 4){
+        usage = "dhas <target> <dictionary> <key>";
+    }else if(token == "dlen" && line.size() != 3){
+        usage = "dlen <target> <dictionary>";
+    }
+    if(!usage.empty()){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << usage << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Bit Matrix Commands (the Neighbour Counts of bmneigh are Digits From 0 to 8)
+inline void checkBitMatrixSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    std::string usage;
+    if(token == "cbmat" && line.size() != 4){
+        usage = "cbmat <name> <rows> <cols>";
+    }else if((token == "bmand" || token == "bmor" || token == "bmxor") && line.size() != 4){
+        usage = token + " <target> <bit matrix> <bit matrix>";
+    }else if(token == "bmnot" && line.size() != 3){
+        usage = "bmnot <target> <bit matrix>";
+    }else if(token == "bmcount" && line.size() != 3){
+        usage = "bmcount <target> <bit matrix>";
+    }else if(token == "bmneigh" && (line.size() != 4 || line[3].find_first_not_of("012345678") != std::string::npos)){
+        usage = "bmneigh <target> <bit matrix> <neighbour counts, for example 23>";
+    }
+    if(!usage.empty()){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << usage << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Sparse Matrix Commands
+inline void checkSparseSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    std::string usage;
+    if(token == "csparse" && line.size() != 4 && line.size() != 7){
+        usage = "csparse <name> <rows> <cols> (<row list> <column list> <value list>)";
+    }else if(token == "spmv" && line.size() != 4){
+        usage = "spmv <target list> <sparse matrix> <list>";
+    }
+    if(!usage.empty()){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << usage << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Commands that Swap, Copy, Fill and Show Whole Lists and Matrices
+inline void checkCopySyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    std::string usage;
+    if((token == "lswap" || token == "lcopy") && line.size() != 3){
+        usage = token + (token == "lswap" ? " <list> <list>" : " <target list> <list>");
+    }else if((token == "mswap" || token == "mcopy") && line.size() != 3){
+        usage = token + (token == "mswap" ? " <matrix> <matrix>" : " <target matrix> <matrix>");
+    }else if(token == "lfill" && line.size() != 3){
+        usage = "lfill <list> <value>";
+    }else if(token == "mfill" && line.size() != 3){
+        usage = "mfill <matrix> <value>";
+    }else if(token == "mview" && line.size() != 7){
+        usage = "mview <name> <matrix> <first row> <first column> <rows> <columns>";
+    }
+    if(!usage.empty()){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << usage << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Declaration of File-Backed Matrices
+inline void checkMappedSyntax(const std::vector<std::string>& line, int lcount){
+    if(line.size() != 5){
+        std::cout << "False usage: <" << lcount << "> - correct usage: mmat <name> [\"path/to-your/file\"] <rows> <columns>" << std::endl;
+        error = true;
+    }else if(line[2].size() < 4 || line[2].compare(0, 2, "[\"") != 0 || line[2].compare(line[2].size() - 2, 2, "\"]") != 0){
+        std::cout << "False string: line <" << lcount << "> - string needs to be enclosed [\"hello\"]" << std::endl;
+        error = true;
+    }
+}
+
+//! Check Syntax of the Heap Commands
+inline void checkHeapSyntax(const std::vector<std::string>& line, int lcount){
+    const std::string& token = line[0];
+    std::string usage;
+    if(token == "cheap" && line.size() != 2){
+        usage = "cheap <name>";
+    }else if(token == "hpush" && line.size() != 4){
+        usage = "hpush <value> <priority> <heap>";
+    }else if((token == "hpop" || token == "hpeek") && line.size() != 3 && line.size() != 4){
+        usage = token + " <target> <heap> [priority target]";
+    }else if(token == "hlen" && line.size() != 3){
+        usage = "hlen <target> <heap>";
+    }
+    if(!usage.empty()){
+        std::cout << "False usage: <" << lcount << "> - correct usage: " << usage << std::endl;
+        error = true;
+    }
+}
+
 //! Check Syntax of all Tokens
 void checkSyntax(std::vector<std::vector<std::string> > &tokens, bool pl){
     int lcount = 1;
@@ -198,7 +444,7 @@ void checkSyntax(std::vector<std::vector<std::string> > &tokens, bool pl){
         std::string token = line[0];
         if(token == "print" || token == "printb" || token == "printv" || token == "printm" || token == "input"){
             checkPrintSyntax(line, lcount);
-        }else if(token == "loop" || token == "sloop" || token == "autoloop" || token == "while" || token == "if" || token == "elif" || token == "else"){
+        }else if(token == "loop" || token == "sloop" || token == "autoloop" || token == "ploop" || token == "while" || token == "if" || token == "elif" || token == "else"){
             checkFlowSyntax(line, lcount);
         }else if(token == "cvar" || token == "mvar"  || token == "cmat" || token == "clist" || token == "set" || token == "getl" || token == "getdim"){
             checkVarSyntax(line, lcount);
@@ -208,7 +454,7 @@ void checkSyntax(std::vector<std::vector<std::string> > &tokens, bool pl){
             checkTrigSyntax(line, lcount);
         }else if(token == "log"){
             checkLogSyntax(line, lcount);
-        }else if(token == "exit" || token == "leave" || token == "newl"){
+        }else if(token == "exit" || token == "leave" || token == "newl" || token == "join"){
             checkSingleSyntax(line, lcount);
         }else if(token == "sleep"){
             checkSleepSyntax(line, lcount);
@@ -216,10 +462,39 @@ void checkSyntax(std::vector<std::vector<std::string> > &tokens, bool pl){
             checkXROOTSyntax(line, lcount);
         }else if(token == "random") {
             checkRANDOMSyntax(line, lcount);
-        }else if(token == "funct" || token == "call") {
+        }else if(token == "funct" || token == "call" || token == "spawn") {
             checkFunctionSyntax(line, lcount);
         }else if(token == "pop" || token == "push" || token == "chsl" || token == "ldef" || token == "mdef" || token == "writef" || token == "readf") {
             checkListFunctionsSyntax(line, lcount);
+        }else if(token == "ladd" || token == "lsub" || token == "lmul" || token == "ldiv" || token == "laxpy" || token == "lclamp" || token == "lcmp"
+              || token == "madd" || token == "msub" || token == "mmul" || token == "mdiv" || token == "maxpy" || token == "mclamp" || token == "mcmp") {
+            checkElementwiseSyntax(line, lcount);
+        }else if(token == "vsin" || token == "vcos" || token == "vtan" || token == "vexp" || token == "vlog" || token == "vxroot") {
+            checkVectorMathSyntax(line, lcount);
+        }else if(token == "matmul") {
+            checkMatmulSyntax(line, lcount);
+        }else if(token == "msolve" || token == "mdet" || token == "minv" || token == "mtrans" || token == "mlu") {
+            checkLinalgSyntax(line, lcount);
+        }else if(token == "fft" || token == "ifft" || token == "lconv") {
+            checkSpectralSyntax(line, lcount);
+        }else if(token == "lsum" || token == "lmin" || token == "lmax" || token == "largmax" || token == "lmean" || token == "lvar" || token == "ldot" || token == "lscan") {
+            checkReductionSyntax(line, lcount);
+        }else if(token == "lsort" || token == "lsortidx" || token == "lbsearch" || token == "lunique" || token == "lunion" || token == "lintersect") {
+            checkSortSyntax(line, lcount);
+        }else if(token == "cdict" || token == "dset" || token == "ddel" || token == "dget" || token == "dhas" || token == "dlen") {
+            checkDictSyntax(line, lcount);
+        }else if(token == "cheap" || token == "hpush" || token == "hpop" || token == "hpeek" || token == "hlen") {
+            checkHeapSyntax(line, lcount);
+        }else if(token == "cbmat" || token == "bmand" || token == "bmor" || token == "bmxor" || token == "bmnot" || token == "bmcount" || token == "bmneigh") {
+            checkBitMatrixSyntax(line, lcount);
+        }else if(token == "csparse" || token == "spmv") {
+            checkSparseSyntax(line, lcount);
+        }else if(token == "mmat") {
+            checkMappedSyntax(line, lcount);
+        }else if(token == "lswap" || token == "mswap" || token == "lcopy" || token == "mcopy" || token == "lfill" || token == "mfill" || token == "mview") {
+            checkCopySyntax(line, lcount);
+        }else if(token == "stencil") {
+            checkStencilSyntax(line, lcount);
         }else if(token == "]") {
             if (line.size() > 1) {
                 std::cout << "Syntax error: line <" << lcount << "> - ']' must always be the only statement in a line" << std::endl;
@@ -114,6 +114,13 @@ void fix_print_syntax(std::vector<std::string> *print_strings) {
     }
 } // fix print syntax
 
+bool startsWithKeyword(const std::string& token, const std::string& keyword) {
+    if(token.compare(0, keyword.size(), keyword) != 0){
+        return false;
+    }
+    return token.size() == keyword.size() || token[keyword.size()] == '(' || token[keyword.size()] == '[';
+} // keyword alone or directly followed by its condition or block (commands like ifft only contain a keyword)
+
 void repairTokens(std::vector<std::vector<std::string> > *strings) {
     int tokenIndex = 0;
     for (auto &vec : *strings) {
@@ -128,17 +135,17 @@ void repairTokens(std::vector<std::vector<std::string> > *strings) {
                 }
             }
         }
-        if(vec[0].find("printb") != std::string::npos){
+        if(startsWithKeyword(vec[0], "printb")){
             fix_printb_syntax(&vec);
-        }else if(vec[0].find("print") != std::string::npos && vec[0].find("printv") == std::string::npos && vec[0].find("printm") == std::string::npos){
+        }else if(startsWithKeyword(vec[0], "print")){
             fix_print_syntax(&vec);
-        }else if(vec[0].find("elif") != std::string::npos){
+        }else if(startsWithKeyword(vec[0], "elif")){
             fix_elif_syntax(&vec);
-        }else if(vec[0].find("else") != std::string::npos){
+        }else if(startsWithKeyword(vec[0], "else")){
             fix_else_syntax(&vec);
-        }else if(vec[0].find("if") != std::string::npos){
+        }else if(startsWithKeyword(vec[0], "if")){
             fix_if_syntax(&vec);
-        }else if(vec[0].find("while") != std::string::npos){
+        }else if(startsWithKeyword(vec[0], "while")){
             fix_while_syntax(&vec);
         }
     }// turn all alpha chars to lowercase
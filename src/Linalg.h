@@ -0,0 +1,487 @@
+#pragma once
+#ifndef SQBRA_LINALG_H
+#define SQBRA_LINALG_H
+
+/*
+ *  LINALG.H
+ *  This file contains the linear algebra kernels for matrices (multiplication, transpose, LU decomposition, solve,
+ *  inverse and determinant).
+ *  The multiplication packs blocks of both operands into contiguous panels that fit into the caches and multiplies
+ *  them with a register-blocked micro kernel (AVX2 and FMA for double if the processor supports them). The blocked
+ *  LU decomposition and the triangular solves spend most of their time in this multiplication.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <cmath>
+#include <functional>
+
+#include "Kernels.h"
+
+#ifdef SQBRA_SIMD
+#define SQBRA_FMA __attribute__((target("avx2,fma")))
+#endif
+
+// BLOCK SIZES ######################################################################
+
+const size_t GEMM_MC = 192;  // rows of the packed block of A (stays in the L2 cache)
+const size_t GEMM_KC = 256;  // depth of the packed blocks (a panel of A and B stays in the L1 cache)
+const size_t GEMM_NC = 2048; // columns of the packed block of B (stays in the L3 cache)
+
+// size of the block of C that the micro kernel keeps in registers
+template<typename T> struct GemmTile { static const size_t MR = 4; static const size_t NR = 4; };
+template<> struct GemmTile<double> { static const size_t MR = 6; static const size_t NR = 8; };
+
+//! Runs task(0) ... task(n - 1) one after another (the interpreter passes a runner that uses its threads)
+struct SerialRunner {
+    void operator()(size_t n, const std::function<void(size_t)>& task) const {
+        for(size_t i = 0; i < n; i++){
+            task(i);
+        }
+    }
+};
+
+// PACKING ##########################################################################
+
+//! Pack sign * op(A)[i0 : i0 + mc, p0 : p0 + kc] into Panels of MR Rows (Missing Rows are Zero); A has Row Stride lda
+template<typename T>
+void gemmPackA(const T* a, size_t lda, bool trans, T sign, size_t i0, size_t mc, size_t p0, size_t kc, T* dst){
+    const size_t MR = GemmTile<T>::MR;
+    for(size_t panel = 0; panel < mc; panel += MR){
+        for(size_t r = 0; r < MR; r++){
+            T* out = dst + panel * kc + r;
+            if(panel + r >= mc){
+                for(size_t p = 0; p < kc; p++){ out[p * MR] = 0; }
+            }else if(trans){
+                for(size_t p = 0; p < kc; p++){ out[p * MR] = sign * a[(p0 + p) * lda + i0 + panel + r]; }
+            }else{
+                const T* row = a + (i0 + panel + r) * lda + p0;
+                for(size_t p = 0; p < kc; p++){ out[p * MR] = sign * row[p]; }
+            }
+        }
+    }
+}
+
+//! Pack op(B)[p0 : p0 + kc, j0 + first * NR : j0 + last * NR] into Panels of NR Columns (Missing Columns are Zero)
+template<typename T>
+void gemmPackB(const T* b, size_t ldb, bool trans, size_t p0, size_t kc, size_t j0, size_t nc, size_t first, size_t last, T* dst){
+    const size_t NR = GemmTile<T>::NR;
+    for(size_t panel = first; panel < last; panel++){
+        T* out = dst + panel * NR * kc;
+        size_t j = panel * NR;
+        size_t width = std::min(NR, nc - j);
+        for(size_t p = 0; p < kc; p++){
+            if(trans){
+                for(size_t c = 0; c < width; c++){ out[p * NR + c] = b[(j0 + j + c) * ldb + p0 + p]; }
+            }else{
+                const T* row = b + (p0 + p) * ldb + j0 + j;
+                for(size_t c = 0; c < width; c++){ out[p * NR + c] = row[c]; }
+            }
+            for(size_t c = width; c < NR; c++){ out[p * NR + c] = 0; }
+        }
+    }
+}
+
+// MICRO KERNELS (C[0 : m, 0 : n] += packed panel of A * packed panel of B) #########
+
+template<typename T>
+void gemmMicroScalar(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t m, size_t n){
+    const size_t MR = GemmTile<T>::MR;
+    const size_t NR = GemmTile<T>::NR;
+    T acc[MR][NR] = {};
+    for(size_t p = 0; p < kc; p++){
+        for(size_t i = 0; i < MR; i++){
+            for(size_t j = 0; j < NR; j++){
+                acc[i][j] += a[p * MR + i] * b[p * NR + j];
+            }
+        }
+    }
+    for(size_t i = 0; i < m; i++){
+        for(size_t j = 0; j < n; j++){
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+#ifdef SQBRA_SIMD
+//! Check Once Whether the Processor Supports AVX2 and FMA
+inline bool kernelFma(){
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+
+//! 6x8 Block of C in 12 Registers
+SQBRA_FMA inline void gemmMicroFma(size_t kc, const double* a, const double* b, double* c, size_t ldc, size_t m, size_t n){
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(), c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd(), c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd(), c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for(size_t p = 0; p < kc; p++){
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+        __m256d ai = _mm256_broadcast_sd(a);
+        c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+        a += 6;
+        b += 8;
+    }
+    __m256d acc[6][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+    if(m == 6 && n == 8){
+        for(size_t i = 0; i < 6; i++){
+            _mm256_storeu_pd(c + i * ldc, _mm256_add_pd(_mm256_loadu_pd(c + i * ldc), acc[i][0]));
+            _mm256_storeu_pd(c + i * ldc + 4, _mm256_add_pd(_mm256_loadu_pd(c + i * ldc + 4), acc[i][1]));
+        }
+        return;
+    }
+    double tile[6][8];
+    for(size_t i = 0; i < 6; i++){
+        _mm256_storeu_pd(tile[i], acc[i][0]);
+        _mm256_storeu_pd(tile[i] + 4, acc[i][1]);
+    }
+    for(size_t i = 0; i < m; i++){
+        for(size_t j = 0; j < n; j++){
+            c[i * ldc + j] += tile[i][j];
+        }
+    }
+}
+#endif
+
+template<typename T>
+inline void gemmMicro(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t m, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        if(kernelFma()){
+            return gemmMicroFma(kc, a, b, c, ldc, m, n);
+        }
+    }
+#endif
+    gemmMicroScalar(kc, a, b, c, ldc, m, n);
+}
+
+// MATRIX MULTIPLICATION ############################################################
+
+//! Number of Rows of op(M)
+template<typename T>
+inline size_t gemmRows(const Matrix<T>* m, bool trans){ return trans ? m->cols : m->rows; }
+
+//! Number of Columns of op(M)
+template<typename T>
+inline size_t gemmCols(const Matrix<T>* m, bool trans){ return trans ? m->rows : m->cols; }
+
+//! C[0 : m, 0 : n] += sign * op(A) * op(B) for Blocks of Row-Major Storage (C must not Overlap A or B)
+template<typename T, typename Runner>
+void gemmAccumulate(size_t m, size_t n, size_t k, T sign, const T* a, size_t lda, bool transA, const T* b, size_t ldb, bool transB,
+                    T* c, size_t ldc, size_t threads, const Runner& run){
+    const size_t MR = GemmTile<T>::MR;
+    const size_t NR = GemmTile<T>::NR;
+    if(m == 0 || n == 0){
+        return;
+    }
+    static thread_local std::vector<T> packedB;
+    for(size_t jc = 0; jc < n; jc += GEMM_NC){
+        size_t nc = std::min(GEMM_NC, n - jc);
+        size_t panels = (nc + NR - 1) / NR;
+        for(size_t pc = 0; pc < k; pc += GEMM_KC){
+            size_t kc = std::min(GEMM_KC, k - pc);
+            packedB.resize(panels * NR * kc);
+            T* bp = packedB.data();
+
+            // if there are fewer row blocks than threads, the columns are split as well
+            size_t blocks = (m + GEMM_MC - 1) / GEMM_MC;
+            size_t parts = std::min(panels, std::max<size_t>(1, (2 * threads + blocks - 1) / blocks));
+            size_t perPart = (panels + parts - 1) / parts;
+            run(parts, [&](size_t part){
+                gemmPackB(b, ldb, transB, pc, kc, jc, nc, part * perPart, std::min(panels, (part + 1) * perPart), bp);
+            });
+            run(blocks * parts, [&](size_t task){
+                static thread_local std::vector<T> packedA;
+                size_t ic = task / parts * GEMM_MC;
+                size_t mc = std::min(GEMM_MC, m - ic);
+                size_t first = task % parts * perPart;
+                size_t last = std::min(panels, first + perPart);
+                packedA.resize((mc + MR - 1) / MR * MR * kc);
+                gemmPackA(a, lda, transA, sign, ic, mc, pc, kc, packedA.data());
+                for(size_t jr = first; jr < last; jr++){
+                    size_t j = jr * NR;
+                    for(size_t ir = 0; ir < mc; ir += MR){
+                        gemmMicro(kc, packedA.data() + ir * kc, bp + jr * NR * kc, c + (ic + ir) * ldc + jc + j, ldc, std::min(MR, mc - ir), std::min(NR, nc - j));
+                    }
+                }
+            });
+        }
+    }
+}
+
+//! C = op(A) * op(B) where op Transposes its Matrix if trans is Set; run Distributes Independent Tasks over Threads
+template<typename T, typename Runner>
+void matrixMultiply(Matrix<T>* c, const Matrix<T>* a, const Matrix<T>* b, bool transA, bool transB, size_t threads, const Runner& run){
+    size_t m = gemmRows(a, transA);
+    size_t k = gemmCols(a, transA);
+    size_t n = gemmCols(b, transB);
+    if(k != gemmRows(b, transB)){
+        std::cerr << "Error: matrices <" << containerName(a) << "> and <" << containerName(b) << "> cannot be multiplied (" << m << "x" << k << " and " << gemmRows(b, transB) << "x" << n << ")." << std::endl;
+        exit(0);
+    }
+    if(c->overlaps(*a) || c->overlaps(*b)){
+        Matrix<T> result;
+        matrixMultiply(&result, a, b, transA, transB, threads, run);
+        matrixAssign(c, &result);
+        return;
+    }
+    if(c->rows != m || c->cols != n){
+        c->resize(m, n);
+    }
+    for(size_t i = 0; i < m; i++){
+        std::fill(c->row(i), c->row(i) + n, T(0));
+    }
+    gemmAccumulate(m, n, k, T(1), a->data, a->stride, transA, b->data, b->stride, transB, c->data, c->stride, threads, run);
+}
+
+// TRANSPOSE ########################################################################
+
+const size_t TRANSPOSE_BLOCK = 32; // blocks of at most this size are transposed directly (both fit into the L1 cache)
+
+//! dst[j][i] = src[i][j] for a rows x cols Block; Halves the Longer Side until the Blocks Fit into the Cache
+template<typename T>
+void transposeBlock(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols){
+    if(rows <= TRANSPOSE_BLOCK && cols <= TRANSPOSE_BLOCK){
+        for(size_t i = 0; i < rows; i++){
+            for(size_t j = 0; j < cols; j++){
+                dst[j * ldd + i] = src[i * lds + j];
+            }
+        }
+    }else if(rows >= cols){
+        size_t half = rows / 2;
+        transposeBlock(src, lds, dst, ldd, half, cols);
+        transposeBlock(src + half * lds, lds, dst + half, ldd, rows - half, cols);
+    }else{
+        size_t half = cols / 2;
+        transposeBlock(src, lds, dst, ldd, rows, half);
+        transposeBlock(src + half, lds, dst + half * ldd, ldd, rows, cols - half);
+    }
+}
+
+//! target = Transpose of source (target may be source or share entries with it)
+template<typename T>
+void matrixTranspose(Matrix<T>* target, const Matrix<T>* source){
+    if(target->overlaps(*source)){
+        Matrix<T> result;
+        matrixTranspose(&result, source);
+        matrixAssign(target, &result);
+        return;
+    }
+    if(target->rows != source->cols || target->cols != source->rows){
+        target->resize(source->cols, source->rows);
+    }
+    transposeBlock(source->data, source->stride, target->data, target->stride, source->rows, source->cols);
+}
+
+// LU DECOMPOSITION #################################################################
+
+const size_t LU_BLOCK = 64; // width of the panels of the LU decomposition and the triangular solves
+
+//! Terminate if a Matrix is not Square
+template<typename T>
+void checkSquare(const Matrix<T>* a){
+    if(a->rows != a->cols){
+        std::cerr << "Error: matrix <" << containerName(a) << "> is not square (" << a->rows << "x" << a->cols << ")." << std::endl;
+        exit(0);
+    }
+}
+
+/*
+ *  Factorize the square matrix lu in place into P * A = L * U with partial pivoting: afterwards lu holds L below the
+ *  diagonal (its diagonal is 1) and U on and above it, and row i of L * U is row perm[i] of A. Returns the number of
+ *  row exchanges. A column without a nonzero pivot is skipped, so a singular matrix gives a zero on the diagonal of U.
+ *  The matrix is processed in panels of LU_BLOCK columns: each panel is factorized row by row, then the rows of U
+ *  right of it are solved and the rest of the matrix is updated with one matrix multiplication.
+ */
+template<typename T, typename Runner>
+size_t luDecompose(Matrix<T>* lu, std::vector<size_t>& perm, size_t threads, const Runner& run){
+    size_t n = lu->rows;
+    size_t swaps = 0;
+    perm.resize(n);
+    for(size_t i = 0; i < n; i++){
+        perm[i] = i;
+    }
+    for(size_t j0 = 0; j0 < n; j0 += LU_BLOCK){
+        size_t end = std::min(n, j0 + LU_BLOCK);
+        for(size_t j = j0; j < end; j++){
+            size_t pivot = j;
+            for(size_t i = j + 1; i < n; i++){
+                if(std::abs(lu->at(i, j)) > std::abs(lu->at(pivot, j))){
+                    pivot = i;
+                }
+            }
+            if(pivot != j){
+                std::swap_ranges(lu->row(j), lu->row(j) + n, lu->row(pivot));
+                std::swap(perm[j], perm[pivot]);
+                swaps++;
+            }
+            T diagonal = lu->at(j, j);
+            if(diagonal == 0){
+                continue;
+            }
+            for(size_t i = j + 1; i < n; i++){
+                T factor = lu->at(i, j) /= diagonal;
+                if(factor != 0){
+                    kernelAxpy(-factor, lu->row(j) + j + 1, lu->row(i) + j + 1, end - j - 1);
+                }
+            }
+        }
+        if(end == n){
+            break;
+        }
+        for(size_t i = j0 + 1; i < end; i++){
+            for(size_t r = j0; r < i; r++){
+                kernelAxpy(-lu->at(i, r), lu->row(r) + end, lu->row(i) + end, n - end);
+            }
+        }
+        gemmAccumulate(n - end, n - end, end - j0, T(-1), lu->row(end) + j0, lu->stride, false, lu->row(j0) + end, lu->stride, false,
+                       lu->row(end) + end, lu->stride, threads, run);
+    }
+    return swaps;
+}
+
+//! Index of the First Zero on the Diagonal of U (n if there is None)
+template<typename T>
+size_t luSingularColumn(const Matrix<T>* lu){
+    for(size_t i = 0; i < lu->rows; i++){
+        if(lu->row(i)[i] == 0){
+            return i;
+        }
+    }
+    return lu->rows;
+}
+
+//! Solve L * U * X = X in Place for the n x r Matrix X (L and U as Computed by luDecompose)
+template<typename T, typename Runner>
+void luSolveInPlace(const Matrix<T>* lu, Matrix<T>* x, size_t threads, const Runner& run){
+    size_t n = lu->rows;
+    size_t r = x->cols;
+    for(size_t i0 = 0; i0 < n; i0 += LU_BLOCK){
+        size_t end = std::min(n, i0 + LU_BLOCK);
+        gemmAccumulate(end - i0, r, i0, T(-1), lu->row(i0), lu->stride, false, x->data, x->stride, false, x->row(i0), x->stride, threads, run);
+        for(size_t i = i0 + 1; i < end; i++){
+            for(size_t q = i0; q < i; q++){
+                kernelAxpy(-lu->row(i)[q], x->row(q), x->row(i), r);
+            }
+        }
+    }
+    for(size_t end = n; end > 0;){
+        size_t i0 = (end - 1) / LU_BLOCK * LU_BLOCK;
+        gemmAccumulate(end - i0, r, n - end, T(-1), lu->row(i0) + end, lu->stride, false, x->row(end), x->stride, false, x->row(i0), x->stride, threads, run);
+        for(size_t i = end; i-- > i0;){
+            for(size_t q = i + 1; q < end; q++){
+                kernelAxpy(-lu->row(i)[q], x->row(q), x->row(i), r);
+            }
+            T inverse = T(1) / lu->row(i)[i];
+            for(size_t c = 0; c < r; c++){
+                x->row(i)[c] *= inverse;
+            }
+        }
+        end = i0;
+    }
+}
+
+//! Factorize a Copy of a and Terminate if a is Singular
+template<typename T, typename Runner>
+void luFactorRegular(Matrix<T>* lu, std::vector<size_t>& perm, const Matrix<T>* a, size_t threads, const Runner& run){
+    checkSquare(a);
+    matrixCopy(lu, a);
+    luDecompose(lu, perm, threads, run);
+    if(luSingularColumn(lu) < lu->rows){
+        std::cerr << "Error: matrix <" << containerName(a) << "> is singular (no pivot in column " << luSingularColumn(lu) << ")." << std::endl;
+        exit(0);
+    }
+}
+
+//! lu and perm = LU Decomposition of a with Partial Pivoting (perm[i] is the Row of a that Became Row i)
+template<typename T, typename Runner>
+void matrixLU(Matrix<T>* lu, std::vector<T>* perm, const Matrix<T>* a, size_t threads, const Runner& run){
+    checkSquare(a);
+    std::vector<size_t> rows;
+    matrixCopy(lu, a);
+    luDecompose(lu, rows, threads, run);
+    perm->assign(rows.begin(), rows.end());
+}
+
+//! Determinant of a (the Product of the Diagonal of U, Negated for an Odd Number of Row Exchanges)
+template<typename T, typename Runner>
+T matrixDeterminant(const Matrix<T>* a, size_t threads, const Runner& run){
+    checkSquare(a);
+    Matrix<T> lu;
+    std::vector<size_t> perm;
+    matrixCopy(&lu, a);
+    T determinant = luDecompose(&lu, perm, threads, run) % 2 == 0 ? T(1) : T(-1);
+    for(size_t i = 0; i < lu.rows; i++){
+        determinant *= lu.row(i)[i];
+    }
+    return determinant == 0 ? T(0) : determinant; // no negative zero for singular matrices
+}
+
+//! x = Solution of a * x = b for a Matrix b with a Right-Hand Side in Every Column (x may be b)
+template<typename T, typename Runner>
+void matrixSolve(Matrix<T>* x, const Matrix<T>* a, const Matrix<T>* b, size_t threads, const Runner& run){
+    if(b->rows != a->rows){
+        std::cerr << "Error: matrix <" << containerName(b) << "> must have " << a->rows << " rows to solve a system with matrix <" << containerName(a) << "> (has " << b->rows << ")." << std::endl;
+        exit(0);
+    }
+    Matrix<T> lu;
+    std::vector<size_t> perm;
+    luFactorRegular(&lu, perm, a, threads, run);
+    Matrix<T> result;
+    result.resize(b->rows, b->cols);
+    for(size_t i = 0; i < b->rows; i++){
+        std::copy(b->row(perm[i]), b->row(perm[i]) + b->cols, result.row(i));
+    }
+    luSolveInPlace(&lu, &result, threads, run);
+    matrixAssign(x, &result);
+}
+
+//! x = Solution of a * x = b for a List b
+template<typename T, typename Runner>
+void listSolve(std::vector<T>* x, const Matrix<T>* a, const std::vector<T>* b, size_t threads, const Runner& run){
+    if(b->size() != a->rows){
+        std::cerr << "Error: list <" << containerName(b) << "> must have " << a->rows << " entries to solve a system with matrix <" << containerName(a) << "> (has " << b->size() << ")." << std::endl;
+        exit(0);
+    }
+    Matrix<T> lu;
+    std::vector<size_t> perm;
+    luFactorRegular(&lu, perm, a, threads, run);
+    Matrix<T> result;
+    result.resize(b->size(), 1);
+    for(size_t i = 0; i < b->size(); i++){
+        result.row(i)[0] = (*b)[perm[i]];
+    }
+    luSolveInPlace(&lu, &result, threads, run);
+    x->resize(b->size());
+    for(size_t i = 0; i < b->size(); i++){
+        (*x)[i] = result.row(i)[0];
+    }
+}
+
+//! target = Inverse of a (Solves a * X = I; target may be a)
+template<typename T, typename Runner>
+void matrixInverse(Matrix<T>* target, const Matrix<T>* a, size_t threads, const Runner& run){
+    Matrix<T> lu;
+    std::vector<size_t> perm;
+    luFactorRegular(&lu, perm, a, threads, run);
+    Matrix<T> result;
+    result.resize(a->rows, a->rows);
+    for(size_t i = 0; i < a->rows; i++){
+        result.row(i)[perm[i]] = 1;
+    }
+    luSolveInPlace(&lu, &result, threads, run);
+    matrixAssign(target, &result);
+}
+
+#endif //SQBRA_LINALG_H
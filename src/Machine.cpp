@@ -0,0 +1,321 @@
+/*
+ *  MACHINE.CPP
+ *  This file contains the virtual machine for the SquareBracket language.
+ *  The machine runs the bytecode of the compiler in a single dispatch loop with a register window per call.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Bytecode.h"
+#include "Recurser.h"
+
+template<typename T>
+struct Frame {
+    Chunk<T>* chunk;
+    int pc;
+    size_t base;
+};
+
+//! Report an Out of Bounds Access of a List and Terminate
+void listBoundsError(void* list, int i){
+    std::cerr << "Error: Index out of bounds for list <" << list << "> at index <" << i << ">." << std::endl;
+    exit(0);
+}
+
+//! Report an Out of Bounds Access of a Matrix and Terminate
+void matrixBoundsError(void* mat, int i1, int i2){
+    std::cerr << "Error: Index out of bounds for matrix <" << mat << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+    exit(0);
+}
+
+//! Size of the Register Window of a Chunk
+template<typename T>
+inline size_t windowSize(Chunk<T>* chunk){
+    return chunk->registers + chunk->constants.size();
+}
+
+//! Allocate the Register Window of a Chunk and Preload its Constants
+template<typename T>
+inline void enterChunk(std::vector<T>& regs, size_t base, Chunk<T>* chunk){
+    if(regs.size() < base + windowSize(chunk)){
+        regs.resize((base + windowSize(chunk)) * 2);
+    }
+    std::copy(chunk->constants.begin(), chunk->constants.end(), regs.begin() + base + chunk->registers);
+}
+
+//! Run the Compiled Program
+template<typename T>
+void runProgram(Program<T>* program){
+    std::vector<Chunk<T>*> bound(program->functions.size(), nullptr); // functions declared so far
+    std::vector<Frame<T>> frames;
+    std::vector<T> regs(256);
+    bool ifstate = false;
+
+    Chunk<T>* chunk = program->chunks[0];
+    size_t base = 0;
+    enterChunk(regs, base, chunk);
+    const Instruction* code = chunk->code.data();
+    T* R = regs.data() + base;
+    int pc = 0;
+
+    for(;;){
+        const Instruction& in = code[pc++];
+        switch(in.op){
+            case OpCode::MOVE:
+                R[in.a] = R[in.b];
+                break;
+            case OpCode::LOADV:
+                R[in.a] = *(T*)in.p;
+                break;
+            case OpCode::LOADL: {
+                auto list = (std::vector<T>*)in.p;
+                auto i = (int)R[in.b];
+                if(list->size() > i){
+                    R[in.a] = (*list)[i];
+                }else{
+                    listBoundsError(in.p, i);
+                }
+                break;
+            }
+            case OpCode::LOADM: {
+                auto mat = (Matrix<T>*)in.p;
+                auto i1 = (int)R[in.b];
+                auto i2 = (int)R[in.c];
+                if(mat->contains(i1, i2)){
+                    R[in.a] = mat->at(i1, i2);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::LOADT: {
+                auto array = (TypedArray*)in.p;
+                auto i1 = (int)R[in.b];
+                if(!array->matrix){
+                    if(array->contains(i1)){
+                        R[in.a] = array->load<T>(i1);
+                    }else{
+                        listBoundsError(in.p, i1);
+                    }
+                    break;
+                }
+                auto i2 = (int)R[in.c];
+                if(array->contains(i1, i2)){
+                    R[in.a] = array->load<T>(i1 * array->cols + i2);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::LOADS: {
+                auto sparse = (SparseMatrix<T>*)in.p;
+                auto i1 = (int)R[in.b];
+                auto i2 = (int)R[in.c];
+                if(sparse->contains(i1, i2)){
+                    R[in.a] = sparse->at(i1, i2);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::LOADB: {
+                auto bits = (BitMatrix*)in.p;
+                auto i1 = (int)R[in.b];
+                auto i2 = (int)R[in.c];
+                if(bits->contains(i1, i2)){
+                    R[in.a] = bits->get(i1, i2);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::LOADD:
+                R[in.a] = dictGet((Dict<T>*)in.p, R[in.b]);
+                break;
+            case OpCode::STOREV:
+                *(T*)in.p = R[in.a];
+                break;
+            case OpCode::STOREL: {
+                auto list = (std::vector<T>*)in.p;
+                auto i = (int)R[in.b];
+                if(list->size() > i){
+                    (*list)[i] = R[in.a];
+                }else{
+                    listBoundsError(in.p, i);
+                }
+                break;
+            }
+            case OpCode::STOREM: {
+                auto mat = (Matrix<T>*)in.p;
+                auto i1 = (int)R[in.b];
+                auto i2 = (int)R[in.c];
+                if(mat->contains(i1, i2)){
+                    mat->at(i1, i2) = R[in.a];
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::STORET: {
+                auto array = (TypedArray*)in.p;
+                auto i1 = (int)R[in.b];
+                if(!array->matrix){
+                    if(array->contains(i1)){
+                        typedStore(array, i1, R[in.a]);
+                    }else{
+                        listBoundsError(in.p, i1);
+                    }
+                    break;
+                }
+                auto i2 = (int)R[in.c];
+                if(array->contains(i1, i2)){
+                    typedStore(array, i1 * array->cols + i2, R[in.a]);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::STOREB: {
+                auto bits = (BitMatrix*)in.p;
+                auto i1 = (int)R[in.b];
+                auto i2 = (int)R[in.c];
+                if(bits->contains(i1, i2)){
+                    bits->set(i1, i2, R[in.a] > 0);
+                }else{
+                    matrixBoundsError(in.p, i1, i2);
+                }
+                break;
+            }
+            case OpCode::INCV:
+                *(T*)in.p += 1;
+                break;
+            case OpCode::DECV:
+                *(T*)in.p -= 1;
+                break;
+            case OpCode::INCR:
+                R[in.a] += 1;
+                break;
+            case OpCode::DECR:
+                R[in.a] -= 1;
+                break;
+            case OpCode::TRUNC:
+                R[in.a] = (int)R[in.a];
+                break;
+            case OpCode::TRUTH:
+                R[in.a] = R[in.a] > 0;
+                break;
+            case OpCode::ADD:
+                R[in.a] = R[in.b] + R[in.c];
+                break;
+            case OpCode::SUB:
+                R[in.a] = R[in.b] - R[in.c];
+                break;
+            case OpCode::MUL:
+                R[in.a] = R[in.b] * R[in.c];
+                break;
+            case OpCode::DIV:
+                R[in.a] = R[in.b] / R[in.c];
+                break;
+            case OpCode::MOD:
+                R[in.a] = fmod(R[in.b], R[in.c]);
+                break;
+            case OpCode::POW:
+                R[in.a] = pow(R[in.b], R[in.c]);
+                break;
+            case OpCode::EQ:
+                R[in.a] = R[in.b] == R[in.c];
+                break;
+            case OpCode::NEQ:
+                R[in.a] = R[in.b] != R[in.c];
+                break;
+            case OpCode::LARGER:
+                R[in.a] = R[in.b] > R[in.c];
+                break;
+            case OpCode::LARGEREQ:
+                R[in.a] = R[in.b] >= R[in.c];
+                break;
+            case OpCode::LESS:
+                R[in.a] = R[in.b] < R[in.c];
+                break;
+            case OpCode::LESSEQ:
+                R[in.a] = R[in.b] <= R[in.c];
+                break;
+            case OpCode::ANDJ:
+                if(!(R[in.a] > 0)){
+                    R[in.a] = 0;
+                    pc = in.b;
+                }
+                break;
+            case OpCode::ORJ:
+                if(R[in.a] > 0){
+                    R[in.a] = 1;
+                    pc = in.b;
+                }
+                break;
+            case OpCode::JMP:
+                pc = in.b;
+                break;
+            case OpCode::JMPF:
+                if(!(R[in.a] > 0)){
+                    pc = in.b;
+                }
+                break;
+            case OpCode::JMPFV:
+                if(!(*(T*)in.p > 0)){
+                    pc = in.b;
+                }
+                break;
+            case OpCode::JMPNIF:
+                if(!ifstate){
+                    pc = in.b;
+                }
+                break;
+            case OpCode::SETIF:
+                ifstate = in.a != 0;
+                break;
+            case OpCode::DEFUN:
+                if(bound[in.a] == nullptr){
+                    bound[in.a] = program->chunks[in.b];
+                }else{
+                    std::cerr << "Error: function <" << program->functions[in.a] << "> is aleady defined" << std::endl;
+                    exit(0); // terminate program
+                }
+                break;
+            case OpCode::CALL: {
+                Chunk<T>* callee = bound[in.a];
+                if(callee == nullptr){
+                    std::cerr << "Error: function <" << program->functions[in.a] << "> is not defined" << std::endl;
+                    exit(0);
+                }
+                frames.push_back(Frame<T>{chunk, pc, base});
+                base += windowSize(chunk);
+                chunk = callee;
+                enterChunk(regs, base, chunk);
+                code = chunk->code.data();
+                R = regs.data() + base;
+                pc = 0;
+                break;
+            }
+            case OpCode::RET:
+                if(frames.empty()){
+                    return; // leave the main program
+                }
+                chunk = frames.back().chunk;
+                pc = frames.back().pc;
+                base = frames.back().base;
+                frames.pop_back();
+                code = chunk->code.data();
+                R = regs.data() + base;
+                break;
+            case OpCode::EXIT:
+                exit(0);
+            case OpCode::CMD:
+                executeCommand<T>((Node*)in.p);
+                break;
+        }
+    }
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template void runProgram<double>(Program<double>* program);
+template void runProgram<long double>(Program<long double>* program);
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef SQBRA_MAPPED_H
+#define SQBRA_MAPPED_H
+
+/*
+ *  MAPPED.H
+ *  This file contains the file-backed matrices of the SquareBracket language (mmat) and the tiled traversal of the
+ *  bulk commands. The entries of a file-backed matrix live in a binary row-major file of numbers of the precision of
+ *  the interpreter, which is mapped into memory: the system loads the pages when they are used and writes changed
+ *  pages back to the file, so the matrix may be larger than the memory of the machine. The bulk commands visit such
+ *  matrices in tiles of rows, ask for the next tile in advance and drop every finished tile from memory.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#include "Matrix.h"
+
+#ifdef SQBRA_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+const size_t MAPPED_TILE = (size_t)1 << 24; // bytes of the rows of one tile of a file-backed matrix (16 MB)
+
+//! Map the File path as a rows x cols Matrix (a new or empty file is created with zeros)
+template<typename T>
+void matrixMapFile(Matrix<T>* matrix, const std::string& path, int rows, int cols){
+    size_t newRows = (size_t)std::max(rows, 0);
+    size_t newCols = (size_t)std::max(cols, 0);
+    size_t bytes = newRows * newCols * sizeof(T);
+#ifdef SQBRA_MMAP
+    int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat info;
+    if(file < 0 || fstat(file, &info) != 0){
+        std::cerr << "Error: Unable to open file: " << path << std::endl;
+        exit(0);
+    }
+    if(info.st_size == 0 && ftruncate(file, (off_t)bytes) != 0){
+        std::cerr << "Error: Unable to extend file " << path << " to " << bytes << " bytes." << std::endl;
+        exit(0);
+    }else if(info.st_size != 0 && (size_t)info.st_size != bytes){
+        std::cerr << "Error: file " << path << " holds " << info.st_size << " bytes, a " << newRows << "x" << newCols << " matrix needs " << bytes << " bytes (" << sizeof(T) << " per entry)." << std::endl;
+        exit(0);
+    }
+    T* entries = nullptr;
+    if(bytes > 0){
+        void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        if(address == MAP_FAILED){
+            std::cerr << "Error: Unable to map file " << path << " into memory." << std::endl;
+            exit(0);
+        }
+        madvise(address, bytes, MADV_SEQUENTIAL); // the commands go through the rows in order
+        entries = (T*)address;
+    }
+    close(file); // the mapping keeps the file open
+    matrix->adopt(entries, newRows, newCols, bytes);
+#else
+    (void)matrix;
+    std::cerr << "Error: file-backed matrices (" << path << ", " << bytes << " bytes) are not supported on this platform." << std::endl;
+    exit(0);
+#endif
+}
+
+//! Call visit(first, last) for Tiles of the rows Rows; if one of the Matrices is File-Backed, the Next Tile is
+//! Requested Before and the Tile is Dropped from Memory After it is Visited
+template<typename T, typename Visit>
+void forRowTiles(size_t rows, std::initializer_list<const Matrix<T>*> matrices, const Visit& visit){
+    size_t rowBytes = 0;
+    for(const Matrix<T>* matrix : matrices){
+        const Matrix<T>* owner = matrix->view ? matrix->base : matrix;
+        if(owner != nullptr && owner->mapped != 0){
+            rowBytes = std::max(rowBytes, matrix->stride * sizeof(T));
+        }
+    }
+    if(rowBytes == 0){
+        visit((size_t)0, rows);
+        return;
+    }
+    size_t tile = std::max<size_t>(MAPPED_TILE / rowBytes, 1);
+    for(size_t first = 0; first < rows; first += tile){
+        size_t last = std::min(first + tile, rows);
+        for(const Matrix<T>* matrix : matrices){
+            matrix->adviseRows(last, std::min(last + tile, rows), false);
+        }
+        visit(first, last);
+        for(const Matrix<T>* matrix : matrices){
+            matrix->adviseRows(first, last, true);
+        }
+    }
+}
+
+#endif //SQBRA_MAPPED_H
@@ -1,492 +1,1203 @@
-/*
- *  MATHCORE.CPP
- *  This file contains the parser, optimizer and calculator for mathematical expressions.
- *  These functions are vital for the parser and many functions.
- *  Copyright (c) 2023, Patrick De Smet
- */
-
-#include "Tokens.h"
-
-std::unordered_map<std::string, long double*> vars; // global map for all vars (only required during parsing)
-std::unordered_map<std::string, std::vector<long double>*> ars; // global map for all arrays (only required during parsing)
-std::unordered_map<std::string, std::vector<std::vector<long double>* >*> mars; // global map for all matrices (only required during parsing)
-
-inline void* getPointer(const std::string& str, MathNodeType type){
-    if (type == MathNodeType::Variable) {
-        if (vars.find(str) != vars.end()) {
-            return vars[str];
-        } else {
-            std::cerr << "Error: variable <" << str << "> is not defined." << std::endl;
-            exit(0);
-        }
-    } else if (type == MathNodeType::Array) {
-        if (ars.find(str) != ars.end()) {
-            return ars[str];
-        } else {
-            std::cerr << "Error: list <" << str << "> is not defined." << std::endl;
-            exit(0);
-        }
-    } else {
-        if (mars.find(str) != mars.end()) {
-            return mars[str];
-        } else {
-            std::cerr << "Error: matrix <" << str << "> is not defined." << std::endl;
-            exit(0);
-        }
-    }
-}
-
-inline bool isOperator(char c) {
-    return c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '^' || c == '&' || c == '|' || c == '=' || c == '<' || c == '>' || c == '!' || c == 0x1d || c == 0x1e || c == 0x1f;
-}
-
-inline int precedence(char op) {
-    if (op == '|') {
-        return 1;
-    } else if (op == '&') {
-        return 2;
-    } else if (op == '=' || op == '<' || op == '>' || op == 0x1d || op == 0x1e || op == 0x1f) {
-        return 3;
-    } else if (op == '+' || op == '-') {
-        return 4;
-    } else if (op == '*' || op == '/' || op == '%') {
-        return 5;
-    } else if (op == '^') {
-        return 6;
-    } else {
-        return 0;
-    }
-}
-
-inline std::string removeSpaces(std::string const& str) {
-   std::string retStr;
-   auto predicate = []( char ch )
-   {
-      return !std::isspace( ch );
-   };
-   std::copy_if( str.begin(), str.end(), std::back_inserter( retStr ), predicate );
-   return retStr;
-}
-
-// Check if the input string s represents a 2D matrix or a 1D list, and extract its indices
-inline MathTypeReturn determineType(std::string& str) {
-    int count = 0;
-    int dimensions = 0;
-    MathTypeReturn res;
-    for(auto i : str){
-        if(i == '['){
-            // Increment dimensions only once per opening bracket
-            if(count == 0){
-                dimensions++;
-            }
-            count++;
-        } else if(i == ']') {
-            count--;
-        }
-        // Extract components based on the count and dimension
-        if(count == 0 && i != ']' || count == 1 && i != '[' || count > 1){
-            if(dimensions == 0){
-                res.var.push_back(i);
-            } else if(dimensions == 1){
-                res.ind1.push_back(i);
-            } else{
-                res.ind2.push_back(i);
-            }
-        }
-    }
-    // Return type of variable
-    if(dimensions == 0){
-        res.type = MathNodeType::Variable;
-    } else if(dimensions == 1){
-        res.type = MathNodeType::Array;
-    } else if(dimensions == 2){
-        res.type = MathNodeType::Matrix;
-    } else{
-        std::cerr << "Error: expression <" << str << "> is incorrect." << std::endl;
-        exit(0);
-    }
-    return res;
-}
-
-MathNode* parseExpressionRaw(std::string expr) {
-    std::stack<MathNode*> nodeStack;
-    std::stack<char> opStack;
-    int open_sqbr = 0;
-
-    for (int i = 0; i < expr.size(); i++) {
-        if (expr[i] == ' ') {
-            continue;
-        } else if (isdigit(expr[i]) || (expr[i] == '-' && (i == 0 || isOperator(expr[i-1]) || expr[i-1] == '(') || expr[i-1] == '[')) {
-            std::string number;
-            while (i < expr.size() && (isdigit(expr[i]) || expr[i] == '.' || expr[i] == '-')) {
-                number += expr[i];
-                i++;
-            }
-            i--;
-            nodeStack.push(new MathNode(MathNodeType::Constant, stod(number)));
-        } else if (isalpha(expr[i])) {
-            std::string variable;
-            while (i < expr.size() && (isalpha(expr[i]) || isdigit(expr[i]) || expr[i] == '_' || (isOperator(expr[i]) && open_sqbr >= 1) || (expr[i] == '[' || expr[i] == ']') || (open_sqbr >= 1 && (expr[i] == '(' || expr[i] == ')')))) {
-                if(expr[i] == '['){
-                    open_sqbr += 1;
-                }else if(expr[i] == ']' && open_sqbr > 0){
-                    open_sqbr -= 1;
-                }
-                variable += expr[i];
-                i++;
-            }
-            i--;
-            MathNode* tmp;
-            MathTypeReturn detT = determineType(variable);
-            if(detT.type == MathNodeType::Variable){
-                tmp = new MathNode(MathNodeType::Variable, getPointer(variable, MathNodeType::Variable));
-            }else if(detT.type == MathNodeType::Array){
-                tmp = new MathNode(MathNodeType::Array, getPointer(detT.var, MathNodeType::Array));
-                tmp->left = parseExpressionRaw(detT.ind1);
-            }else{
-                tmp = new MathNode(MathNodeType::Matrix, getPointer(detT.var, MathNodeType::Matrix));
-                tmp->left = parseExpressionRaw(detT.ind1);
-                tmp->right = parseExpressionRaw(detT.ind2);
-            }
-            nodeStack.push(tmp);
-        } else if (expr[i] == '(') {
-            opStack.push('(');
-        } else if (expr[i] == ')') {
-            while (!opStack.empty() && opStack.top() != '(') {
-                char op = opStack.top();
-                opStack.pop();
-                MathNode* right = nodeStack.top();
-                nodeStack.pop();
-                MathNode* left = nodeStack.top();
-                nodeStack.pop();
-                MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op));
-                opMathNode->left = left;
-                opMathNode->right = right;
-                nodeStack.push(opMathNode);
-            }
-            opStack.pop();
-        } else if (isOperator(expr[i])) {
-            char op = expr[i];
-            while (!opStack.empty() && opStack.top() != '(' && precedence(opStack.top()) >= precedence(op)) {
-                char op2 = opStack.top();
-                opStack.pop();
-                MathNode* right = nodeStack.top();
-                nodeStack.pop();
-                MathNode* left = nodeStack.top();
-                nodeStack.pop();
-                MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op2));
-                opMathNode->left = left;
-                opMathNode->right = right;
-                nodeStack.push(opMathNode);
-            }
-            opStack.push(op);
-        }
-    }
-
-    while (!opStack.empty()) {
-        char op = opStack.top();
-        opStack.pop();
-        MathNode* right = nodeStack.top();
-        nodeStack.pop();
-        MathNode* left = nodeStack.top();
-        nodeStack.pop();
-        MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op));
-        opMathNode->left = left;
-        opMathNode->right = right;
-        nodeStack.push(opMathNode);
-    }
-
-    return nodeStack.top();
-}
-
-long double calculateExpression(MathNode* root){
-    if(root->type == MathNodeType::Constant){
-        return root->constant;
-    }else if(root->type == MathNodeType::Variable) {
-        return *((long double*)root->variable);
-    }else if(root->type == MathNodeType::Operator){
-        if(root->opt == MathOperatorType::PLUS){
-            return calculateExpression(root->left) + calculateExpression(root->right);
-        }else if(root->opt == MathOperatorType::MINUS){
-            return calculateExpression(root->left) - calculateExpression(root->right);
-        }else if(root->opt == MathOperatorType::DIV){
-            return calculateExpression(root->left) / calculateExpression(root->right);
-        }else if(root->opt == MathOperatorType::MULT){
-            return calculateExpression(root->left) * calculateExpression(root->right);
-        }else if(root->opt == MathOperatorType::MOD){
-            return fmod(calculateExpression(root->left), calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::EXP){
-            return pow(calculateExpression(root->left),calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::AND) {
-            return (calculateExpression(root->left) > 0 && calculateExpression(root->right) > 0);
-        }else if(root->opt == MathOperatorType::OR) {
-            return (calculateExpression(root->left) > 0 || calculateExpression(root->right) > 0);
-        }else if(root->opt == MathOperatorType::EQ){
-            return (calculateExpression(root->left) == calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::NEQ){
-            return (calculateExpression(root->left) != calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::LARGEREQ){
-            return (calculateExpression(root->left) >= calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::LESSEQ){
-            return (calculateExpression(root->left) <= calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::LARGER){
-            return (calculateExpression(root->left) > calculateExpression(root->right));
-        }else if(root->opt == MathOperatorType::LESS) {
-            return (calculateExpression(root->left) < calculateExpression(root->right));
-        }
-    }else if(root->type == MathNodeType::Array) {
-        auto list = reinterpret_cast<std::vector<long double>*>(root->variable);
-        auto i = (int)(calculateExpression(root->left));
-        if(list->size() > i){
-            return (*list)[i];
-        }else{
-            std::cerr << "Error: Index out of bounds for list <" << root->variable << "> at index <" << i << ">." << std::endl;
-            exit(0);
-        }
-    }else if(root->type == MathNodeType::Matrix) {
-        auto mat = reinterpret_cast<std::vector<std::vector<long double>*>*>(root->variable);
-        auto i1 = (int)(calculateExpression(root->left));
-        auto i2 = (int)(calculateExpression(root->right));
-        if(i1 < mat->size() && i2 < (*(*mat)[i1]).size()){
-            return (*(*mat)[i1])[i2];
-        }else{
-            std::cerr << "Error: Index out of bounds for matrix <" << root->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
-            exit(0);
-        }
-    }
-    return 0;
-}
-
-inline void replace_special_operators(std::string& input) {
-    size_t pos = 0;
-    while ((pos = input.find("<=", pos)) != std::string::npos) {
-        input.replace(pos, 2, 1, (char)0x1d);
-        pos += 1;
-    }
-    pos = 0;
-    while ((pos = input.find(">=", pos)) != std::string::npos) {
-        input.replace(pos, 2, 1, (char)0x1e);
-        pos += 1;
-    }
-    pos = 0;
-    while ((pos = input.find("!=", pos)) != std::string::npos) {
-        input.replace(pos, 2, 1, (char)0x1f);
-        pos += 1;
-    }
-}
-
-std::string getOperator(MathOperatorType type){
-    if(type == MathOperatorType::PLUS){
-        return "ADD";
-    }else if(type == MathOperatorType::MINUS){
-        return "SUB";
-    }else if(type == MathOperatorType::MULT){
-        return "MULT";
-    }else if(type == MathOperatorType::DIV){
-        return "DIV";
-    }else if(type == MathOperatorType::MOD){
-        return "MOD";
-    }else if(type == MathOperatorType::EXP){
-        return "EXP";
-    }else if(type == MathOperatorType::AND){
-        return "AND";
-    }else if(type == MathOperatorType::OR){
-        return "OR";
-    }else if(type == MathOperatorType::EQ){
-        return "EQ";
-    }else if(type == MathOperatorType::LARGER){
-        return "LARGER";
-    }else if(type == MathOperatorType::LESS){
-        return "LESS";
-    }else if(type == MathOperatorType::NEQ){
-        return "UNEQUAL";
-    }else if(type == MathOperatorType::LESSEQ){
-        return "LESSQ";
-    }else if(type == MathOperatorType::LARGEREQ){
-        return "LARGERQ";
-    }
-    return "";
-}
-
-MathOperatorType getOperatorType(const char c){
-        if(c == '+'){
-            return MathOperatorType::PLUS;
-        }else if (c == '-'){
-            return MathOperatorType::MINUS;
-        }else if (c == '*'){
-            return MathOperatorType::MULT;
-        }else if (c == '/'){
-            return MathOperatorType::DIV;
-        }else if (c == '%'){
-            return MathOperatorType::MOD;
-        }else if (c == '^'){
-            return MathOperatorType::EXP;
-        }else if (c == '&'){
-            return MathOperatorType::AND;
-        }else if (c == '|'){
-            return MathOperatorType::OR;
-        }else if (c == '='){
-            return MathOperatorType::EQ;
-        }else if (c == '>'){
-            return MathOperatorType::LARGER;
-        }else if (c == '<'){
-            return MathOperatorType::LESS;
-        }else if (c == 0x1f){
-            return MathOperatorType::NEQ;
-        }else if (c == 0x1d){
-            return MathOperatorType::LESSEQ;
-        }else if (c == 0x1e){
-            return MathOperatorType::LARGEREQ;
-        }
-        return MathOperatorType::NOTSET;
-}
-
-void optimizeExpression(MathNode* root){
-
-    if(root->left != nullptr){ // Recurse the entire tree
-        optimizeExpression(root->left);
-    }
-    if(root->right != nullptr){
-        optimizeExpression(root->right);
-    }
-
-    // Simplify constant expressions
-    if(root->type == MathNodeType::Operator && root->left->type == MathNodeType::Constant && root->right->type == MathNodeType::Constant){
-        // Replace operator node with constant node
-        root->constant = calculateExpression(root);
-        root->type = MathNodeType::Constant;
-        root->left = nullptr;
-        root->right = nullptr;
-        root->opt = MathOperatorType::NOTSET;
-    }
-
-    // Simplify multiplication by 0 or 1
-    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::MULT){
-        if(root->left->type == MathNodeType::Constant){
-            if(root->left->constant == 0.0){
-                // Multiplication by 0
-                root->type = MathNodeType::Constant;
-                root->constant = 0.0;
-                root->left = nullptr;
-                root->right = nullptr;
-                root->opt = MathOperatorType::NOTSET;
-            }else if(root->left->constant == 1.0){
-                // Multiplication by 1
-                MathNode* newRoot = root->right;
-                *root = *newRoot;
-                delete newRoot;
-            }
-        }else if(root->right->type == MathNodeType::Constant){
-            if(root->right->constant == 0.0){
-                // Multiplication by 0
-                root->type = MathNodeType::Constant;
-                root->constant = 0.0;
-                root->left = nullptr;
-                root->right = nullptr;
-                root->opt = MathOperatorType::NOTSET;
-            }else if(root->right->constant == 1.0){
-                // Multiplication by 1
-                MathNode* newRoot = root->left;
-                *root = *newRoot;
-                delete newRoot;
-            }
-        }
-    }
-    // Simplify addition or subtraction with 0
-    if(root->type == MathNodeType::Operator && (root->opt == MathOperatorType::PLUS || root->opt == MathOperatorType::MINUS)){
-        if(root->left->type == MathNodeType::Constant && root->left->constant == 0.0){
-            // Addition or subtraction with 0
-            MathNode* newRoot = root->right;
-            *root = *newRoot;
-            delete newRoot;
-        }
-        else if(root->right->type == MathNodeType::Constant && root->right->constant == 0.0){
-            // Addition or subtraction with 0
-            MathNode* newRoot = root->left;
-            *root = *newRoot;
-            delete newRoot;
-        }
-    }
-
-    // Simplify multiplication by -1
-    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::MULT){
-        if(root->left->type == MathNodeType::Constant && root->left->constant == -1.0){
-            // Multiplication by -1
-            MathNode* newRoot = root->right;
-            root->type = MathNodeType::Operator;
-            root->opt = MathOperatorType::MINUS;
-            root->left = new MathNode(MathNodeType::Constant, 0.0);
-            root->right = newRoot;
-        }
-        else if(root->right->type == MathNodeType::Constant && root->right->constant == -1.0){
-            // Multiplication by -1
-            MathNode* newRoot = root->left;
-            root->type = MathNodeType::Operator;
-            root->opt = MathOperatorType::MINUS;
-            root->left = new MathNode(MathNodeType::Constant, 0.0);
-            root->right = newRoot;
-        }
-    }
-
-    // Simplify division by 1
-    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::DIV){
-        if(root->right->type == MathNodeType::Constant && root->right->constant == 1.0){
-            // Division by 1
-            MathNode* newRoot = root->left;
-            *root = *newRoot;
-            delete newRoot;
-        }
-    }
-}
-
-bool checkExpression(const std::string& expr){
-    int brackets = 0;
-    int sqbrackets = 0;
-    for(char i : expr){
-        if(i == '('){
-            brackets += 1;
-        }else if(i == ')'){
-            brackets -= 1;
-        }else if(i == '['){
-            sqbrackets += 1;
-        }else if(i == ']'){
-            sqbrackets -= 1;
-        }else if(!(i == ' ' || i == '.' || i == '_' || isdigit(i) || isalpha(i) || isOperator(i))){
-            return false;
-        }
-    }
-    if(brackets != 0 || sqbrackets != 0){
-        return false;
-    }
-    return true;
-}
-
-MathNode* mathparse(const std::string& expr){
-    if(checkExpression(expr)) {
-        std::string expr_ws = removeSpaces(expr);
-        replace_special_operators(expr_ws);
-        MathNode* expression = parseExpressionRaw(expr_ws);
-        optimizeExpression(expression);
-        return expression;
-    }else{
-        std::cerr << "Error: <" << expr << "> expression is incorrect." << std::endl;
-        exit(0);
-    }
-}
-
-MathNode* varparse(const std::string& expr){
-    if(checkExpression(expr)) {
-        std::string expr_ws = removeSpaces(expr);
-        replace_special_operators(expr_ws);
-        MathNode* expression = parseExpressionRaw(expr_ws);
-        optimizeExpression(expression);
-        if(expression->type == MathNodeType::Array || expression->type == MathNodeType::Variable || expression->type == MathNodeType::Matrix){
-            return expression;
-        }
-        std::cerr << "Error: <" << expr << "> must be only a variable or list entry." << std::endl;
-        exit(0);
-    }else{
-        std::cerr << "Error: <" << expr << "> variable or list entry are incorrect." << std::endl;
-        exit(0);
-    }
-}
+/*
+ *  MATHCORE.CPP
+ *  This file contains the parser, optimizer and calculator for mathematical expressions.
+ *  These functions are vital for the parser and many functions.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Tokens.h"
+#include "Jit.h"
+#include "Kernels.h"
+
+const int MATH_STACK_SIZE = 32; // expressions that need a deeper value stack are not flattened
+const size_t ARRAY_BLOCK = 256; // entries of a whole-array expression that are processed at once (the blocks stay in the L1 cache)
+
+template<typename T>
+inline void* getPointer(const std::string& str, MathNodeType type){
+    if (type == MathNodeType::Variable) {
+        if (vars<T>.find(str) != vars<T>.end()) {
+            return vars<T>[str];
+        } else {
+            std::cerr << "Error: variable <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else if (type == MathNodeType::Array) {
+        if (ars<T>.find(str) != ars<T>.end()) {
+            return ars<T>[str];
+        } else {
+            std::cerr << "Error: list <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else if (type == MathNodeType::Dict) {
+        if (dicts<T>.find(str) != dicts<T>.end()) {
+            return dicts<T>[str];
+        } else {
+            std::cerr << "Error: dictionary <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else if (type == MathNodeType::Typed) {
+        if (typeds<T>.find(str) != typeds<T>.end()) {
+            return typeds<T>[str];
+        } else {
+            std::cerr << "Error: list <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else if (type == MathNodeType::Sparse) {
+        if (sparses<T>.find(str) != sparses<T>.end()) {
+            return sparses<T>[str];
+        } else {
+            std::cerr << "Error: sparse matrix <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else if (type == MathNodeType::BitMatrix) {
+        if (bmats<T>.find(str) != bmats<T>.end()) {
+            return bmats<T>[str];
+        } else {
+            std::cerr << "Error: bit matrix <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    } else {
+        if (mars<T>.find(str) != mars<T>.end()) {
+            return mars<T>[str];
+        } else {
+            std::cerr << "Error: matrix <" << str << "> is not defined." << std::endl;
+            exit(0);
+        }
+    }
+}
+
+inline bool isOperator(char c) {
+    return c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '^' || c == '&' || c == '|' || c == '=' || c == '<' || c == '>' || c == '!' || c == 0x1d || c == 0x1e || c == 0x1f;
+}
+
+inline int precedence(char op) {
+    if (op == '|') {
+        return 1;
+    } else if (op == '&') {
+        return 2;
+    } else if (op == '=' || op == '<' || op == '>' || op == 0x1d || op == 0x1e || op == 0x1f) {
+        return 3;
+    } else if (op == '+' || op == '-') {
+        return 4;
+    } else if (op == '*' || op == '/' || op == '%') {
+        return 5;
+    } else if (op == '^') {
+        return 6;
+    } else {
+        return 0;
+    }
+}
+
+inline std::string removeSpaces(std::string const& str) {
+   std::string retStr;
+   auto predicate = []( char ch )
+   {
+      return !std::isspace( ch );
+   };
+   std::copy_if( str.begin(), str.end(), std::back_inserter( retStr ), predicate );
+   return retStr;
+}
+
+// Check if the input string s represents a 2D matrix or a 1D list, and extract its indices
+inline MathTypeReturn determineType(std::string& str) {
+    int count = 0;
+    int dimensions = 0;
+    MathTypeReturn res;
+    for(auto i : str){
+        if(i == '['){
+            // Increment dimensions only once per opening bracket
+            if(count == 0){
+                dimensions++;
+            }
+            count++;
+        } else if(i == ']') {
+            count--;
+        }
+        // Extract components based on the count and dimension
+        if(count == 0 && i != ']' || count == 1 && i != '[' || count > 1){
+            if(dimensions == 0){
+                res.var.push_back(i);
+            } else if(dimensions == 1){
+                res.ind1.push_back(i);
+            } else{
+                res.ind2.push_back(i);
+            }
+        }
+    }
+    // Return type of variable
+    if(dimensions == 0){
+        res.type = MathNodeType::Variable;
+    } else if(dimensions == 1){
+        res.type = MathNodeType::Array;
+    } else if(dimensions == 2){
+        res.type = MathNodeType::Matrix;
+    } else{
+        std::cerr << "Error: expression <" << str << "> is incorrect." << std::endl;
+        exit(0);
+    }
+    return res;
+}
+
+template<typename T>
+MathNode* parseExpressionRaw(std::string expr) {
+    std::stack<MathNode*> nodeStack;
+    std::stack<char> opStack;
+    int open_sqbr = 0;
+
+    for (int i = 0; i < expr.size(); i++) {
+        if (expr[i] == ' ') {
+            continue;
+        } else if (isdigit(expr[i]) || (expr[i] == '-' && (i == 0 || isOperator(expr[i-1]) || expr[i-1] == '(') || expr[i-1] == '[')) {
+            std::string number;
+            while (i < expr.size() && (isdigit(expr[i]) || expr[i] == '.' || (expr[i] == '-' && number.empty()))) {
+                number += expr[i];
+                i++;
+            }
+            i--;
+            nodeStack.push(new MathNode(MathNodeType::Constant, stod(number)));
+        } else if (isalpha(expr[i])) {
+            std::string variable;
+            while (i < expr.size() && (isalpha(expr[i]) || isdigit(expr[i]) || expr[i] == '_' || (isOperator(expr[i]) && open_sqbr >= 1) || (expr[i] == '[' || expr[i] == ']') || (open_sqbr >= 1 && (expr[i] == '(' || expr[i] == ')' || expr[i] == '.')))) {
+                if(expr[i] == '['){
+                    open_sqbr += 1;
+                }else if(expr[i] == ']' && open_sqbr > 0){
+                    open_sqbr -= 1;
+                }
+                variable += expr[i];
+                i++;
+            }
+            i--;
+            MathNode* tmp;
+            if(variable == "where" && i + 1 < expr.size() && expr[i + 1] == '('){
+                // where(mask, x, y): split the arguments at the commas outside of nested brackets
+                std::vector<std::string> args(1);
+                int depth = 0;
+                int j = i + 1;
+                for(; j < expr.size(); j++){
+                    if(expr[j] == '(' || expr[j] == '['){
+                        if(++depth == 1){
+                            continue;
+                        }
+                    }else if(expr[j] == ')' || expr[j] == ']'){
+                        if(--depth == 0){
+                            break;
+                        }
+                    }else if(expr[j] == ',' && depth == 1){
+                        args.emplace_back();
+                        continue;
+                    }
+                    args.back() += expr[j];
+                }
+                if(args.size() != 3 || args[0].empty() || args[1].empty() || args[2].empty()){
+                    std::cerr << "Error: where() needs three arguments: where(mask, x, y)." << std::endl;
+                    exit(0);
+                }
+                tmp = new MathNode(MathNodeType::Select, MathOperatorType::NOTSET);
+                tmp->left = parseExpressionRaw<T>(args[0]);
+                tmp->right = parseExpressionRaw<T>(args[1]);
+                tmp->otherwise = parseExpressionRaw<T>(args[2]);
+                nodeStack.push(tmp);
+                i = j;
+                continue;
+            }
+            MathTypeReturn detT = determineType(variable);
+            if(detT.type == MathNodeType::Variable && vars<T>.find(variable) == vars<T>.end() && ars<T>.find(variable) != ars<T>.end()){
+                tmp = new MathNode(MathNodeType::WholeList, getPointer<T>(variable, MathNodeType::Array));
+            }else if(detT.type == MathNodeType::Variable && vars<T>.find(variable) == vars<T>.end() && mars<T>.find(variable) != mars<T>.end()){
+                tmp = new MathNode(MathNodeType::WholeMatrix, getPointer<T>(variable, MathNodeType::Matrix));
+            }else if(detT.type == MathNodeType::Variable){
+                tmp = new MathNode(MathNodeType::Variable, getPointer<T>(variable, MathNodeType::Variable));
+            }else if(detT.type == MathNodeType::Array && ars<T>.find(detT.var) == ars<T>.end() && dicts<T>.find(detT.var) != dicts<T>.end()){
+                tmp = new MathNode(MathNodeType::Dict, getPointer<T>(detT.var, MathNodeType::Dict));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+            }else if(detT.type == MathNodeType::Array && ars<T>.find(detT.var) == ars<T>.end() && typeds<T>.find(detT.var) != typeds<T>.end() && !typeds<T>[detT.var]->matrix){
+                tmp = new MathNode(MathNodeType::Typed, getPointer<T>(detT.var, MathNodeType::Typed));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+            }else if(detT.type == MathNodeType::Array){
+                tmp = new MathNode(MathNodeType::Array, getPointer<T>(detT.var, MathNodeType::Array));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+            }else if(detT.type == MathNodeType::Matrix && mars<T>.find(detT.var) == mars<T>.end() && typeds<T>.find(detT.var) != typeds<T>.end() && typeds<T>[detT.var]->matrix){
+                tmp = new MathNode(MathNodeType::Typed, getPointer<T>(detT.var, MathNodeType::Typed));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+                tmp->right = parseExpressionRaw<T>(detT.ind2);
+            }else if(detT.type == MathNodeType::Matrix && mars<T>.find(detT.var) == mars<T>.end() && sparses<T>.find(detT.var) != sparses<T>.end()){
+                tmp = new MathNode(MathNodeType::Sparse, getPointer<T>(detT.var, MathNodeType::Sparse));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+                tmp->right = parseExpressionRaw<T>(detT.ind2);
+            }else if(mars<T>.find(detT.var) == mars<T>.end() && bmats<T>.find(detT.var) != bmats<T>.end()){
+                tmp = new MathNode(MathNodeType::BitMatrix, getPointer<T>(detT.var, MathNodeType::BitMatrix));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+                tmp->right = parseExpressionRaw<T>(detT.ind2);
+            }else{
+                tmp = new MathNode(MathNodeType::Matrix, getPointer<T>(detT.var, MathNodeType::Matrix));
+                tmp->left = parseExpressionRaw<T>(detT.ind1);
+                tmp->right = parseExpressionRaw<T>(detT.ind2);
+            }
+            nodeStack.push(tmp);
+        } else if (expr[i] == '(') {
+            opStack.push('(');
+        } else if (expr[i] == ')') {
+            while (!opStack.empty() && opStack.top() != '(') {
+                char op = opStack.top();
+                opStack.pop();
+                MathNode* right = nodeStack.top();
+                nodeStack.pop();
+                MathNode* left = nodeStack.top();
+                nodeStack.pop();
+                MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op));
+                opMathNode->left = left;
+                opMathNode->right = right;
+                nodeStack.push(opMathNode);
+            }
+            opStack.pop();
+        } else if (isOperator(expr[i])) {
+            char op = expr[i];
+            while (!opStack.empty() && opStack.top() != '(' && precedence(opStack.top()) >= precedence(op)) {
+                char op2 = opStack.top();
+                opStack.pop();
+                MathNode* right = nodeStack.top();
+                nodeStack.pop();
+                MathNode* left = nodeStack.top();
+                nodeStack.pop();
+                MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op2));
+                opMathNode->left = left;
+                opMathNode->right = right;
+                nodeStack.push(opMathNode);
+            }
+            opStack.push(op);
+        }
+    }
+
+    while (!opStack.empty()) {
+        char op = opStack.top();
+        opStack.pop();
+        MathNode* right = nodeStack.top();
+        nodeStack.pop();
+        MathNode* left = nodeStack.top();
+        nodeStack.pop();
+        MathNode* opMathNode = new MathNode(MathNodeType::Operator, getOperatorType(op));
+        opMathNode->left = left;
+        opMathNode->right = right;
+        nodeStack.push(opMathNode);
+    }
+
+    return nodeStack.top();
+}
+
+template<typename T>
+T calculateProgram(const MathProgram<T>* program){
+    T stack[MATH_STACK_SIZE]; // values below the top of the stack
+    const MathInstr* code = program->code.data();
+    const MathInstr* end = code + program->code.size();
+    T top = *(T*)code[0].variable; // postfix code always starts with a PUSH
+    int sp = -1;
+    for(const MathInstr* in = code + 1; in < end; in++){
+        // the top of the stack is kept in a local so that it can stay in a register
+        switch(in->code){
+            case MathCode::PUSH:
+                stack[++sp] = top;
+                top = *(T*)in->variable;
+                break;
+            case MathCode::LIST: {
+                auto list = reinterpret_cast<std::vector<T>*>(in->variable);
+                auto i = (int)top;
+                if(list->size() > i){
+                    top = (*list)[i];
+                }else{
+                    std::cerr << "Error: Index out of bounds for list <" << in->variable << "> at index <" << i << ">." << std::endl;
+                    exit(0);
+                }
+                break;
+            }
+            case MathCode::MAT: {
+                auto mat = reinterpret_cast<Matrix<T>*>(in->variable);
+                auto i2 = (int)top;
+                auto i1 = (int)stack[sp--];
+                if(mat->contains(i1, i2)){
+                    top = mat->at(i1, i2);
+                }else{
+                    std::cerr << "Error: Index out of bounds for matrix <" << in->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+                    exit(0);
+                }
+                break;
+            }
+            case MathCode::DICT:
+                top = dictGet(reinterpret_cast<Dict<T>*>(in->variable), top);
+                break;
+            case MathCode::TYPED: {
+                auto array = reinterpret_cast<TypedArray*>(in->variable);
+                if(array->matrix){
+                    auto i2 = (int)top;
+                    auto i1 = (int)stack[sp--];
+                    if(array->contains(i1, i2)){
+                        top = array->load<T>(i1 * array->cols + i2);
+                    }else{
+                        std::cerr << "Error: Index out of bounds for matrix <" << in->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+                        exit(0);
+                    }
+                }else{
+                    auto i = (int)top;
+                    if(array->contains(i)){
+                        top = array->load<T>(i);
+                    }else{
+                        std::cerr << "Error: Index out of bounds for list <" << in->variable << "> at index <" << i << ">." << std::endl;
+                        exit(0);
+                    }
+                }
+                break;
+            }
+            case MathCode::SPARSE: {
+                auto sparse = reinterpret_cast<SparseMatrix<T>*>(in->variable);
+                auto i2 = (int)top;
+                auto i1 = (int)stack[sp--];
+                if(sparse->contains(i1, i2)){
+                    top = sparse->at(i1, i2);
+                }else{
+                    std::cerr << "Error: Index out of bounds for matrix <" << in->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+                    exit(0);
+                }
+                break;
+            }
+            case MathCode::BITS: {
+                auto bits = reinterpret_cast<BitMatrix*>(in->variable);
+                auto i2 = (int)top;
+                auto i1 = (int)stack[sp--];
+                if(bits->contains(i1, i2)){
+                    top = bits->get(i1, i2);
+                }else{
+                    std::cerr << "Error: Index out of bounds for matrix <" << in->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+                    exit(0);
+                }
+                break;
+            }
+            case MathCode::ADD: top = stack[sp--] + top; break;
+            case MathCode::SUB: top = stack[sp--] - top; break;
+            case MathCode::MULT: top = stack[sp--] * top; break;
+            case MathCode::DIV: top = stack[sp--] / top; break;
+            case MathCode::MOD: top = fmod(stack[sp--], top); break;
+            case MathCode::EXP: top = pow(stack[sp--], top); break;
+            case MathCode::EQ: top = stack[sp--] == top; break;
+            case MathCode::NEQ: top = stack[sp--] != top; break;
+            case MathCode::LARGER: top = stack[sp--] > top; break;
+            case MathCode::LARGEREQ: top = stack[sp--] >= top; break;
+            case MathCode::LESS: top = stack[sp--] < top; break;
+            case MathCode::LESSEQ: top = stack[sp--] <= top; break;
+            case MathCode::ADDP: top = top + *(T*)in->variable; break;
+            case MathCode::SUBP: top = top - *(T*)in->variable; break;
+            case MathCode::MULTP: top = top * *(T*)in->variable; break;
+            case MathCode::DIVP: top = top / *(T*)in->variable; break;
+            case MathCode::MODP: top = fmod(top, *(T*)in->variable); break;
+            case MathCode::EXPP: top = pow(top, *(T*)in->variable); break;
+            case MathCode::EQP: top = top == *(T*)in->variable; break;
+            case MathCode::NEQP: top = top != *(T*)in->variable; break;
+            case MathCode::LARGERP: top = top > *(T*)in->variable; break;
+            case MathCode::LARGEREQP: top = top >= *(T*)in->variable; break;
+            case MathCode::LESSP: top = top < *(T*)in->variable; break;
+            case MathCode::LESSEQP: top = top <= *(T*)in->variable; break;
+            case MathCode::ANDJ:
+                // short circuit: keep 0 as result of the whole AND, otherwise evaluate the right side
+                if(!(top > 0)){
+                    top = 0;
+                    in = code + in->jump - 1;
+                }else{
+                    top = stack[sp--];
+                }
+                break;
+            case MathCode::ORJ:
+                if(top > 0){
+                    top = 1;
+                    in = code + in->jump - 1;
+                }else{
+                    top = stack[sp--];
+                }
+                break;
+            case MathCode::TRUTH:
+                top = top > 0;
+                break;
+        }
+    }
+    return top;
+}
+
+template<typename T>
+T calculateExpression(MathNode* root){
+    if(root->program != nullptr){
+        auto program = (MathProgram<T>*)root->program;
+        if constexpr (std::is_same<T, long double>::value){
+            // the JIT emits x87 code and only supports long double
+            if(program->native != nullptr){
+                return program->native();
+            }
+            if(jit_enabled && program->hits >= 0 && ++program->hits >= JIT_THRESHOLD){
+                if(jitCompileExpression(program)){
+                    return program->native();
+                }
+                program->hits = -1; // never try again
+            }
+        }
+        return calculateProgram(program);
+    }
+    if(root->type == MathNodeType::Constant){
+        return (T)root->constant;
+    }else if(root->type == MathNodeType::Variable) {
+        return *((T*)root->variable);
+    }else if(root->type == MathNodeType::Operator){
+        if(root->opt == MathOperatorType::PLUS){
+            return calculateExpression<T>(root->left) + calculateExpression<T>(root->right);
+        }else if(root->opt == MathOperatorType::MINUS){
+            return calculateExpression<T>(root->left) - calculateExpression<T>(root->right);
+        }else if(root->opt == MathOperatorType::DIV){
+            return calculateExpression<T>(root->left) / calculateExpression<T>(root->right);
+        }else if(root->opt == MathOperatorType::MULT){
+            return calculateExpression<T>(root->left) * calculateExpression<T>(root->right);
+        }else if(root->opt == MathOperatorType::MOD){
+            return fmod(calculateExpression<T>(root->left), calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::EXP){
+            return pow(calculateExpression<T>(root->left),calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::AND) {
+            return (calculateExpression<T>(root->left) > 0 && calculateExpression<T>(root->right) > 0);
+        }else if(root->opt == MathOperatorType::OR) {
+            return (calculateExpression<T>(root->left) > 0 || calculateExpression<T>(root->right) > 0);
+        }else if(root->opt == MathOperatorType::EQ){
+            return (calculateExpression<T>(root->left) == calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::NEQ){
+            return (calculateExpression<T>(root->left) != calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::LARGEREQ){
+            return (calculateExpression<T>(root->left) >= calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::LESSEQ){
+            return (calculateExpression<T>(root->left) <= calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::LARGER){
+            return (calculateExpression<T>(root->left) > calculateExpression<T>(root->right));
+        }else if(root->opt == MathOperatorType::LESS) {
+            return (calculateExpression<T>(root->left) < calculateExpression<T>(root->right));
+        }
+    }else if(root->type == MathNodeType::Array) {
+        auto list = reinterpret_cast<std::vector<T>*>(root->variable);
+        auto i = (int)(calculateExpression<T>(root->left));
+        if(list->size() > i){
+            return (*list)[i];
+        }else{
+            std::cerr << "Error: Index out of bounds for list <" << root->variable << "> at index <" << i << ">." << std::endl;
+            exit(0);
+        }
+    }else if(root->type == MathNodeType::Matrix) {
+        auto mat = reinterpret_cast<Matrix<T>*>(root->variable);
+        auto i1 = (int)(calculateExpression<T>(root->left));
+        auto i2 = (int)(calculateExpression<T>(root->right));
+        if(mat->contains(i1, i2)){
+            return mat->at(i1, i2);
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << root->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
+    }else if(root->type == MathNodeType::Dict) {
+        return dictGet(reinterpret_cast<Dict<T>*>(root->variable), calculateExpression<T>(root->left));
+    }else if(root->type == MathNodeType::Typed) {
+        auto array = reinterpret_cast<TypedArray*>(root->variable);
+        auto i1 = (int)(calculateExpression<T>(root->left));
+        if(!array->matrix){
+            if(array->contains(i1)){
+                return array->load<T>(i1);
+            }
+            std::cerr << "Error: Index out of bounds for list <" << root->variable << "> at index <" << i1 << ">." << std::endl;
+            exit(0);
+        }
+        auto i2 = (int)(calculateExpression<T>(root->right));
+        if(array->contains(i1, i2)){
+            return array->load<T>(i1 * array->cols + i2);
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << root->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
+    }else if(root->type == MathNodeType::Sparse) {
+        auto sparse = reinterpret_cast<SparseMatrix<T>*>(root->variable);
+        auto i1 = (int)(calculateExpression<T>(root->left));
+        auto i2 = (int)(calculateExpression<T>(root->right));
+        if(sparse->contains(i1, i2)){
+            return sparse->at(i1, i2);
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << root->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
+    }else if(root->type == MathNodeType::BitMatrix) {
+        auto bits = reinterpret_cast<BitMatrix*>(root->variable);
+        auto i1 = (int)(calculateExpression<T>(root->left));
+        auto i2 = (int)(calculateExpression<T>(root->right));
+        if(bits->contains(i1, i2)){
+            return bits->get(i1, i2);
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << root->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
+    }
+    return 0;
+}
+
+inline void replace_special_operators(std::string& input) {
+    size_t pos = 0;
+    while ((pos = input.find("<=", pos)) != std::string::npos) {
+        input.replace(pos, 2, 1, (char)0x1d);
+        pos += 1;
+    }
+    pos = 0;
+    while ((pos = input.find(">=", pos)) != std::string::npos) {
+        input.replace(pos, 2, 1, (char)0x1e);
+        pos += 1;
+    }
+    pos = 0;
+    while ((pos = input.find("!=", pos)) != std::string::npos) {
+        input.replace(pos, 2, 1, (char)0x1f);
+        pos += 1;
+    }
+}
+
+std::string getOperator(MathOperatorType type){
+    if(type == MathOperatorType::PLUS){
+        return "ADD";
+    }else if(type == MathOperatorType::MINUS){
+        return "SUB";
+    }else if(type == MathOperatorType::MULT){
+        return "MULT";
+    }else if(type == MathOperatorType::DIV){
+        return "DIV";
+    }else if(type == MathOperatorType::MOD){
+        return "MOD";
+    }else if(type == MathOperatorType::EXP){
+        return "EXP";
+    }else if(type == MathOperatorType::AND){
+        return "AND";
+    }else if(type == MathOperatorType::OR){
+        return "OR";
+    }else if(type == MathOperatorType::EQ){
+        return "EQ";
+    }else if(type == MathOperatorType::LARGER){
+        return "LARGER";
+    }else if(type == MathOperatorType::LESS){
+        return "LESS";
+    }else if(type == MathOperatorType::NEQ){
+        return "UNEQUAL";
+    }else if(type == MathOperatorType::LESSEQ){
+        return "LESSQ";
+    }else if(type == MathOperatorType::LARGEREQ){
+        return "LARGERQ";
+    }
+    return "";
+}
+
+MathOperatorType getOperatorType(const char c){
+        if(c == '+'){
+            return MathOperatorType::PLUS;
+        }else if (c == '-'){
+            return MathOperatorType::MINUS;
+        }else if (c == '*'){
+            return MathOperatorType::MULT;
+        }else if (c == '/'){
+            return MathOperatorType::DIV;
+        }else if (c == '%'){
+            return MathOperatorType::MOD;
+        }else if (c == '^'){
+            return MathOperatorType::EXP;
+        }else if (c == '&'){
+            return MathOperatorType::AND;
+        }else if (c == '|'){
+            return MathOperatorType::OR;
+        }else if (c == '='){
+            return MathOperatorType::EQ;
+        }else if (c == '>'){
+            return MathOperatorType::LARGER;
+        }else if (c == '<'){
+            return MathOperatorType::LESS;
+        }else if (c == 0x1f){
+            return MathOperatorType::NEQ;
+        }else if (c == 0x1d){
+            return MathOperatorType::LESSEQ;
+        }else if (c == 0x1e){
+            return MathOperatorType::LARGEREQ;
+        }
+        return MathOperatorType::NOTSET;
+}
+
+//! Get the Type of a Comparison Operator Written as Separate Token (=, !=, <, <=, >, >=)
+MathOperatorType getComparisonType(const std::string& op){
+    if(op == "=" || op == "=="){
+        return MathOperatorType::EQ;
+    }else if(op == "!="){
+        return MathOperatorType::NEQ;
+    }else if(op == "<"){
+        return MathOperatorType::LESS;
+    }else if(op == "<="){
+        return MathOperatorType::LESSEQ;
+    }else if(op == ">"){
+        return MathOperatorType::LARGER;
+    }else if(op == ">="){
+        return MathOperatorType::LARGEREQ;
+    }
+    return MathOperatorType::NOTSET;
+}
+
+template<typename T>
+void optimizeExpression(MathNode* root){
+
+    if(root->left != nullptr){ // Recurse the entire tree
+        optimizeExpression<T>(root->left);
+    }
+    if(root->right != nullptr){
+        optimizeExpression<T>(root->right);
+    }
+    if(root->otherwise != nullptr){
+        optimizeExpression<T>(root->otherwise);
+    }
+
+    // Simplify constant expressions
+    if(root->type == MathNodeType::Operator && root->left->type == MathNodeType::Constant && root->right->type == MathNodeType::Constant){
+        // Replace operator node with constant node
+        root->constant = calculateExpression<T>(root);
+        root->type = MathNodeType::Constant;
+        root->left = nullptr;
+        root->right = nullptr;
+        root->opt = MathOperatorType::NOTSET;
+    }
+
+    // Simplify multiplication by 0 or 1
+    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::MULT){
+        if(root->left->type == MathNodeType::Constant){
+            if(root->left->constant == 0.0){
+                // Multiplication by 0
+                root->type = MathNodeType::Constant;
+                root->constant = 0.0;
+                root->left = nullptr;
+                root->right = nullptr;
+                root->opt = MathOperatorType::NOTSET;
+            }else if(root->left->constant == 1.0){
+                // Multiplication by 1
+                MathNode* newRoot = root->right;
+                *root = *newRoot;
+                delete newRoot;
+            }
+        }else if(root->right->type == MathNodeType::Constant){
+            if(root->right->constant == 0.0){
+                // Multiplication by 0
+                root->type = MathNodeType::Constant;
+                root->constant = 0.0;
+                root->left = nullptr;
+                root->right = nullptr;
+                root->opt = MathOperatorType::NOTSET;
+            }else if(root->right->constant == 1.0){
+                // Multiplication by 1
+                MathNode* newRoot = root->left;
+                *root = *newRoot;
+                delete newRoot;
+            }
+        }
+    }
+    // Simplify addition or subtraction with 0
+    if(root->type == MathNodeType::Operator && (root->opt == MathOperatorType::PLUS || root->opt == MathOperatorType::MINUS)){
+        if(root->opt == MathOperatorType::PLUS && root->left->type == MathNodeType::Constant && root->left->constant == 0.0){
+            // Addition of 0 (0 - x is not simplified)
+            MathNode* newRoot = root->right;
+            *root = *newRoot;
+            delete newRoot;
+        }
+        else if(root->right->type == MathNodeType::Constant && root->right->constant == 0.0){
+            // Addition or subtraction with 0
+            MathNode* newRoot = root->left;
+            *root = *newRoot;
+            delete newRoot;
+        }
+    }
+
+    // Simplify multiplication by -1
+    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::MULT){
+        if(root->left->type == MathNodeType::Constant && root->left->constant == -1.0){
+            // Multiplication by -1
+            MathNode* newRoot = root->right;
+            root->type = MathNodeType::Operator;
+            root->opt = MathOperatorType::MINUS;
+            root->left = new MathNode(MathNodeType::Constant, 0.0);
+            root->right = newRoot;
+        }
+        else if(root->right->type == MathNodeType::Constant && root->right->constant == -1.0){
+            // Multiplication by -1
+            MathNode* newRoot = root->left;
+            root->type = MathNodeType::Operator;
+            root->opt = MathOperatorType::MINUS;
+            root->left = new MathNode(MathNodeType::Constant, 0.0);
+            root->right = newRoot;
+        }
+    }
+
+    // Simplify division by 1
+    if(root->type == MathNodeType::Operator && root->opt == MathOperatorType::DIV){
+        if(root->right->type == MathNodeType::Constant && root->right->constant == 1.0){
+            // Division by 1
+            MathNode* newRoot = root->left;
+            *root = *newRoot;
+            delete newRoot;
+        }
+    }
+}
+
+inline MathCode getMathCode(MathOperatorType type, bool pointer){
+    switch(type){
+        case MathOperatorType::PLUS: return pointer ? MathCode::ADDP : MathCode::ADD;
+        case MathOperatorType::MINUS: return pointer ? MathCode::SUBP : MathCode::SUB;
+        case MathOperatorType::MULT: return pointer ? MathCode::MULTP : MathCode::MULT;
+        case MathOperatorType::DIV: return pointer ? MathCode::DIVP : MathCode::DIV;
+        case MathOperatorType::MOD: return pointer ? MathCode::MODP : MathCode::MOD;
+        case MathOperatorType::EXP: return pointer ? MathCode::EXPP : MathCode::EXP;
+        case MathOperatorType::EQ: return pointer ? MathCode::EQP : MathCode::EQ;
+        case MathOperatorType::NEQ: return pointer ? MathCode::NEQP : MathCode::NEQ;
+        case MathOperatorType::LARGER: return pointer ? MathCode::LARGERP : MathCode::LARGER;
+        case MathOperatorType::LARGEREQ: return pointer ? MathCode::LARGEREQP : MathCode::LARGEREQ;
+        case MathOperatorType::LESS: return pointer ? MathCode::LESSP : MathCode::LESS;
+        default: return pointer ? MathCode::LESSEQP : MathCode::LESSEQ;
+    }
+}
+
+inline bool isLeaf(MathNode* node){
+    return node->type == MathNodeType::Constant || node->type == MathNodeType::Variable;
+}
+
+// Count the constants of a subtree (their copies in the program must not be reallocated while flattening)
+int countConstants(MathNode* node){
+    if(node->type == MathNodeType::Constant){
+        return 1;
+    }
+    return (node->left != nullptr ? countConstants(node->left) : 0) + (node->right != nullptr ? countConstants(node->right) : 0);
+}
+
+// Pointer to the value of a leaf; constants are copied into the program in its precision
+template<typename T>
+inline void* getLeafPointer(MathNode* node, MathProgram<T>* program){
+    if(node->type == MathNodeType::Constant){
+        program->constants.push_back((T)node->constant);
+        return &program->constants.back();
+    }
+    return node->variable;
+}
+
+// Append the postfix code of a subtree; sp is the stack size before the subtree, returns the maximum stack size
+template<typename T>
+int flattenNode(MathNode* node, MathProgram<T>* program, int sp){
+    std::vector<MathInstr>& code = program->code;
+    int depth;
+    switch(node->type){
+        case MathNodeType::Constant:
+        case MathNodeType::Variable:
+            code.push_back(MathInstr{MathCode::PUSH, 0, getLeafPointer(node, program)});
+            return sp + 1;
+        case MathNodeType::Array:
+            depth = flattenNode(node->left, program, sp);
+            code.push_back(MathInstr{MathCode::LIST, 0, node->variable});
+            return depth;
+        case MathNodeType::Dict:
+            depth = flattenNode(node->left, program, sp);
+            code.push_back(MathInstr{MathCode::DICT, 0, node->variable});
+            return depth;
+        case MathNodeType::Matrix:
+            depth = flattenNode(node->left, program, sp);
+            depth = std::max(depth, flattenNode(node->right, program, sp + 1));
+            code.push_back(MathInstr{MathCode::MAT, 0, node->variable});
+            return depth;
+        case MathNodeType::Typed:
+            depth = flattenNode(node->left, program, sp);
+            if(node->right != nullptr){
+                depth = std::max(depth, flattenNode(node->right, program, sp + 1));
+            }
+            code.push_back(MathInstr{MathCode::TYPED, 0, node->variable});
+            return depth;
+        case MathNodeType::BitMatrix:
+            depth = flattenNode(node->left, program, sp);
+            depth = std::max(depth, flattenNode(node->right, program, sp + 1));
+            code.push_back(MathInstr{MathCode::BITS, 0, node->variable});
+            return depth;
+        case MathNodeType::Sparse:
+            depth = flattenNode(node->left, program, sp);
+            depth = std::max(depth, flattenNode(node->right, program, sp + 1));
+            code.push_back(MathInstr{MathCode::SPARSE, 0, node->variable});
+            return depth;
+        case MathNodeType::Operator:
+            if(node->opt == MathOperatorType::AND || node->opt == MathOperatorType::OR){
+                depth = flattenNode(node->left, program, sp);
+                size_t jump = code.size();
+                code.push_back(MathInstr{node->opt == MathOperatorType::AND ? MathCode::ANDJ : MathCode::ORJ, 0, nullptr});
+                depth = std::max(depth, flattenNode(node->right, program, sp));
+                code.push_back(MathInstr{MathCode::TRUTH, 0, nullptr});
+                code[jump].jump = (int)code.size();
+                return depth;
+            }else if(isLeaf(node->right)){
+                // fuse the load of a constant or variable into the operator
+                depth = flattenNode(node->left, program, sp);
+                code.push_back(MathInstr{getMathCode(node->opt, true), 0, getLeafPointer(node->right, program)});
+                return depth;
+            }
+            depth = flattenNode(node->left, program, sp);
+            depth = std::max(depth, flattenNode(node->right, program, sp + 1));
+            code.push_back(MathInstr{getMathCode(node->opt, false), 0, nullptr});
+            return depth;
+        case MathNodeType::WholeList:
+        case MathNodeType::WholeMatrix:
+        case MathNodeType::Select:
+            // the callers only flatten scalar expressions; whole-array expressions are compiled by compileArrayExpression
+            std::cerr << "Error: whole lists, matrices and where() can only be assigned to a whole list or matrix with set." << std::endl;
+            exit(0);
+    }
+    return sp;
+}
+
+template<typename T>
+void flattenExpression(MathNode* root){
+    if(isLeaf(root)){
+        return; // constants and variables are already evaluated without recursion
+    }
+    auto program = new MathProgram<T>;
+    program->constants.reserve(countConstants(root));
+    program->depth = flattenNode(root, program, 0);
+    if(program->depth > MATH_STACK_SIZE){
+        delete program; // keep the recursive evaluation for very deep expressions
+        return;
+    }
+    root->program = program;
+}
+
+bool checkExpression(const std::string& expr){
+    int brackets = 0;
+    int sqbrackets = 0;
+    for(char i : expr){
+        if(i == '('){
+            brackets += 1;
+        }else if(i == ')'){
+            brackets -= 1;
+        }else if(i == '['){
+            sqbrackets += 1;
+        }else if(i == ']'){
+            sqbrackets -= 1;
+        }else if(!(i == ' ' || i == '.' || i == '_' || i == ',' || isdigit(i) || isalpha(i) || isOperator(i))){
+            return false;
+        }
+    }
+    if(brackets != 0 || sqbrackets != 0){
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+MathNode* mathparse(const std::string& expr){
+    if(checkExpression(expr)) {
+        std::string expr_ws = removeSpaces(expr);
+        replace_special_operators(expr_ws);
+        MathNode* expression = parseExpressionRaw<T>(expr_ws);
+        if(usesWholeArrays(expression)){
+            std::cerr << "Error: <" << expr << "> whole lists, matrices and where() can only be assigned to a whole list or matrix with set." << std::endl;
+            exit(0);
+        }
+        optimizeExpression<T>(expression);
+        flattenExpression<T>(expression);
+        return expression;
+    }else{
+        std::cerr << "Error: <" << expr << "> expression is incorrect." << std::endl;
+        exit(0);
+    }
+}
+
+template<typename T>
+MathNode* varparse(const std::string& expr){
+    if(checkExpression(expr)) {
+        std::string expr_ws = removeSpaces(expr);
+        replace_special_operators(expr_ws);
+        MathNode* expression = parseExpressionRaw<T>(expr_ws);
+        optimizeExpression<T>(expression);
+        if((expression->type == MathNodeType::Array || expression->type == MathNodeType::Variable || expression->type == MathNodeType::Matrix || expression->type == MathNodeType::BitMatrix
+            || expression->type == MathNodeType::Typed) && !usesWholeArrays(expression)){
+            // the indices are evaluated separately by getVarListEntry() and setVarListEntry()
+            if(expression->left != nullptr){ flattenExpression<T>(expression->left); }
+            if(expression->right != nullptr){ flattenExpression<T>(expression->right); }
+            return expression;
+        }
+        if(expression->type == MathNodeType::Dict){
+            std::cerr << "Error: <" << expr << "> entries of a dictionary are set with dset." << std::endl;
+            exit(0);
+        }
+        if(expression->type == MathNodeType::Sparse){
+            std::cerr << "Error: <" << expr << "> entries of a sparse matrix are set with csparse." << std::endl;
+            exit(0);
+        }
+        std::cerr << "Error: <" << expr << "> must be only a variable or list entry." << std::endl;
+        exit(0);
+    }else{
+        std::cerr << "Error: <" << expr << "> variable or list entry are incorrect." << std::endl;
+        exit(0);
+    }
+}
+
+template<typename T>
+MathNode* arrayparse(const std::string& expr){
+    if(checkExpression(expr)) {
+        std::string expr_ws = removeSpaces(expr);
+        replace_special_operators(expr_ws);
+        MathNode* expression = parseExpressionRaw<T>(expr_ws);
+        optimizeExpression<T>(expression);
+        return expression; // the scalar subtrees are flattened by compileArrayExpression()
+    }else{
+        std::cerr << "Error: <" << expr << "> expression is incorrect." << std::endl;
+        exit(0);
+    }
+}
+
+// WHOLE-ARRAY EXPRESSIONS ##########################################################
+
+//! Check Whether a Subtree Contains a Whole List, a Whole Matrix or where()
+bool usesWholeArrays(MathNode* node){
+    if(node->type == MathNodeType::WholeList || node->type == MathNodeType::WholeMatrix || node->type == MathNodeType::Select){
+        return true;
+    }
+    return (node->left != nullptr && usesWholeArrays(node->left)) || (node->right != nullptr && usesWholeArrays(node->right)) || (node->otherwise != nullptr && usesWholeArrays(node->otherwise));
+}
+
+inline ArrayCode getArrayCode(MathOperatorType type){
+    switch(type){
+        case MathOperatorType::PLUS: return ArrayCode::ADD;
+        case MathOperatorType::MINUS: return ArrayCode::SUB;
+        case MathOperatorType::MULT: return ArrayCode::MULT;
+        case MathOperatorType::DIV: return ArrayCode::DIV;
+        case MathOperatorType::MOD: return ArrayCode::MOD;
+        case MathOperatorType::EXP: return ArrayCode::EXP;
+        case MathOperatorType::AND: return ArrayCode::AND;
+        case MathOperatorType::OR: return ArrayCode::OR;
+        case MathOperatorType::EQ: return ArrayCode::EQ;
+        case MathOperatorType::NEQ: return ArrayCode::NEQ;
+        case MathOperatorType::LARGER: return ArrayCode::LARGER;
+        case MathOperatorType::LARGEREQ: return ArrayCode::LARGEREQ;
+        case MathOperatorType::LESS: return ArrayCode::LESS;
+        default: return ArrayCode::LESSEQ;
+    }
+}
+
+// Append the postfix code of a subtree; subtrees without whole arrays are evaluated once (SCALAR), returns the maximum stack size
+template<typename T>
+int compileArrayNode(MathNode* node, ArrayProgram<T>* program, int sp){
+    int depth;
+    if(!usesWholeArrays(node)){
+        flattenExpression<T>(node);
+        program->code.push_back(ArrayInstr{ArrayCode::SCALAR, program->scalars++, node});
+        return sp + 1;
+    }
+    switch(node->type){
+        case MathNodeType::WholeList:
+        case MathNodeType::WholeMatrix:
+            if((node->type == MathNodeType::WholeMatrix) != program->matrix){
+                std::cerr << "Error: <" << node->variable << "> lists and matrices cannot be mixed in one expression." << std::endl;
+                exit(0);
+            }
+            if(std::find(program->operands.begin(), program->operands.end(), node->variable) == program->operands.end()){
+                program->operands.push_back(node->variable);
+            }
+            program->code.push_back(ArrayInstr{ArrayCode::LOAD, 0, node});
+            return sp + 1;
+        case MathNodeType::Operator:
+            depth = compileArrayNode(node->left, program, sp);
+            depth = std::max(depth, compileArrayNode(node->right, program, sp + 1));
+            program->code.push_back(ArrayInstr{getArrayCode(node->opt), 0, nullptr});
+            return depth;
+        case MathNodeType::Select:
+            depth = compileArrayNode(node->left, program, sp);
+            depth = std::max(depth, compileArrayNode(node->right, program, sp + 1));
+            depth = std::max(depth, compileArrayNode(node->otherwise, program, sp + 2));
+            program->code.push_back(ArrayInstr{ArrayCode::SELECT, 0, nullptr});
+            return depth;
+        default:
+            std::cerr << "Error: <" << node->variable << "> indices must not contain whole lists or matrices." << std::endl;
+            exit(0);
+    }
+}
+
+template<typename T>
+ArrayProgram<T>* compileArrayExpression(MathNode* root, bool matrix){
+    auto program = new ArrayProgram<T>;
+    program->matrix = matrix;
+    program->depth = compileArrayNode(root, program, 0);
+    return program;
+}
+
+// Operand of a block operation: data == nullptr means the same value for all entries
+template<typename T>
+struct ArraySlot {
+    const T* data;
+    T value;
+};
+
+struct ArrayMod { template<typename T> static T apply(T a, T b){ return fmod(a, b); } };
+struct ArrayExp { template<typename T> static T apply(T a, T b){ return pow(a, b); } };
+struct ArrayAnd { template<typename T> static T apply(T a, T b){ return a > 0 && b > 0; } };
+struct ArrayOr { template<typename T> static T apply(T a, T b){ return a > 0 || b > 0; } };
+
+//! Elementwise Operation of Two Blocks (at Least One of Them is not a Single Value)
+template<typename Op, typename T>
+void blockOperation(const ArraySlot<T>& a, const ArraySlot<T>& b, T* out, size_t n){
+    if(a.data != nullptr && b.data != nullptr){
+        for(size_t k = 0; k < n; k++){
+            out[k] = Op::apply(a.data[k], b.data[k]);
+        }
+    }else if(a.data != nullptr){
+        for(size_t k = 0; k < n; k++){
+            out[k] = Op::apply(a.data[k], b.value);
+        }
+    }else{
+        for(size_t k = 0; k < n; k++){
+            out[k] = Op::apply(a.value, b.data[k]);
+        }
+    }
+}
+
+//! Elementwise Operation of Two Blocks With the SIMD Kernels of Kernels.h
+template<typename Op, typename T>
+void blockKernel(const ArraySlot<T>& a, const ArraySlot<T>& b, T* out, size_t n){
+    if(a.data != nullptr && b.data != nullptr){
+        kernelBinary<Op>(a.data, b.data, out, n);
+    }else if(a.data != nullptr){
+        kernelBinaryScalar<Op>(a.data, b.value, out, n);
+    }else{
+        blockOperation<Op>(a, b, out, n);
+    }
+}
+
+//! Evaluate the Program for n Entries of a Row Starting at Column start; Returns the Result Block
+template<typename T>
+ArraySlot<T> runArrayBlock(const ArrayProgram<T>* program, const T* values, ArraySlot<T>* slots, T* blocks, size_t row, size_t start, size_t n){
+    int sp = -1;
+    for(const ArrayInstr& in : program->code){
+        if(in.code == ArrayCode::SCALAR){
+            slots[++sp] = ArraySlot<T>{nullptr, values[in.index]};
+            continue;
+        }else if(in.code == ArrayCode::LOAD){
+            const T* data = program->matrix ? ((Matrix<T>*)in.node->variable)->row(row) : ((std::vector<T>*)in.node->variable)->data();
+            slots[++sp] = ArraySlot<T>{data + start, 0};
+            continue;
+        }else if(in.code == ArrayCode::SELECT){
+            sp -= 2;
+            const ArraySlot<T>& mask = slots[sp];
+            const ArraySlot<T>& x = slots[sp + 1];
+            const ArraySlot<T>& y = slots[sp + 2];
+            T* out = blocks + sp * ARRAY_BLOCK;
+            if(mask.data == nullptr){
+                // a block on the stack must stay at its own position, so the chosen block is copied
+                ArraySlot<T> chosen = mask.value > 0 ? x : y;
+                if(chosen.data != nullptr){
+                    std::copy(chosen.data, chosen.data + n, out);
+                    chosen.data = out;
+                }
+                slots[sp] = chosen;
+                continue;
+            }
+            if(x.data != nullptr && y.data != nullptr){
+                for(size_t k = 0; k < n; k++){
+                    out[k] = mask.data[k] > 0 ? x.data[k] : y.data[k];
+                }
+            }else{
+                for(size_t k = 0; k < n; k++){
+                    out[k] = mask.data[k] > 0 ? (x.data != nullptr ? x.data[k] : x.value) : (y.data != nullptr ? y.data[k] : y.value);
+                }
+            }
+            slots[sp] = ArraySlot<T>{out, 0};
+            continue;
+        }
+        const ArraySlot<T> b = slots[sp--];
+        ArraySlot<T> a = slots[sp];
+        T single; // result if both operands are single values (only possible below a where() with a single value as mask)
+        bool isSingle = a.data == nullptr && b.data == nullptr;
+        if(isSingle){
+            a.data = &a.value;
+        }
+        size_t count = isSingle ? 1 : n;
+        T* out = isSingle ? &single : blocks + sp * ARRAY_BLOCK;
+        switch(in.code){
+            case ArrayCode::ADD: blockKernel<KernelAdd>(a, b, out, count); break;
+            case ArrayCode::SUB: blockKernel<KernelSub>(a, b, out, count); break;
+            case ArrayCode::MULT: blockKernel<KernelMul>(a, b, out, count); break;
+            case ArrayCode::DIV: blockKernel<KernelDiv>(a, b, out, count); break;
+            case ArrayCode::MOD: blockOperation<ArrayMod>(a, b, out, count); break;
+            case ArrayCode::EXP: blockOperation<ArrayExp>(a, b, out, count); break;
+            case ArrayCode::AND: blockOperation<ArrayAnd>(a, b, out, count); break;
+            case ArrayCode::OR: blockOperation<ArrayOr>(a, b, out, count); break;
+            case ArrayCode::EQ: blockKernel<KernelEq>(a, b, out, count); break;
+            case ArrayCode::NEQ: blockKernel<KernelNeq>(a, b, out, count); break;
+            case ArrayCode::LARGER: blockKernel<KernelLarger>(a, b, out, count); break;
+            case ArrayCode::LARGEREQ: blockKernel<KernelLargerEq>(a, b, out, count); break;
+            case ArrayCode::LESS: blockKernel<KernelLess>(a, b, out, count); break;
+            default: blockKernel<KernelLessEq>(a, b, out, count); break;
+        }
+        if(isSingle){
+            slots[sp] = ArraySlot<T>{nullptr, single};
+            continue;
+        }
+        slots[sp] = ArraySlot<T>{out, 0};
+    }
+    return slots[0];
+}
+template<typename T>
+void assignArrayExpression(const ArrayProgram<T>* program, void* target){
+    // the operands determine the size of the target; without operands the target keeps its size
+    size_t rows = 1;
+    size_t cols;
+    if(program->matrix){
+        auto first = (Matrix<T>*)(program->operands.empty() ? target : program->operands[0]);
+        for(void* operand : program->operands){
+            checkSameDimensions(first, (Matrix<T>*)operand);
+        }
+        shapeLike((Matrix<T>*)target, first);
+        rows = first->rows;
+        cols = first->cols;
+    }else{
+        auto first = (std::vector<T>*)(program->operands.empty() ? target : program->operands[0]);
+        for(void* operand : program->operands){
+            checkSameLength(first, (std::vector<T>*)operand);
+        }
+        cols = first->size();
+        ((std::vector<T>*)target)->resize(cols);
+    }
+
+    // subtrees without whole arrays are evaluated once, the rest block by block without temporary arrays
+    static thread_local std::vector<T> values;
+    static thread_local std::vector<ArraySlot<T> > slots;
+    static thread_local std::vector<T> blocks;
+    values.resize(program->scalars);
+    slots.resize(program->depth);
+    blocks.resize(program->depth * ARRAY_BLOCK);
+    for(const ArrayInstr& in : program->code){
+        if(in.code == ArrayCode::SCALAR){
+            values[in.index] = calculateExpression<T>(in.node);
+        }
+    }
+    for(size_t row = 0; row < rows; row++){
+        T* dst = program->matrix ? ((Matrix<T>*)target)->row(row) : ((std::vector<T>*)target)->data();
+        for(size_t start = 0; start < cols; start += ARRAY_BLOCK){
+            size_t n = std::min(ARRAY_BLOCK, cols - start);
+            ArraySlot<T> result = runArrayBlock(program, values.data(), slots.data(), blocks.data(), row, start, n);
+            if(result.data == nullptr){
+                std::fill(dst + start, dst + start + n, result.value);
+            }else if(result.data != dst + start){
+                std::copy(result.data, result.data + n, dst + start);
+            }
+        }
+    }
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template double calculateExpression<double>(MathNode* root);
+template long double calculateExpression<long double>(MathNode* root);
+template double calculateProgram<double>(const MathProgram<double>* program);
+template long double calculateProgram<long double>(const MathProgram<long double>* program);
+template void flattenExpression<double>(MathNode* root);
+template void flattenExpression<long double>(MathNode* root);
+template MathNode* mathparse<double>(const std::string& expr);
+template MathNode* mathparse<long double>(const std::string& expr);
+template MathNode* varparse<double>(const std::string& expr);
+template MathNode* varparse<long double>(const std::string& expr);
+template MathNode* arrayparse<double>(const std::string& expr);
+template MathNode* arrayparse<long double>(const std::string& expr);
+template ArrayProgram<double>* compileArrayExpression<double>(MathNode* root, bool matrix);
+template ArrayProgram<long double>* compileArrayExpression<long double>(MathNode* root, bool matrix);
+template void assignArrayExpression<double>(const ArrayProgram<double>* program, void* target);
+template void assignArrayExpression<long double>(const ArrayProgram<long double>* program, void* target);
@@ -0,0 +1,224 @@
+#pragma once
+#ifndef SQBRA_MATRIX_H
+#define SQBRA_MATRIX_H
+
+/*
+ *  MATRIX.H
+ *  This file declares the matrix type of the SquareBracket language (for both precisions of the interpreter).
+ *  All entries live in one aligned row-major buffer; every row starts on a cache line boundary.
+ *  A view (mview) owns no buffer: it shows a block of the entries of another matrix with the stride of that matrix.
+ *  The matrix keeps a list of its views and empties them when its buffer is freed, so a view never points to freed
+ *  entries; swapping two matrices moves the views with the buffers.
+ *  A file-backed matrix (mmat) maps a binary row-major file into memory instead of allocating a buffer (see Mapped.h).
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Names.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SQBRA_MMAP 1
+#endif
+
+const size_t MATRIX_ALIGNMENT = 64; // alignment of the buffer and of every row in bytes
+
+template<typename T>
+struct Matrix {
+    T* data = nullptr;
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t stride = 0; // number of elements between the starts of two consecutive rows
+    bool view = false;           // shows the entries of another matrix instead of owning a buffer
+    Matrix* base = nullptr;      // matrix whose buffer the view shows (nullptr if it shows nothing)
+    std::vector<Matrix*> views;  // views that show entries of this matrix
+    size_t mapped = 0;           // length of the file mapping in bytes (0 if the entries live on the heap)
+
+    Matrix() = default;
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+    ~Matrix(){
+        unbind();
+        detachViews();
+        release();
+    }
+
+    //! Pointer to the First Entry of a Row
+    T* row(size_t i){ return data + i * stride; }
+    const T* row(size_t i) const { return data + i * stride; }
+
+    //! Entry Without Bounds Check
+    T& at(size_t i, size_t j){ return data[i * stride + j]; }
+
+    //! Check Whether the Indices Address an Entry of the Matrix
+    bool contains(int i, int j) const { return i >= 0 && j >= 0 && (size_t)i < rows && (size_t)j < cols; }
+
+    //! Exchange the Entries and Dimensions with Another Matrix (O(1); Views Exchange Their Entries One by One)
+    void swap(Matrix& other){
+        if(view || other.view){
+            checkDimensions(other.rows, other.cols);
+            other.checkDimensions(rows, cols);
+            for(size_t i = 0; i < rows; i++){
+                std::swap_ranges(row(i), row(i) + cols, other.row(i));
+            }
+            return;
+        }
+        std::swap(data, other.data);
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(stride, other.stride);
+        std::swap(mapped, other.mapped);
+        views.swap(other.views);
+        for(Matrix* shown : views){ shown->base = this; }
+        for(Matrix* shown : other.views){ shown->base = &other; }
+    }
+
+    //! Check Whether two Matrices may Share Entries (a View and its Matrix, or two Views of the Same Matrix)
+    bool overlaps(const Matrix& other) const {
+        if(this == &other){
+            return true;
+        }
+        const Matrix* owner = view ? base : this;
+        const Matrix* otherOwner = other.view ? other.base : &other;
+        if(owner == nullptr || owner != otherOwner || rows == 0 || cols == 0 || other.rows == 0 || other.cols == 0){
+            return false;
+        }
+        return data < other.row(other.rows - 1) + other.cols && other.data < row(rows - 1) + cols;
+    }
+
+    //! Show rows x cols Entries of source Starting at Entry (i, j) (the Block has to Lie Inside source)
+    void show(Matrix& source, size_t i, size_t j, size_t newRows, size_t newCols){
+        Matrix* owner = source.view ? source.base : &source;
+        T* first = source.data == nullptr ? nullptr : source.row(i) + j;
+        size_t sourceStride = source.stride;
+        unbind();
+        if(owner != nullptr){
+            base = owner;
+            owner->views.push_back(this);
+        }
+        data = first;
+        rows = newRows;
+        cols = newCols;
+        stride = sourceStride;
+    }
+
+    //! Take the Entries of a File Mapping of bytes Bytes (Rows are not Padded, like in the File)
+    void adopt(T* entries, size_t newRows, size_t newCols, size_t bytes){
+        detachViews();
+        release();
+        data = entries;
+        rows = newRows;
+        cols = newCols;
+        stride = newCols;
+        mapped = bytes;
+    }
+
+    //! Tell the System that Rows first ... last - 1 of a File-Backed Matrix are Needed Soon or (done) not Needed Anymore
+    void adviseRows(size_t first, size_t last, bool done) const {
+#ifdef SQBRA_MMAP
+        const Matrix* owner = view ? base : this;
+        if(owner == nullptr || owner->mapped == 0 || first >= last){
+            return;
+        }
+        static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t begin = (size_t)(row(first) - owner->data) * sizeof(T) / page * page;
+        size_t end = std::min(((size_t)(row(last - 1) + cols - owner->data) * sizeof(T) + page - 1) / page * page, owner->mapped);
+        // dropping pages of a shared mapping loses nothing: changed pages stay in the page cache until they are written
+        madvise((char*)owner->data + begin, end - begin, done ? MADV_DONTNEED : MADV_WILLNEED);
+#else
+        (void)first; (void)last; (void)done;
+#endif
+    }
+
+    //! Change the Dimensions; Existing Entries Keep Their Position, New Entries are Zero
+    void resize(size_t newRows, size_t newCols){
+        if(view || mapped != 0){
+            checkDimensions(newRows, newCols);
+            return;
+        }
+        detachViews();
+        size_t newStride = paddedStride(newCols);
+        T* newData = allocate(newRows * newStride);
+        if(newData != nullptr){
+            std::memset((void*)newData, 0, newRows * newStride * sizeof(T));
+        }
+        for(size_t i = 0; i < rows && i < newRows; i++){
+            std::memcpy((void*)(newData + i * newStride), row(i), std::min(cols, newCols) * sizeof(T));
+        }
+        release();
+        data = newData;
+        rows = newRows;
+        cols = newCols;
+        stride = newStride;
+    }
+
+private:
+    //! Terminate if a View or File-Backed Matrix Would Need Other Dimensions
+    void checkDimensions(size_t newRows, size_t newCols) const {
+        if((view || mapped != 0) && (newRows != rows || newCols != cols)){
+            std::cerr << "Error: " << (view ? "view <" : "file-backed matrix <") << containerName(this) << "> of " << rows << "x" << cols << " entries can not change its dimensions to " << newRows << "x" << newCols << "." << std::endl;
+            exit(0);
+        }
+    }
+
+    //! Stop Showing the Entries of the Base Matrix
+    void unbind(){
+        if(base != nullptr){
+            base->views.erase(std::find(base->views.begin(), base->views.end(), this));
+            base = nullptr;
+        }
+        if(view){
+            data = nullptr;
+            rows = cols = stride = 0;
+        }
+    }
+
+    //! Empty all Views of this Matrix (Before its Buffer is Freed)
+    void detachViews(){
+        for(Matrix* shown : views){
+            shown->base = nullptr;
+            shown->data = nullptr;
+            shown->rows = shown->cols = shown->stride = 0;
+        }
+        views.clear();
+    }
+
+    //! Round the Row Length up so that Every Row Starts on an Aligned Address
+    static size_t paddedStride(size_t columns){
+        size_t perLine = MATRIX_ALIGNMENT / sizeof(T);
+        return (columns + perLine - 1) / perLine * perLine;
+    }
+
+    static T* allocate(size_t count){
+        if(count == 0){
+            return nullptr;
+        }
+        return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t(MATRIX_ALIGNMENT)));
+    }
+
+    void release(){
+#ifdef SQBRA_MMAP
+        if(mapped != 0){
+            munmap((void*)data, mapped);
+            data = nullptr;
+            mapped = 0;
+            return;
+        }
+#endif
+        if(data != nullptr && !view){
+            ::operator delete[](data, std::align_val_t(MATRIX_ALIGNMENT));
+            data = nullptr;
+        }
+    }
+};
+
+#endif //SQBRA_MATRIX_H
@@ -0,0 +1,34 @@
+#pragma once
+#ifndef SQBRA_NAMES_H
+#define SQBRA_NAMES_H
+
+/*
+ *  NAMES.H
+ *  This file keeps the names of the lists, matrices, dictionaries, heaps and other containers of a program, so that
+ *  the errors of the kernels name the container instead of printing its address.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <string>
+#include <unordered_map>
+
+//! Names of all Declared Containers by their Address
+inline std::unordered_map<const void*, std::string>& containerNames(){
+    static std::unordered_map<const void*, std::string> names;
+    return names;
+}
+
+//! Remember the Name of a Container
+inline void nameContainer(const void* container, const std::string& name){
+    containerNames()[container] = name;
+}
+
+//! Name of a Container for Error Messages ("?" for Temporaries of the Kernels)
+inline const std::string& containerName(const void* container){
+    static const std::string unknown = "?";
+    auto it = containerNames().find(container);
+    return it == containerNames().end() ? unknown : it->second;
+}
+
+#endif //SQBRA_NAMES_H
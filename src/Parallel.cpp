@@ -0,0 +1,380 @@
+/*
+ *  PARALLEL.CPP
+ *  This file contains the work-stealing thread pool and the execution of parallel loops (ploop).
+ *  Scalar variables are private to every thread (initialized with their value before the loop), lists and matrices are shared.
+ *  Spawned functions run the same way on the thread pool when they are joined.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Parallel.h"
+#include "Recurser.h"
+
+int thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+thread_local bool in_parallel = false;
+
+const size_t CHUNKS_PER_THREAD = 16; // more chunks than threads so that idle threads can steal work
+
+// THREAD POOL ######################################################################
+
+ThreadPool::ThreadPool(int threads){
+    for(int i = 0; i < std::max(threads, 1); i++){
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+    }
+    for(int i = 1; i < size(); i++){
+        this->threads.emplace_back(&ThreadPool::workerLoop, this, i); // thread 0 is the caller of parallelFor
+    }
+}
+
+//! Take a Chunk from the Own Queue or Steal One from Another Thread
+bool ThreadPool::takeChunk(int worker, std::pair<size_t, size_t>& chunk){
+    {
+        std::lock_guard<std::mutex> guard(queues[worker]->lock);
+        if(!queues[worker]->chunks.empty()){
+            chunk = queues[worker]->chunks.back();
+            queues[worker]->chunks.pop_back();
+            return true;
+        }
+    }
+    for(int i = 1; i < size(); i++){
+        WorkQueue& victim = *queues[(worker + i) % size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.chunks.empty()){
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Process Chunks Until No Thread Has Work Left
+void ThreadPool::work(int worker){
+    std::pair<size_t, size_t> chunk;
+    while(takeChunk(worker, chunk)){
+        (*job)(chunk.first, chunk.second, worker);
+        if(remaining.fetch_sub(1) == 1){
+            std::lock_guard<std::mutex> guard(lock);
+            done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(int worker){
+    size_t seen = 0;
+    for(;;){
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&]{ return generation != seen; });
+            seen = generation;
+        }
+        work(worker);
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, int)>& body){
+    std::lock_guard<std::mutex> guard(running);
+    size_t chunks = (n + grain - 1) / grain;
+    if(chunks == 0){
+        return;
+    }
+    remaining = chunks;
+    {
+        std::lock_guard<std::mutex> state(lock);
+        job = &body;
+        // every thread starts with a contiguous range of chunks
+        for(size_t c = 0; c < chunks; c++){
+            WorkQueue& queue = *queues[c * size() / chunks];
+            std::lock_guard<std::mutex> owner(queue.lock);
+            queue.chunks.emplace_back(c * grain, std::min(n, (c + 1) * grain));
+        }
+        generation++;
+    }
+    wake.notify_all();
+    work(0);
+    std::unique_lock<std::mutex> state(lock);
+    done.wait(state, [&]{ return remaining == 0; });
+}
+
+ThreadPool& threadPool(){
+    static ThreadPool* pool = new ThreadPool(thread_count); // never destroyed: exit() may be called while the workers wait
+    return *pool;
+}
+
+// PRIVATE COPIES OF LOOP BODIES ####################################################
+
+//! Copy an Expression; Variables Point to the Private Storage and Flattened Subtrees are Flattened Again
+template<typename T>
+MathNode* copyExpression(MathNode* node, PrivateCopy<T>* copy){
+    if(node == nullptr){
+        return nullptr;
+    }
+    auto result = new MathNode(*node);
+    if(node->type == MathNodeType::Variable){
+        result->variable = copy->privateVariable((T*)node->variable);
+    }
+    result->left = copyExpression(node->left, copy);
+    result->right = copyExpression(node->right, copy);
+    result->otherwise = copyExpression(node->otherwise, copy);
+    result->program = nullptr;
+    if(node->program != nullptr){
+        flattenExpression<T>(result);
+        if(result->program != nullptr){
+            ((MathProgram<T>*)result->program)->hits = -1; // the JIT is not thread-safe and is not used in parallel loops
+        }
+    }
+    return result;
+}
+
+template<typename T>
+Node* copyPrivate(Node* node, PrivateCopy<T>* copy){
+    auto result = new Node(*node);
+    result->native = nullptr;
+    result->hits = -1;
+    if(node->type == EXPRESSION || node->type == VARLIST){
+        result->expression = copyExpression(node->expression, copy);
+    }
+    for(Node*& child : result->children){
+        child = copyPrivate(child, copy);
+    }
+    switch(node->type){
+        case VARIABLE:
+            result->value = copy->privateVariable((T*)node->value);
+            break;
+        case VARIABLES: {
+            auto variables = new std::vector<T*>;
+            for(T* variable : *(std::vector<T*>*)node->value){
+                variables->push_back(copy->privateVariable(variable));
+            }
+            result->value = variables;
+            break;
+        }
+        case SETARRAY:
+            result->value = compileArrayExpression<T>(result->children[1]->expression, ((ArrayProgram<T>*)node->value)->matrix);
+            break;
+        case PLOOP: {
+            auto loop = new ParallelLoop<T>;
+            for(const Reduction<T>& reduction : ((ParallelLoop<T>*)node->value)->reductions){
+                loop->reductions.push_back(Reduction<T>{reduction.type, copy->privateVariable(reduction.variable)});
+            }
+            result->value = loop;
+            break;
+        }
+        case CALL: {
+            // the called function is copied as well and bound to the call
+            std::string name = *(std::string*)node->children[0]->value;
+            if(funcs.find(name) == funcs.end()){
+                std::cerr << "Error: function <" << name << "> must be declared before the ploop that calls it" << std::endl;
+                exit(0);
+            }
+            if(std::find(copy->copying.begin(), copy->copying.end(), name) != copy->copying.end()){
+                std::cerr << "Error: function <" << name << "> is recursive and cannot be called inside ploop" << std::endl;
+                exit(0);
+            }
+            copy->copying.push_back(name);
+            result->children.push_back(copyPrivate(funcs[name], copy));
+            copy->copying.pop_back();
+            break;
+        }
+        case LEAVE:
+            std::cerr << "Error: leave cannot be used inside ploop" << std::endl;
+            exit(0);
+        default:
+            break;
+    }
+    return result;
+}
+
+// PARALLEL LOOP ####################################################################
+
+//! Copy the Private Variables Back to the Shared Ones (Except the Counter and the Reductions)
+template<typename T>
+void copyBack(ParallelLoop<T>* info, PrivateCopy<T>* copy, T* counter){
+    for(auto& variable : copy->variables){
+        bool reduction = std::any_of(info->reductions.begin(), info->reductions.end(), [&](const Reduction<T>& r){ return r.variable == variable.first; });
+        if(variable.first != counter && !reduction){
+            *variable.first = *variable.second;
+        }
+    }
+}
+
+template<typename T>
+void runParallelLoop(Node* loop){
+    auto info = (ParallelLoop<T>*)loop->value;
+    T* shared = (T*)loop->children[0]->expression->variable;
+    T start = calculateExpression<T>(loop->children[1]->expression);
+    if(info->wholeCount){
+        start = (T)(int)start;
+    }
+    size_t count = start > 0 ? (size_t)ceil(start) : 0; // the loop variable takes the values start, start - 1, ... > 0 like in autoloop
+    int threads = in_parallel ? 1 : threadPool().size(); // nested parallel loops run on the thread of the outer iteration
+    if(info->automatic && start != floor(start)){
+        threads = 1; // the analysis assumes whole counter values (indices like x-1 are truncated)
+    }
+
+    while((int)info->copies.size() < threads){
+        auto copy = new PrivateCopy<T>;
+        copy->privateVariable(shared);
+        copy->body = copyPrivate<T>(loop->children[2], copy);
+        info->copies.push_back(copy);
+    }
+    std::vector<T*> counters(threads);
+    for(int t = 0; t < threads; t++){
+        PrivateCopy<T>* copy = info->copies[t];
+        for(auto& variable : copy->variables){
+            *variable.second = *variable.first;
+        }
+        for(const Reduction<T>& reduction : info->reductions){
+            if(reduction.type == ReductionType::SUM){
+                *copy->privateVariable(reduction.variable) = 0;
+            }
+        }
+        counters[t] = copy->privateVariable(shared);
+    }
+
+    if(threads == 1){
+        bool outer = in_parallel;
+        in_parallel = true;
+        for(size_t k = 0; k < count; k++){
+            *counters[0] = start - (T)k;
+            execute<T>(info->copies[0]->body);
+        }
+        in_parallel = outer;
+        if(info->automatic){
+            copyBack(info, info->copies[0], shared);
+        }
+    }else{
+        // the output of every chunk is buffered and written in the order of the iterations
+        size_t grain = std::max<size_t>(1, count / (threads * CHUNKS_PER_THREAD));
+        std::vector<std::string> output((count + grain - 1) / grain);
+        threadPool().parallelFor(count, grain, [&](size_t begin, size_t end, int thread){
+            std::ostringstream buffer;
+            buffer.copyfmt(std::cout);
+            std::ostream* previous = out_stream;
+            bool outer = in_parallel;
+            out_stream = &buffer;
+            in_parallel = true;
+            if_state = false;
+            for(size_t k = begin; k < end; k++){
+                *counters[thread] = start - (T)k;
+                execute<T>(info->copies[thread]->body);
+            }
+            if(info->automatic && end == count){
+                copyBack(info, info->copies[thread], shared); // this thread ran the last iteration
+            }
+            out_stream = previous;
+            in_parallel = outer;
+            output[begin / grain] = buffer.str();
+        });
+        for(const std::string& text : output){
+            *out_stream << text;
+        }
+    }
+
+    for(const Reduction<T>& reduction : info->reductions){
+        T result = *reduction.variable;
+        for(int t = 0; t < threads; t++){
+            T value = *info->copies[t]->privateVariable(reduction.variable);
+            if(reduction.type == ReductionType::SUM){
+                result += value;
+            }else if(reduction.type == ReductionType::MIN){
+                result = std::min(result, value);
+            }else{
+                result = std::max(result, value);
+            }
+        }
+        *reduction.variable = result;
+    }
+    *shared = start - (T)count;
+}
+
+// TASKS ############################################################################
+
+thread_local std::vector<Node*> pending_tasks; // spawned functions that wait for the next join
+
+bool conflicts(const AccessSets& first, const AccessSets& second, bool output);
+
+//! Run a Spawned Function on the Calling Thread like call
+template<typename T>
+void runTask(SpawnTask<T>* task){
+    execute<T>(task->body);
+    if_state = false;
+}
+
+template<typename T>
+void spawnTask(Node* statement){
+    auto task = (SpawnTask<T>*)statement->value;
+    if(task->serial || in_parallel || std::find(pending_tasks.begin(), pending_tasks.end(), statement) != pending_tasks.end()){
+        runTask(task);
+        return;
+    }
+    pending_tasks.push_back(statement);
+    if_state = false;
+}
+
+template<typename T>
+void joinTasks(){
+    std::vector<Node*> tasks;
+    tasks.swap(pending_tasks);
+    bool serial = tasks.size() < 2 || threadPool().size() == 1;
+    for(size_t i = 0; i < tasks.size() && !serial; i++){
+        for(size_t j = i + 1; j < tasks.size() && !serial; j++){
+            serial = conflicts(((SpawnTask<T>*)tasks[i]->value)->accesses, ((SpawnTask<T>*)tasks[j]->value)->accesses, false);
+        }
+    }
+    if(serial){
+        for(Node* statement : tasks){
+            runTask((SpawnTask<T>*)statement->value);
+        }
+        return;
+    }
+
+    // every task works with private copies of all variables and writes its results back after all tasks are done
+    for(Node* statement : tasks){
+        auto task = (SpawnTask<T>*)statement->value;
+        if(task->copy == nullptr){
+            task->copy = new PrivateCopy<T>;
+            task->copy->body = copyPrivate<T>(task->body, task->copy);
+        }
+        for(auto& variable : task->copy->variables){
+            *variable.second = *variable.first;
+        }
+    }
+    std::vector<std::string> output(tasks.size());
+    threadPool().parallelFor(tasks.size(), 1, [&](size_t begin, size_t end, int){
+        std::ostringstream buffer;
+        buffer.copyfmt(std::cout);
+        std::ostream* previous = out_stream;
+        bool outer = in_parallel;
+        out_stream = &buffer;
+        in_parallel = true;
+        for(size_t k = begin; k < end; k++){
+            if_state = false;
+            execute<T>(((SpawnTask<T>*)tasks[k]->value)->copy->body);
+            output[k] = buffer.str();
+            buffer.str("");
+        }
+        out_stream = previous;
+        in_parallel = outer;
+    });
+    for(size_t k = 0; k < tasks.size(); k++){
+        auto task = (SpawnTask<T>*)tasks[k]->value;
+        *out_stream << output[k];
+        for(auto& variable : task->copy->variables){
+            if(task->accesses.writes.count(variable.first) > 0){
+                *variable.first = *variable.second;
+            }
+        }
+    }
+    if_state = false;
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template Node* copyPrivate<double>(Node* node, PrivateCopy<double>* copy);
+template Node* copyPrivate<long double>(Node* node, PrivateCopy<long double>* copy);
+template void runParallelLoop<double>(Node* loop);
+template void runParallelLoop<long double>(Node* loop);
+template void spawnTask<double>(Node* statement);
+template void spawnTask<long double>(Node* statement);
+template void joinTasks<double>();
+template void joinTasks<long double>();
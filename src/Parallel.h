@@ -0,0 +1,144 @@
+#pragma once
+#ifndef SQBRA_PARALLEL_H
+#define SQBRA_PARALLEL_H
+
+/*
+ *  PARALLEL.H
+ *  This file declares the work-stealing thread pool and the parallel loop (ploop) of the SquareBracket language.
+ *  Every thread runs its own copy of the loop body in which all scalar variables point to private storage.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "Tokens.h"
+
+extern int thread_count; // set by the flag --threads (default: number of hardware threads)
+
+extern thread_local bool in_parallel; // does the current thread execute a part of a parallel loop
+
+extern bool auto_parallel; // set by the flag --auto-parallel: independent autoloop and sloop statements run in parallel
+
+// THREAD POOL ######################################################################
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+
+    //! Number of Threads Including the Calling Thread
+    int size() const { return (int)queues.size(); }
+
+    //! Run body(begin, end, thread) for all Chunks of [0, n); Idle Threads Steal Chunks from the Others
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, int)>& body);
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::pair<size_t, size_t> > chunks;
+    };
+
+    bool takeChunk(int worker, std::pair<size_t, size_t>& chunk);
+    void work(int worker);
+    void workerLoop(int worker);
+
+    std::vector<std::unique_ptr<WorkQueue> > queues; // one per thread, the owner takes from the back, thieves from the front
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::mutex running; // only one parallelFor at a time
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, size_t, int)>* job = nullptr;
+    size_t generation = 0;
+    std::atomic<size_t> remaining{0};
+};
+
+//! The Thread Pool of the Interpreter (Created on First Use with thread_count Threads)
+ThreadPool& threadPool();
+
+// PRIVATE COPIES OF LOOP BODIES ####################################################
+
+enum class ReductionType { SUM, MIN, MAX };
+
+template<typename T>
+struct Reduction {
+    ReductionType type;
+    T* variable;
+};
+
+template<typename T>
+struct PrivateCopy {
+    Node* body = nullptr;
+    std::deque<T> storage;                      // private variables (a deque keeps their addresses stable)
+    std::vector<std::pair<T*, T*> > variables;  // shared and private address of every variable of the body
+    std::vector<std::string> copying;           // functions that are being copied (detects recursion)
+
+    //! Private Storage of a Shared Variable
+    T* privateVariable(T* shared){
+        for(auto& variable : variables){
+            if(variable.first == shared){
+                return variable.second;
+            }
+        }
+        storage.push_back(*shared);
+        variables.emplace_back(shared, &storage.back());
+        return &storage.back();
+    }
+};
+
+template<typename T>
+struct ParallelLoop {
+    std::vector<Reduction<T> > reductions;
+    std::vector<PrivateCopy<T>*> copies; // one per thread, created on the first execution
+    bool automatic = false;  // created by --auto-parallel: variables keep their values of the last iteration like in autoloop
+    bool wholeCount = false; // the count is truncated to an integer like in sloop
+};
+
+template<typename T>
+Node* copyPrivate(Node* node, PrivateCopy<T>* copy);
+
+template<typename T>
+void runParallelLoop(Node* loop);
+
+// TASKS ############################################################################
+
+//! Variables, Lists and Matrices that Statements Read and Write (the Output and Files Count as Written as well)
+struct AccessSets {
+    std::set<void*> reads;
+    std::set<void*> writes;
+    bool serial = false; // the statements cannot run as a task (input, exit, leave, funct, recursion, spawn, join)
+};
+
+template<typename T>
+struct SpawnTask {
+    Node* body = nullptr;           // body of the spawned function
+    AccessSets accesses;            // of the body including called functions
+    bool serial = false;            // conflicts with the statements before the next join: runs when it is spawned
+    PrivateCopy<T>* copy = nullptr; // created on the first concurrent run
+};
+
+//! Spawn a Function (it runs at the latest at the next join)
+template<typename T>
+void spawnTask(Node* statement);
+
+//! Run all Spawned Functions Concurrently (or in the Order of spawn if they Conflict) and Wait for Them
+template<typename T>
+void joinTasks();
+
+// DEPENDENCE ANALYSIS ##############################################################
+
+//! Turn autoloop and sloop Statements with Independent Iterations into Parallel Loops and Report the Decisions
+template<typename T>
+void parallelizeLoops(Node* root);
+
+//! Compute the Read and Write Sets of all spawn Statements and Decide which Ones Conflict with the Code Before the Next join
+template<typename T>
+void prepareTasks(Node* root);
+
+#endif //SQBRA_PARALLEL_H
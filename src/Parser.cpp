@@ -6,14 +6,16 @@
  */
 
 #include "Tokens.h"
+#include "Parallel.h"
 
 int rLine = -1; // this variable tells the parser where to continue after an indented block
 
 //! Create a Single Variable
-long double* makeVarEntry(const std::string& str){
-    if (vars.find(str) == vars.end()){
-        long double* newVar = (long double*)malloc(sizeof(long double));
-        vars[str] = newVar;
+template<typename T>
+T* makeVarEntry(const std::string& str){
+    if (vars<T>.find(str) == vars<T>.end()){
+        T* newVar = (T*)malloc(sizeof(T));
+        vars<T>[str] = newVar;
         return newVar;
     } else {
         std::cerr << "Error: variable <" << str << "> is already defined." << std::endl;
@@ -21,25 +23,39 @@ long double* makeVarEntry(const std::string& str){
     }
 }
 
+//! Get Pointer for Variable from String
+template<typename T>
+T* getVarEntry(const std::string& str){
+    if (vars<T>.find(str) != vars<T>.end()) {
+        return vars<T>[str];
+    } else {
+        std::cerr << "Error: variable <" << str << "> is not defined." << std::endl;
+        exit(0);
+    }
+}
+
 //! Create Multiple Variables at Once
-std::vector<long double*>* makeMultipleVarEntries(const std::string& str){
-    auto* tmpVec = new std::vector<long double*>;
+template<typename T>
+std::vector<T*>* makeMultipleVarEntries(const std::string& str){
+    auto* tmpVec = new std::vector<T*>;
     std::istringstream iss(str);
     std::vector<std::string> words;
     for (std::string word; iss >> word; ) {
         words.push_back(word);
     }
     for (const auto& word : words) {
-        (*tmpVec).push_back(makeVarEntry(word));
+        (*tmpVec).push_back(makeVarEntry<T>(word));
     }
     return tmpVec;
 }
 
 //! Create a New List and Return Pointer
-std::vector<long double>* makeListEntry(const std::string& str){
-    if (ars.find(str) == ars.end()){
-        auto newArr = new std::vector<long double>;
-        ars[str] = newArr;
+template<typename T>
+std::vector<T>* makeListEntry(const std::string& str){
+    if (ars<T>.find(str) == ars<T>.end() && typeds<T>.find(str) == typeds<T>.end()){
+        auto newArr = new std::vector<T>;
+        ars<T>[str] = newArr;
+        nameContainer(newArr, str);
         return newArr;
     } else {
         std::cerr << "Error: list <" << str << "> is already defined." << std::endl;
@@ -47,21 +63,178 @@ std::vector<long double>* makeListEntry(const std::string& str){
     }
 }
 
+//! Terminate for a Typed List or Matrix Given to a Command that Only Takes Lists or Matrices of Numbers
+[[noreturn]] void rejectTyped(const std::string& str, const TypedArray* typed){
+    std::cerr << "Error: " << (typed->matrix ? "matrix <" : "list <") << str << "> has " << elementName(typed->type) << " entries; this command only takes "
+              << (typed->matrix ? "matrices" : "lists") << " without a type." << std::endl;
+    exit(0);
+}
+
 //! Get Pointer for List from String
-std::vector<long double>* getListEntry(const std::string& str){
-    if (ars.find(str) != ars.end()) {
-        return ars[str];
+template<typename T>
+std::vector<T>* getListEntry(const std::string& str){
+    if (ars<T>.find(str) != ars<T>.end()) {
+        return ars<T>[str];
+    } else if (typeds<T>.find(str) != typeds<T>.end()) {
+        rejectTyped(str, typeds<T>[str]);
     } else {
         std::cerr << "Error: list <" << str << "> is not defined." << std::endl;
         exit(0);
     }
 }
 
+//! Create a New Empty Dictionary and Return Pointer
+template<typename T>
+Dict<T>* makeDictEntry(const std::string& str){
+    if (dicts<T>.find(str) == dicts<T>.end()){
+        auto newDict = new Dict<T>;
+        dicts<T>[str] = newDict;
+        nameContainer(newDict, str);
+        return newDict;
+    } else {
+        std::cerr << "Error: dictionary <" << str << "> is already defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Get Pointer for Dictionary from String
+template<typename T>
+Dict<T>* getDictEntry(const std::string& str){
+    if (dicts<T>.find(str) != dicts<T>.end()) {
+        return dicts<T>[str];
+    } else {
+        std::cerr << "Error: dictionary <" << str << "> is not defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Create a Node for a Dictionary
+template<typename T>
+Node* makeDictNode(const std::string& str, bool create){
+    Node* node = new Node;
+    node->type = DICTIDENT;
+    node->value = create ? makeDictEntry<T>(str) : getDictEntry<T>(str);
+    return node;
+}
+
+//! Create a New Empty Heap and Return Pointer
+template<typename T>
+Heap<T>* makeHeapEntry(const std::string& str){
+    if (heaps<T>.find(str) == heaps<T>.end()){
+        auto newHeap = new Heap<T>;
+        heaps<T>[str] = newHeap;
+        nameContainer(newHeap, str);
+        return newHeap;
+    } else {
+        std::cerr << "Error: heap <" << str << "> is already defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Get Pointer for Heap from String
+template<typename T>
+Heap<T>* getHeapEntry(const std::string& str){
+    if (heaps<T>.find(str) != heaps<T>.end()) {
+        return heaps<T>[str];
+    } else {
+        std::cerr << "Error: heap <" << str << "> is not defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Create a Node for a Heap
+template<typename T>
+Node* makeHeapNode(const std::string& str, bool create){
+    Node* node = new Node;
+    node->type = HEAPIDENT;
+    node->value = create ? makeHeapEntry<T>(str) : getHeapEntry<T>(str);
+    return node;
+}
+
+//! Create a New Empty Bit Matrix and Return Pointer
+template<typename T>
+BitMatrix* makeBitMatrixEntry(const std::string& str){
+    if (bmats<T>.find(str) == bmats<T>.end()){
+        auto newBits = new BitMatrix;
+        bmats<T>[str] = newBits;
+        nameContainer(newBits, str);
+        return newBits;
+    } else {
+        std::cerr << "Error: bit matrix <" << str << "> is already defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Get Pointer for Bit Matrix from String
+template<typename T>
+BitMatrix* getBitMatrixEntry(const std::string& str){
+    if (bmats<T>.find(str) != bmats<T>.end()) {
+        return bmats<T>[str];
+    } else {
+        std::cerr << "Error: bit matrix <" << str << "> is not defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Create a Node for a Bit Matrix
+template<typename T>
+Node* makeBitMatrixNode(const std::string& str, bool create){
+    Node* node = new Node;
+    node->type = BMATIDENT;
+    node->value = create ? makeBitMatrixEntry<T>(str) : getBitMatrixEntry<T>(str);
+    return node;
+}
+
+//! Create a New Empty Sparse Matrix and Return Pointer
+template<typename T>
+SparseMatrix<T>* makeSparseEntry(const std::string& str){
+    if (sparses<T>.find(str) == sparses<T>.end() && mars<T>.find(str) == mars<T>.end()){
+        auto newSparse = new SparseMatrix<T>;
+        sparses<T>[str] = newSparse;
+        nameContainer(newSparse, str);
+        return newSparse;
+    } else {
+        std::cerr << "Error: matrix <" << str << "> is already defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Get Pointer for Sparse Matrix from String
+template<typename T>
+SparseMatrix<T>* getSparseEntry(const std::string& str){
+    if (sparses<T>.find(str) != sparses<T>.end()) {
+        return sparses<T>[str];
+    } else {
+        std::cerr << "Error: sparse matrix <" << str << "> is not defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Create a Node for a Sparse Matrix
+template<typename T>
+Node* makeSparseNode(const std::string& str, bool create){
+    Node* node = new Node;
+    node->type = SPARSEIDENT;
+    node->value = create ? makeSparseEntry<T>(str) : getSparseEntry<T>(str);
+    return node;
+}
+
+//! Create a Node for an Expression
+template<typename T>
+Node* makeExpressionNode(const std::string& str){
+    Node* node = new Node;
+    node->type = EXPRESSION;
+    node->expression = mathparse<T>(str);
+    return node;
+}
+
 //! Create a New Empty Matrix and Return Pointer
-std::vector<std::vector<long double>* >* makeMatrixEntry(const std::string& str){
-    if (mars.find(str) == mars.end()){
-        auto newMat = new std::vector<std::vector<long double>* >;
-        mars[str] = newMat;
+template<typename T>
+Matrix<T>* makeMatrixEntry(const std::string& str){
+    if (mars<T>.find(str) == mars<T>.end() && typeds<T>.find(str) == typeds<T>.end() && sparses<T>.find(str) == sparses<T>.end()){
+        auto newMat = new Matrix<T>;
+        mars<T>[str] = newMat;
+        nameContainer(newMat, str);
         return newMat;
     } else {
         std::cerr << "Error: matrix <" << str << "> is already defined." << std::endl;
@@ -70,16 +243,107 @@ std::vector<std::vector<long double>* >* makeMatrixEntry(const std::string& str)
 }
 
 //! Get Pointer for Matrix from String
-std::vector<std::vector<long double>* >* getMatrixEntry(const std::string& str){
-    if (mars.find(str) != mars.end()) {
-        return mars[str];
+template<typename T>
+Matrix<T>* getMatrixEntry(const std::string& str){
+    if (mars<T>.find(str) != mars<T>.end()) {
+        return mars<T>[str];
+    } else if (typeds<T>.find(str) != typeds<T>.end()) {
+        rejectTyped(str, typeds<T>[str]);
     } else {
         std::cerr << "Error: matrix <" << str << "> is not defined." << std::endl;
         exit(0);
     }
 }
 
+//! Create a Node Referring to an Existing List or Matrix
+template<typename T>
+Node* makeContainerNode(const std::string& str, bool matrix){
+    Node* node = new Node;
+    if (matrix) {
+        node->type = MATIDENT;
+        node->value = getMatrixEntry<T>(str);
+    } else {
+        node->type = LISTIDENT;
+        node->value = getListEntry<T>(str);
+    }
+    return node;
+}
+
+//! Create a New Typed List or Matrix and Return Pointer
+template<typename T>
+TypedArray* makeTypedEntry(const std::string& str, const std::string& type, bool matrix){
+    ElementType element;
+    if (!elementType(type, element)) {
+        std::cerr << "Error: <" << type << "> is not a type of entries (i32, i64, f32 or f64)." << std::endl;
+        exit(0);
+    }
+    if (typeds<T>.find(str) == typeds<T>.end() && ars<T>.find(str) == ars<T>.end() && mars<T>.find(str) == mars<T>.end()){
+        auto newTyped = new TypedArray(element, matrix);
+        typeds<T>[str] = newTyped;
+        nameContainer(newTyped, str);
+        return newTyped;
+    } else {
+        std::cerr << "Error: " << (matrix ? "matrix <" : "list <") << str << "> is already defined." << std::endl;
+        exit(0);
+    }
+}
+
+//! Make the Node Refer to the Typed List or Matrix of this Name; Returns False if There is None
+template<typename T>
+bool makeTypedNode(Node* node, const std::string& str, bool matrix){
+    auto it = typeds<T>.find(str);
+    if (it == typeds<T>.end() || it->second->matrix != matrix) {
+        return false;
+    }
+    node->type = TYPEDIDENT;
+    node->value = it->second;
+    return true;
+}
+
+//! Create a Node for an Operand that is Either a List / Matrix or an Expression (Applied to Every Element)
+template<typename T>
+Node* makeOperandNode(const std::string& str, bool matrix){
+    if ((matrix && mars<T>.find(str) != mars<T>.end()) || (!matrix && ars<T>.find(str) != ars<T>.end())) {
+        return makeContainerNode<T>(str, matrix);
+    }
+    Node* node = new Node;
+    node->type = EXPRESSION;
+    node->expression = mathparse<T>(str);
+    return node;
+}
+
+//! Get the Token Type of an Elementwise Command
+TokenType getElementwiseType(const std::string& value){
+    if (value == "ladd") { return LADD; }
+    else if (value == "lsub") { return LSUB; }
+    else if (value == "lmul") { return LMUL; }
+    else if (value == "ldiv") { return LDIV; }
+    else if (value == "laxpy") { return LAXPY; }
+    else if (value == "lclamp") { return LCLAMP; }
+    else if (value == "lcmp") { return LCMP; }
+    else if (value == "madd") { return MADD; }
+    else if (value == "msub") { return MSUB; }
+    else if (value == "mmul") { return MMUL; }
+    else if (value == "mdiv") { return MDIV; }
+    else if (value == "maxpy") { return MAXPY; }
+    else if (value == "mclamp") { return MCLAMP; }
+    return MCMP;
+}
+
+//! Get the Token Type of a Reduction or Prefix Sum
+TokenType getReductionType(const std::string& value){
+    if (value == "lsum") { return LSUM; }
+    else if (value == "lmin") { return LMIN; }
+    else if (value == "lmax") { return LMAX; }
+    else if (value == "largmax") { return LARGMAX; }
+    else if (value == "lmean") { return LMEAN; }
+    else if (value == "lvar") { return LVAR; }
+    else if (value == "ldot") { return LDOT; }
+    return LSCAN;
+}
+
 //! Parse Tokens, Determine Type of Node and Build Tree
+template<typename T>
 Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startLine) {
     Node* root = new Node;
     root->type = ROOT;
@@ -103,31 +367,42 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
         Node* tmpNod2 = new Node;
         Node* tmpNod3 = new Node;
         Node* child = new Node;
+        child->line = currentLine + 1; // the line of the statement itself, blocks move currentLine to their end
 
         if (value == "cvar") {
             type = CVAR;
             tmpNod1->type = VARIABLE;
-            tmpNod1->value = makeVarEntry(line[1]);
-            MathNode* expr = mathparse(line[2]);
+            tmpNod1->value = makeVarEntry<T>(line[1]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "clist") {
             type = CLIST;
-            tmpNod1->type = LISTIDENT;
-            tmpNod1->value = makeListEntry(line[1]);
-            MathNode* expr = mathparse(line[2]);
+            if (line.size() == 4) {
+                tmpNod1->type = TYPEDIDENT;
+                tmpNod1->value = makeTypedEntry<T>(line[1], line[3], false);
+            } else {
+                tmpNod1->type = LISTIDENT;
+                tmpNod1->value = makeListEntry<T>(line[1]);
+            }
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "cmat") {
             type = CMAT;
-            tmpNod1->type = MATIDENT;
-            tmpNod1->value = makeMatrixEntry(line[1]);
-            MathNode* dim1 = mathparse(line[2]);
-            MathNode* dim2 = mathparse(line[3]);
+            if (line.size() == 5) {
+                tmpNod1->type = TYPEDIDENT;
+                tmpNod1->value = makeTypedEntry<T>(line[1], line[4], true);
+            } else {
+                tmpNod1->type = MATIDENT;
+                tmpNod1->value = makeMatrixEntry<T>(line[1]);
+            }
+            MathNode* dim1 = mathparse<T>(line[2]);
+            MathNode* dim2 = mathparse<T>(line[3]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = dim1;
             tmpNod3->type = EXPRESSION;
@@ -147,25 +422,35 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
                     apStr.append(line[i]);
                 }
             }
-            tmpNod1->value = makeMultipleVarEntries(apStr);
-            MathNode* expr = mathparse(line[line.size() - 1]);
+            tmpNod1->value = makeMultipleVarEntries<T>(apStr);
+            MathNode* expr = mathparse<T>(line[line.size() - 1]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
+        } else if (value == "set" && vars<T>.find(line[1]) == vars<T>.end() && (ars<T>.find(line[1]) != ars<T>.end() || mars<T>.find(line[1]) != mars<T>.end())) {
+            // assignment to a whole list or matrix, evaluated as one fused loop over all operands
+            type = SETARRAY;
+            bool matrix = mars<T>.find(line[1]) != mars<T>.end();
+            MathNode* expr = arrayparse<T>(line[2]);
+            tmpNod2->type = EXPRESSION;
+            tmpNod2->expression = expr;
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(tmpNod2);
+            child->value = compileArrayExpression<T>(expr, matrix);
         } else if (value == "set") {
             type = SET;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "input") {
             type = INPUT;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = STRING;
@@ -182,24 +467,48 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             child->children.push_back(tmpNod2);
         } else if (value == "loop") {
             type = LOOP;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens,  currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens,  currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "autoloop") {
             type = AUTOLOOP;
-            MathNode* vrl1 = varparse(line[1]);
+            MathNode* vrl1 = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl1;
-            MathNode* vrl2 = mathparse(line[2]);
+            MathNode* vrl2 = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = vrl2;
             tmpNod3->type = EXEC;
-            tmpNod3->children = parseTree(tokens,  currentLine + 1)->children;
+            tmpNod3->children = parseTree<T>(tokens,  currentLine + 1)->children;
+            currentLine = rLine;
+            child->children.push_back(tmpNod1);
+            child->children.push_back(tmpNod2);
+            child->children.push_back(tmpNod3);
+        } else if (value == "ploop") {
+            type = PLOOP;
+            MathNode* vrl1 = varparse<T>(line[1]);
+            if (vrl1->type != MathNodeType::Variable) {
+                std::cerr << "Error: <" << line[1] << "> the counter of ploop must be a variable." << std::endl;
+                exit(0);
+            }
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = vrl1;
+            MathNode* vrl2 = mathparse<T>(line[2]);
+            tmpNod2->type = EXPRESSION;
+            tmpNod2->expression = vrl2;
+            auto loop = new ParallelLoop<T>;
+            for (int i = 3; i + 1 < line.size() - 2; i += 2) {
+                ReductionType reduction = line[i] == "sum" ? ReductionType::SUM : line[i] == "min" ? ReductionType::MIN : ReductionType::MAX;
+                loop->reductions.push_back(Reduction<T>{reduction, getVarEntry<T>(line[i + 1])});
+            }
+            child->value = loop;
+            tmpNod3->type = EXEC;
+            tmpNod3->children = parseTree<T>(tokens,  currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
@@ -211,62 +520,62 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             *apStr = line[1];
             tmpNod1->value = apStr;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens,  currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens,  currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "while") {
             type = WHILE;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = expr;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens, currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens, currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "inc") {
             type = INC;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "dec") {
             type = DEC;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "sleep") {
             type = SLEEP;
-            MathNode* vrl = mathparse(line[1]);
+            MathNode* vrl = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "elif") {
             type = ELIF;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = expr;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens, currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens, currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "if") {
             type = IF;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = expr;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens, currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens, currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "else") {
             type = ELSE;
             tmpNod1->type = EXEC;
-            tmpNod1->children = parseTree(tokens, currentLine + 1)->children;
+            tmpNod1->children = parseTree<T>(tokens, currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
         } else if (value == "print") {
@@ -299,39 +608,39 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             child->children.push_back(tmpNod1);
         } else if (value == "printv") {
             type = PRINTV;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = expr;
             child->children.push_back(tmpNod1);
         } else if (value == "printm") {
             type = PRINTM;
             tmpNod1->type = MATIDENT;
-            tmpNod1->value = getMatrixEntry(line[1]);
+            tmpNod1->value = getMatrixEntry<T>(line[1]);
             child->children.push_back(tmpNod1);
         } else if (value == "ceil") {
             type = CEIL;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "floor") {
             type = FLOOR;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "abs") {
             type = ABS;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             child->children.push_back(tmpNod1);
         } else if (value == "round") {
             type = ROUND;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
@@ -350,13 +659,13 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             return root;
         } else if (value == "log") {
             type = LOG;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->type = EXPRESSION;
             tmpNod2->expression = expr;
-            MathNode* expr2 = mathparse(line[3]);
+            MathNode* expr2 = mathparse<T>(line[3]);
             tmpNod3->type = EXPRESSION;
             tmpNod3->expression = expr2;
             child->children.push_back(tmpNod1);
@@ -364,113 +673,113 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             child->children.push_back(tmpNod3);
         } else if (value == "sin") {
             type = SIN;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "cos") {
             type = COS;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "tan") {
             type = TAN;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "sec") {
             type = SEC;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "csc") {
             type = CSC;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "sec") {
             type = SEC;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "cot") {
             type = COT;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "asin") {
             type = ASIN;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "acos") {
             type = ACOS;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "atan") {
             type = ATAN;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         }else if (value == "xroot") {
             type = XROOT;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
-            MathNode* expr2 = mathparse(line[3]);
+            MathNode* expr2 = mathparse<T>(line[3]);
             tmpNod3->type = EXPRESSION;
             tmpNod3->expression = expr2;
             child->children.push_back(tmpNod1);
@@ -478,13 +787,13 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             child->children.push_back(tmpNod3);
         }else if (value == "random") {
             type = RANDOM;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
-            MathNode* expr2 = mathparse(line[3]);
+            MathNode* expr2 = mathparse<T>(line[3]);
             tmpNod3->type = EXPRESSION;
             tmpNod3->expression = expr2;
             child->children.push_back(tmpNod1);
@@ -493,56 +802,74 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
         } else if (value == "push") {
             type = PUSH;
             tmpNod1->type = EXPRESSION;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->expression = expr;
-            tmpNod2->type = LISTIDENT;
-            tmpNod2->value = getListEntry(line[2]);
+            if (!makeTypedNode<T>(tmpNod2, line[2], false)) {
+                tmpNod2->type = LISTIDENT;
+                tmpNod2->value = getListEntry<T>(line[2]);
+            }
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "pop") {
             type = POP;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
-            tmpNod2->type = LISTIDENT;
-            tmpNod2->value = getListEntry(line[2]);
+            if (!makeTypedNode<T>(tmpNod2, line[2], false)) {
+                tmpNod2->type = LISTIDENT;
+                tmpNod2->value = getListEntry<T>(line[2]);
+            }
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "chsl") {
             type = CHSL;
-            tmpNod1->type = LISTIDENT;
-            tmpNod1->value = getListEntry(line[1]);
+            if (!makeTypedNode<T>(tmpNod1, line[1], false)) {
+                tmpNod1->type = LISTIDENT;
+                tmpNod1->value = getListEntry<T>(line[1]);
+            }
             tmpNod2->type = EXPRESSION;
-            MathNode* expr = mathparse(line[2]);
+            MathNode* expr = mathparse<T>(line[2]);
             tmpNod2->expression = expr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "getl") {
             type = GETL;
-            MathNode* vrl = varparse(line[1]);
+            MathNode* vrl = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl;
-            tmpNod2->type = LISTIDENT;
-            tmpNod2->value = getListEntry(line[2]);
+            if (!makeTypedNode<T>(tmpNod2, line[2], false)) {
+                tmpNod2->type = LISTIDENT;
+                tmpNod2->value = getListEntry<T>(line[2]);
+            }
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
         } else if (value == "getdim") {
             type = GETDIM;
-            MathNode* vrl1 = varparse(line[1]);
+            MathNode* vrl1 = varparse<T>(line[1]);
             tmpNod1->type = VARLIST;
             tmpNod1->expression = vrl1;
-            MathNode* vrl2 = varparse(line[2]);
+            MathNode* vrl2 = varparse<T>(line[2]);
             tmpNod2->type = VARLIST;
             tmpNod2->expression = vrl2;
-            tmpNod3->type = LISTIDENT;
-            tmpNod3->value = getMatrixEntry(line[3]);
+            if (sparses<T>.find(line[3]) != sparses<T>.end()) {
+                tmpNod3->type = SPARSEIDENT;
+                tmpNod3->value = sparses<T>[line[3]];
+            } else if (!makeTypedNode<T>(tmpNod3, line[3], true)) {
+                tmpNod3->type = LISTIDENT;
+                tmpNod3->value = getMatrixEntry<T>(line[3]);
+            }
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
             child->children.push_back(tmpNod3);
         } else if (value == "readf") {
             type = READF;
-            tmpNod1->type = MATIDENT;
-            tmpNod1->value = getMatrixEntry(line[1]);
+            if (sparses<T>.find(line[1]) != sparses<T>.end()) {
+                tmpNod1->type = SPARSEIDENT;
+                tmpNod1->value = sparses<T>[line[1]];
+            } else if (!makeTypedNode<T>(tmpNod1, line[1], true)) {
+                tmpNod1->type = MATIDENT;
+                tmpNod1->value = getMatrixEntry<T>(line[1]);
+            }
             tmpNod2->type = STRING;
             std::string* apStr = new std::string;
             *apStr = line[2];
@@ -551,8 +878,10 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             child->children.push_back(tmpNod2);
         } else if (value == "writef") {
             type = WRITEF;
-            tmpNod1->type = MATIDENT;
-            tmpNod1->value = getMatrixEntry(line[1]);
+            if (!makeTypedNode<T>(tmpNod1, line[1], true)) {
+                tmpNod1->type = MATIDENT;
+                tmpNod1->value = getMatrixEntry<T>(line[1]);
+            }
             tmpNod2->type = STRING;
             std::string* apStr = new std::string;
             *apStr = line[2];
@@ -562,7 +891,7 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
         } else if (value == "ldef") {
             type = LDEF;
             tmpNod1->type = LISTIDENT;
-            tmpNod1->value = makeListEntry(line[1]);
+            tmpNod1->value = makeListEntry<T>(line[1]);
             tmpNod2->type = STRING;
             std::string* apStr = new std::string;
             *apStr = line[2];
@@ -572,13 +901,275 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
         } else if (value == "mdef") {
             type = MDEF;
             tmpNod1->type = MATIDENT;
-            tmpNod1->value = makeMatrixEntry(line[1]);
+            tmpNod1->value = makeMatrixEntry<T>(line[1]);
             tmpNod2->type = STRING;
             std::string* apStr = new std::string;
             *apStr = line[2];
             tmpNod2->value = apStr;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
+        } else if (value == "ladd" || value == "lsub" || value == "lmul" || value == "ldiv"
+                   || value == "madd" || value == "msub" || value == "mmul" || value == "mdiv") {
+            type = getElementwiseType(value);
+            bool matrix = value[0] == 'm';
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+            child->children.push_back(makeOperandNode<T>(line[3], matrix));
+        } else if (value == "laxpy" || value == "maxpy") {
+            type = getElementwiseType(value);
+            bool matrix = value[0] == 'm';
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            tmpNod2->type = EXPRESSION;
+            tmpNod2->expression = mathparse<T>(line[2]);
+            child->children.push_back(tmpNod2);
+            child->children.push_back(makeContainerNode<T>(line[3], matrix));
+        } else if (value == "lclamp" || value == "mclamp") {
+            type = getElementwiseType(value);
+            bool matrix = value[0] == 'm';
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+            tmpNod2->type = EXPRESSION;
+            tmpNod2->expression = mathparse<T>(line[3]);
+            tmpNod3->type = EXPRESSION;
+            tmpNod3->expression = mathparse<T>(line[4]);
+            child->children.push_back(tmpNod2);
+            child->children.push_back(tmpNod3);
+        } else if (value == "lcmp" || value == "mcmp") {
+            type = getElementwiseType(value);
+            bool matrix = value[0] == 'm';
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+            tmpNod3->type = STRING;
+            tmpNod3->value = new std::string(line[3]);
+            child->children.push_back(tmpNod3);
+            child->children.push_back(makeOperandNode<T>(line[4], matrix));
+        } else if (value == "vsin" || value == "vcos" || value == "vtan" || value == "vexp" || value == "vlog" || value == "vxroot") {
+            type = value == "vsin" ? VSIN : value == "vcos" ? VCOS : value == "vtan" ? VTAN : value == "vexp" ? VEXP : value == "vlog" ? VLOG : VXROOT;
+            bool matrix = mars<T>.find(line[1]) != mars<T>.end();
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+            if (line.size() > 3) {
+                tmpNod3->type = EXPRESSION;
+                tmpNod3->expression = mathparse<T>(line[3]);
+                child->children.push_back(tmpNod3);
+            }
+        } else if (value == "matmul") {
+            type = MATMUL;
+            child->children.push_back(makeContainerNode<T>(line[1], true));
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+            child->children.push_back(makeContainerNode<T>(line[3], true));
+            tmpNod3->type = STRING;
+            tmpNod3->value = new std::string(line.size() > 4 ? line[4] : "nn"); // t marks a transposed operand
+            child->children.push_back(tmpNod3);
+        } else if (value == "msolve") {
+            type = MSOLVE;
+            bool matrix = mars<T>.find(line[1]) != mars<T>.end();
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+            child->children.push_back(makeContainerNode<T>(line[3], matrix));
+        } else if (value == "mdet") {
+            type = MDET;
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = varparse<T>(line[1]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+        } else if (value == "minv" || value == "mtrans") {
+            type = value == "minv" ? MINV : MTRANS;
+            child->children.push_back(makeContainerNode<T>(line[1], true));
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+        } else if (value == "mlu") {
+            type = MLU;
+            child->children.push_back(makeContainerNode<T>(line[1], true));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+            child->children.push_back(makeContainerNode<T>(line[3], true));
+        } else if (value == "fft" || value == "ifft") {
+            type = value == "fft" ? FFT : IFFT;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+        } else if (value == "lconv") {
+            type = LCONV;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+            child->children.push_back(makeContainerNode<T>(line[3], false));
+        } else if (value == "lsum" || value == "lmin" || value == "lmax" || value == "largmax" || value == "lmean" || value == "lvar"
+                   || value == "ldot" || value == "lscan") {
+            type = getReductionType(value);
+            bool matrix = mars<T>.find(line[2]) != mars<T>.end(); // the source decides between list and matrix
+            std::string* mode = new std::string("aip"); // all / rows / cols, inclusive / exclusive, pairwise / kahan
+            for (size_t i = (type == LDOT ? 4 : 3); i < line.size(); i++) {
+                if (line[i] == "rows" || line[i] == "cols") {
+                    (*mode)[0] = line[i][0];
+                } else if (line[i] == "exclusive") {
+                    (*mode)[1] = 'e';
+                } else if (line[i] == "kahan") {
+                    (*mode)[2] = 'k';
+                }
+            }
+            if ((*mode)[0] != 'a' && !matrix) {
+                std::cerr << "Error: <" << line[2] << "> rows and cols require a matrix." << std::endl;
+                exit(0);
+            }
+            if (type == LSCAN) {
+                if ((*mode)[0] == 'a' && matrix) {
+                    (*mode)[0] = 'r';
+                }
+                child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            } else if ((*mode)[0] == 'a') {
+                tmpNod1->type = VARLIST;
+                tmpNod1->expression = varparse<T>(line[1]);
+                child->children.push_back(tmpNod1);
+            } else {
+                child->children.push_back(makeContainerNode<T>(line[1], false));
+            }
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+            if (type == LDOT) {
+                child->children.push_back(makeContainerNode<T>(line[3], matrix));
+            }
+            tmpNod3->type = STRING;
+            tmpNod3->value = mode;
+            child->children.push_back(tmpNod3);
+        } else if (value == "lsort" || value == "lsortidx") {
+            type = value == "lsort" ? LSORT : LSORTIDX;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+            tmpNod3->type = STRING;
+            tmpNod3->value = new std::string(line.size() > 3 ? line[3] : "asc");
+            child->children.push_back(tmpNod3);
+        } else if (value == "lbsearch") {
+            type = LBSEARCH;
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = varparse<T>(line[1]);
+            tmpNod3->type = EXPRESSION;
+            tmpNod3->expression = mathparse<T>(line[3]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+            child->children.push_back(tmpNod3);
+        } else if (value == "lunique") {
+            type = LUNIQUE;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+        } else if (value == "lunion" || value == "lintersect") {
+            type = value == "lunion" ? LUNION : LINTERSECT;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeContainerNode<T>(line[2], false));
+            child->children.push_back(makeContainerNode<T>(line[3], false));
+        } else if (value == "cdict") {
+            type = CDICT;
+            child->children.push_back(makeDictNode<T>(line[1], true));
+        } else if (value == "dset") {
+            type = DSET;
+            child->children.push_back(makeDictNode<T>(line[1], false));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+            child->children.push_back(makeExpressionNode<T>(line[3]));
+        } else if (value == "ddel") {
+            type = DDEL;
+            child->children.push_back(makeDictNode<T>(line[1], false));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+        } else if (value == "dget" || value == "dhas" || value == "dlen") {
+            type = value == "dget" ? DGET : value == "dhas" ? DHAS : DLEN;
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = varparse<T>(line[1]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeDictNode<T>(line[2], false));
+            for (size_t i = 3; i < line.size(); i++) {
+                child->children.push_back(makeExpressionNode<T>(line[i])); // key and default value of dget
+            }
+        } else if (value == "cheap") {
+            type = CHEAP;
+            child->children.push_back(makeHeapNode<T>(line[1], true));
+        } else if (value == "hpush") {
+            type = HPUSH;
+            child->children.push_back(makeExpressionNode<T>(line[1]));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+            child->children.push_back(makeHeapNode<T>(line[3], false));
+        } else if (value == "hpop" || value == "hpeek" || value == "hlen") {
+            type = value == "hpop" ? HPOP : value == "hpeek" ? HPEEK : HLEN;
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = varparse<T>(line[1]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeHeapNode<T>(line[2], false));
+            if (line.size() > 3) {
+                tmpNod2->type = VARLIST;
+                tmpNod2->expression = varparse<T>(line[3]); // target for the priority of hpop and hpeek
+                child->children.push_back(tmpNod2);
+            }
+        } else if (value == "cbmat") {
+            type = CBMAT;
+            child->children.push_back(makeBitMatrixNode<T>(line[1], true));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+            child->children.push_back(makeExpressionNode<T>(line[3]));
+        } else if (value == "bmand" || value == "bmor" || value == "bmxor") {
+            type = value == "bmand" ? BMAND : value == "bmor" ? BMOR : BMXOR;
+            child->children.push_back(makeBitMatrixNode<T>(line[1], false));
+            child->children.push_back(makeBitMatrixNode<T>(line[2], false));
+            child->children.push_back(makeBitMatrixNode<T>(line[3], false));
+        } else if (value == "bmnot") {
+            type = BMNOT;
+            child->children.push_back(makeBitMatrixNode<T>(line[1], false));
+            child->children.push_back(makeBitMatrixNode<T>(line[2], false));
+        } else if (value == "bmcount") {
+            type = BMCOUNT;
+            tmpNod1->type = VARLIST;
+            tmpNod1->expression = varparse<T>(line[1]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeBitMatrixNode<T>(line[2], false));
+        } else if (value == "bmneigh") {
+            type = BMNEIGH;
+            child->children.push_back(makeBitMatrixNode<T>(line[1], false));
+            child->children.push_back(makeBitMatrixNode<T>(line[2], false));
+            tmpNod3->type = STRING;
+            tmpNod3->value = new std::string(line[3]); // numbers of neighbours as digits
+            child->children.push_back(tmpNod3);
+        } else if (value == "csparse") {
+            type = CSPARSE;
+            child->children.push_back(makeSparseNode<T>(line[1], true));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+            child->children.push_back(makeExpressionNode<T>(line[3]));
+            for (size_t i = 4; i < line.size(); i++) {
+                child->children.push_back(makeContainerNode<T>(line[i], false)); // rows, columns and values of the entries
+            }
+        } else if (value == "spmv") {
+            type = SPMV;
+            child->children.push_back(makeContainerNode<T>(line[1], false));
+            child->children.push_back(makeSparseNode<T>(line[2], false));
+            child->children.push_back(makeContainerNode<T>(line[3], false));
+        } else if (value == "lswap" || value == "mswap" || value == "lcopy" || value == "mcopy") {
+            type = value == "lswap" ? LSWAP : value == "mswap" ? MSWAP : value == "lcopy" ? LCOPY : MCOPY;
+            bool matrix = value[0] == 'm';
+            child->children.push_back(makeContainerNode<T>(line[1], matrix));
+            child->children.push_back(makeContainerNode<T>(line[2], matrix));
+        } else if (value == "lfill" || value == "mfill") {
+            type = value == "lfill" ? LFILL : MFILL;
+            child->children.push_back(makeContainerNode<T>(line[1], value == "mfill"));
+            child->children.push_back(makeExpressionNode<T>(line[2]));
+        } else if (value == "mview") {
+            type = MVIEW;
+            tmpNod1->type = MATIDENT;
+            tmpNod1->value = makeMatrixEntry<T>(line[1]);
+            ((Matrix<T>*)tmpNod1->value)->view = true;
+            child->children.push_back(tmpNod1);
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+            for (size_t i = 3; i < 7; i++) {
+                child->children.push_back(makeExpressionNode<T>(line[i])); // first row and column, rows and columns of the block
+            }
+        } else if (value == "mmat") {
+            type = MMAT;
+            tmpNod1->type = MATIDENT;
+            tmpNod1->value = makeMatrixEntry<T>(line[1]);
+            tmpNod2->type = STRING;
+            tmpNod2->value = new std::string(line[2]);
+            child->children.push_back(tmpNod1);
+            child->children.push_back(tmpNod2);
+            child->children.push_back(makeExpressionNode<T>(line[3]));
+            child->children.push_back(makeExpressionNode<T>(line[4]));
+        } else if (value == "stencil") {
+            type = STENCIL;
+            child->children.push_back(makeContainerNode<T>(line[1], true));
+            child->children.push_back(makeContainerNode<T>(line[2], true));
+            child->children.push_back(makeContainerNode<T>(line[3], true));
+            tmpNod3->type = STRING;
+            tmpNod3->value = new std::string(line.size() > 4 ? line[4] : "zero"); // values outside the matrix
+            child->children.push_back(tmpNod3);
         } else if (value == "call") {
             type = CALL;
             tmpNod1->type = STRING;
@@ -586,13 +1177,22 @@ Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startL
             *apStr = line[1];
             tmpNod1->value = apStr;
             child->children.push_back(tmpNod1);
+        } else if (value == "spawn") {
+            type = SPAWN;
+            tmpNod1->type = STRING;
+            std::string* apStr = new std::string;
+            *apStr = line[1];
+            tmpNod1->value = apStr;
+            child->children.push_back(tmpNod1);
+        } else if (value == "join") {
+            type = JOIN;
         } else if (value == "sloop") {
             type = SLOOP;
-            MathNode* expr = mathparse(line[1]);
+            MathNode* expr = mathparse<T>(line[1]);
             tmpNod1->type = EXPRESSION;
             tmpNod1->expression = expr;
             tmpNod2->type = EXEC;
-            tmpNod2->children = parseTree(tokens, currentLine + 1)->children;
+            tmpNod2->children = parseTree<T>(tokens, currentLine + 1)->children;
             currentLine = rLine;
             child->children.push_back(tmpNod1);
             child->children.push_back(tmpNod2);
@@ -624,6 +1224,27 @@ void printMathTree(MathNode* root, int level) {
         case MathNodeType::Matrix:
             std::cout << "MAT <" << root->variable << ">" << std::endl;
             break;
+        case MathNodeType::WholeList:
+            std::cout << "LIST <" << root->variable << ">" << std::endl;
+            break;
+        case MathNodeType::WholeMatrix:
+            std::cout << "MATRIX <" << root->variable << ">" << std::endl;
+            break;
+        case MathNodeType::Select:
+            std::cout << "WHERE" << std::endl;
+            break;
+        case MathNodeType::Dict:
+            std::cout << "DICT <" << root->variable << ">" << std::endl;
+            break;
+        case MathNodeType::BitMatrix:
+            std::cout << "BITS <" << root->variable << ">" << std::endl;
+            break;
+        case MathNodeType::Typed:
+            std::cout << "TYPED <" << root->variable << ">" << std::endl;
+            break;
+        case MathNodeType::Sparse:
+            std::cout << "SPARSE <" << root->variable << ">" << std::endl;
+            break;
     }
 
     int i = 0;
@@ -631,7 +1252,8 @@ void printMathTree(MathNode* root, int level) {
         for (int j = 0; j < level; j++) {
             std::cout << "   ";
         }
-        if(root->type == MathNodeType::Array || root->type == MathNodeType::Matrix){
+        if(root->type == MathNodeType::Array || root->type == MathNodeType::Matrix || root->type == MathNodeType::Dict || root->type == MathNodeType::BitMatrix
+           || root->type == MathNodeType::Typed || root->type == MathNodeType::Sparse){
             std::cout << "`--";
         }else{
             std::cout << "|--";
@@ -643,10 +1265,18 @@ void printMathTree(MathNode* root, int level) {
         for (int j = 0; j < level; j++) {
             std::cout << "   ";
         }
-        std::cout << "`--";
+        std::cout << (root->otherwise != nullptr ? "|--" : "`--");
         printMathTree(root->right, level + 1);
         i++;
     }
+    if (root->otherwise != nullptr) {
+        for (int j = 0; j < level; j++) {
+            std::cout << "   ";
+        }
+        std::cout << "`--";
+        printMathTree(root->otherwise, level + 1);
+        i++;
+    }
 }
 
 //! Print the Parsed Tree Recursively
@@ -656,6 +1286,9 @@ void printTree(Node* root, int level) {
         case SET:
             std::cout << "SET" << std::endl;
             break;
+        case SETARRAY:
+            std::cout << "SET (WHOLE ARRAY)" << std::endl;
+            break;
         case CVAR:
             std::cout << "CVAR" << std::endl;
             break;
@@ -668,6 +1301,9 @@ void printTree(Node* root, int level) {
         case AUTOLOOP:
             std::cout << "AUTOLOOP" << std::endl;
             break;
+        case PLOOP:
+            std::cout << "PLOOP" << std::endl;
+            break;
         case WHILE:
             std::cout << "WHILE" << std::endl;
             break;
@@ -759,6 +1395,21 @@ void printTree(Node* root, int level) {
         case MATIDENT:
             std::cout << "MATID" << std::endl;
             break;
+        case DICTIDENT:
+            std::cout << "DICTID" << std::endl;
+            break;
+        case HEAPIDENT:
+            std::cout << "HEAPID" << std::endl;
+            break;
+        case BMATIDENT:
+            std::cout << "BMATID" << std::endl;
+            break;
+        case TYPEDIDENT:
+            std::cout << "TYPEDID" << std::endl;
+            break;
+        case SPARSEIDENT:
+            std::cout << "SPARSEID" << std::endl;
+            break;
         case INPUT:
             std::cout << "INPUT" << std::endl;
             break;
@@ -828,6 +1479,168 @@ void printTree(Node* root, int level) {
         case CALL:
             std::cout << "CALL" << std::endl;
             break;
+        case SPAWN:
+            std::cout << "SPAWN" << std::endl;
+            break;
+        case MATMUL:
+            std::cout << "MATMUL" << std::endl;
+            break;
+        case MSOLVE:
+            std::cout << "MSOLVE" << std::endl;
+            break;
+        case MDET:
+            std::cout << "MDET" << std::endl;
+            break;
+        case MINV:
+            std::cout << "MINV" << std::endl;
+            break;
+        case MTRANS:
+            std::cout << "MTRANS" << std::endl;
+            break;
+        case MLU:
+            std::cout << "MLU" << std::endl;
+            break;
+        case FFT:
+            std::cout << "FFT" << std::endl;
+            break;
+        case IFFT:
+            std::cout << "IFFT" << std::endl;
+            break;
+        case LCONV:
+            std::cout << "LCONV" << std::endl;
+            break;
+        case STENCIL:
+            std::cout << "STENCIL" << std::endl;
+            break;
+        case LSUM:
+            std::cout << "LSUM" << std::endl;
+            break;
+        case LMIN:
+            std::cout << "LMIN" << std::endl;
+            break;
+        case LMAX:
+            std::cout << "LMAX" << std::endl;
+            break;
+        case LARGMAX:
+            std::cout << "LARGMAX" << std::endl;
+            break;
+        case LMEAN:
+            std::cout << "LMEAN" << std::endl;
+            break;
+        case LVAR:
+            std::cout << "LVAR" << std::endl;
+            break;
+        case LDOT:
+            std::cout << "LDOT" << std::endl;
+            break;
+        case LSCAN:
+            std::cout << "LSCAN" << std::endl;
+            break;
+        case LSORT:
+            std::cout << "LSORT" << std::endl;
+            break;
+        case LSORTIDX:
+            std::cout << "LSORTIDX" << std::endl;
+            break;
+        case LBSEARCH:
+            std::cout << "LBSEARCH" << std::endl;
+            break;
+        case LUNIQUE:
+            std::cout << "LUNIQUE" << std::endl;
+            break;
+        case LUNION:
+            std::cout << "LUNION" << std::endl;
+            break;
+        case LINTERSECT:
+            std::cout << "LINTERSECT" << std::endl;
+            break;
+        case CDICT:
+            std::cout << "CDICT" << std::endl;
+            break;
+        case DSET:
+            std::cout << "DSET" << std::endl;
+            break;
+        case DGET:
+            std::cout << "DGET" << std::endl;
+            break;
+        case DHAS:
+            std::cout << "DHAS" << std::endl;
+            break;
+        case DDEL:
+            std::cout << "DDEL" << std::endl;
+            break;
+        case DLEN:
+            std::cout << "DLEN" << std::endl;
+            break;
+        case CHEAP:
+            std::cout << "CHEAP" << std::endl;
+            break;
+        case HPUSH:
+            std::cout << "HPUSH" << std::endl;
+            break;
+        case HPOP:
+            std::cout << "HPOP" << std::endl;
+            break;
+        case HPEEK:
+            std::cout << "HPEEK" << std::endl;
+            break;
+        case HLEN:
+            std::cout << "HLEN" << std::endl;
+            break;
+        case CBMAT:
+            std::cout << "CBMAT" << std::endl;
+            break;
+        case BMAND:
+            std::cout << "BMAND" << std::endl;
+            break;
+        case BMOR:
+            std::cout << "BMOR" << std::endl;
+            break;
+        case BMXOR:
+            std::cout << "BMXOR" << std::endl;
+            break;
+        case BMNOT:
+            std::cout << "BMNOT" << std::endl;
+            break;
+        case BMCOUNT:
+            std::cout << "BMCOUNT" << std::endl;
+            break;
+        case BMNEIGH:
+            std::cout << "BMNEIGH" << std::endl;
+            break;
+        case CSPARSE:
+            std::cout << "CSPARSE" << std::endl;
+            break;
+        case SPMV:
+            std::cout << "SPMV" << std::endl;
+            break;
+        case LSWAP:
+            std::cout << "LSWAP" << std::endl;
+            break;
+        case MSWAP:
+            std::cout << "MSWAP" << std::endl;
+            break;
+        case LCOPY:
+            std::cout << "LCOPY" << std::endl;
+            break;
+        case MCOPY:
+            std::cout << "MCOPY" << std::endl;
+            break;
+        case LFILL:
+            std::cout << "LFILL" << std::endl;
+            break;
+        case MFILL:
+            std::cout << "MFILL" << std::endl;
+            break;
+        case MVIEW:
+            std::cout << "MVIEW" << std::endl;
+            break;
+        case MMAT:
+            std::cout << "MMAT" << std::endl;
+            break;
+        case JOIN:
+            std::cout << "JOIN" << std::endl;
+            break;
         case ABS:
             std::cout << "ABS" << std::endl;
             break;
@@ -846,6 +1659,52 @@ void printTree(Node* root, int level) {
         case SLEEP:
             std::cout << "SLEEP" << std::endl;
             break;
+        case LADD:
+        case MADD:
+            std::cout << "ADD (ELEMENTWISE)" << std::endl;
+            break;
+        case LSUB:
+        case MSUB:
+            std::cout << "SUB (ELEMENTWISE)" << std::endl;
+            break;
+        case LMUL:
+        case MMUL:
+            std::cout << "MUL (ELEMENTWISE)" << std::endl;
+            break;
+        case LDIV:
+        case MDIV:
+            std::cout << "DIV (ELEMENTWISE)" << std::endl;
+            break;
+        case LAXPY:
+        case MAXPY:
+            std::cout << "AXPY" << std::endl;
+            break;
+        case LCLAMP:
+        case MCLAMP:
+            std::cout << "CLAMP" << std::endl;
+            break;
+        case VSIN:
+            std::cout << "VSIN" << std::endl;
+            break;
+        case VCOS:
+            std::cout << "VCOS" << std::endl;
+            break;
+        case VTAN:
+            std::cout << "VTAN" << std::endl;
+            break;
+        case VEXP:
+            std::cout << "VEXP" << std::endl;
+            break;
+        case VLOG:
+            std::cout << "VLOG" << std::endl;
+            break;
+        case VXROOT:
+            std::cout << "VXROOT" << std::endl;
+            break;
+        case LCMP:
+        case MCMP:
+            std::cout << "CMP <" << *(std::string*)root->children[2]->value << ">" << std::endl;
+            break;
     }
 
     int i = 0;
@@ -869,3 +1728,8 @@ void printTreeRoot(Node* root){
     printTree(root, 0);
     std::cout << std::endl;
 }
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template Node* parseTree<double>(const std::vector<std::vector<std::string> >& tokens, int startLine);
+template Node* parseTree<long double>(const std::vector<std::vector<std::string> >& tokens, int startLine);
@@ -6,20 +6,25 @@
  */
 
 #include "Recurser.h"
+#include "Jit.h"
+#include "Parallel.h"
 #include <chrono>
 #include <thread>
 
 // GLOBAL VARIABLES
 std::unordered_map<std::string, Node*> funcs; // global map for all functions
-bool if_state = false; // was the previous if or elif false --> enables execution of next elif or else
+thread_local bool if_state = false; // was the previous if or elif false --> enables execution of next elif or else
+thread_local std::ostream* out_stream = &std::cout; // output of the print commands (buffered per chunk inside ploop)
 
+template<typename T>
 int execute(Node* node);
 
 // DEFINED CONSTANTS ################################################################
 
 //! Predefined Constants
+template<typename T>
 void load_math_const(){
-    auto predefined = new std::vector<long double>(7);
+    auto predefined = new std::vector<T>(7);
     (*predefined)[0] = 3.14159265358979323846264338327;
     (*predefined)[1] = 2.7182818284590452353602874713527;
     (*predefined)[2] = 1.414213562373095048801688724209698078569;
@@ -28,36 +33,65 @@ void load_math_const(){
     (*predefined)[5] = 1.6180339887498948482045868343656381177203091798057;
     (*predefined)[6] = 1.202056903159594285399738161511449990764986292;
 
-    vars["cpi"] = (*predefined).data();
-    vars["ce"] = (*predefined).data() + 1;
-    vars["csqr2"] = (*predefined).data() + 2;
-    vars["csqr3"] = (*predefined).data() + 3;
-    vars["cemas"] = (*predefined).data() + 4;
-    vars["cproa"] = (*predefined).data() + 5;
-    vars["capry"] = (*predefined).data() + 6;
+    vars<T>["cpi"] = (*predefined).data();
+    vars<T>["ce"] = (*predefined).data() + 1;
+    vars<T>["csqr2"] = (*predefined).data() + 2;
+    vars<T>["csqr3"] = (*predefined).data() + 3;
+    vars<T>["cemas"] = (*predefined).data() + 4;
+    vars<T>["cproa"] = (*predefined).data() + 5;
+    vars<T>["capry"] = (*predefined).data() + 6;
 }
 
 // AUXILIARY FUNCTIONS ##############################################################
 
 //! Set the Value of a Variable, List or Matrix MathNode
-inline void setVarListEntry(MathNode* varlist, long double value){
+template<typename T>
+inline void setVarListEntry(MathNode* varlist, T value){
     if(varlist->type == MathNodeType::Variable){
-        *(long double*)varlist->variable = value;
+        *(T*)varlist->variable = value;
     }else if(varlist->type == MathNodeType::Array){
-        auto list = reinterpret_cast<std::vector<long double>*>(varlist->variable);
-        auto i = (int)(calculateExpression(varlist->left));
+        auto list = reinterpret_cast<std::vector<T>*>(varlist->variable);
+        auto i = (int)(calculateExpression<T>(varlist->left));
         if(list->size() > i){
             (*list)[i] = value;
         }else{
             std::cerr << "Error: Index out of bounds for list <" << varlist->variable << "> at index <" << i << ">." << std::endl;
             exit(0);
         }
+    }else if(varlist->type == MathNodeType::Typed){
+        auto array = reinterpret_cast<TypedArray*>(varlist->variable);
+        auto i1 = (int)(calculateExpression<T>(varlist->left));
+        if(!array->matrix){
+            if(!array->contains(i1)){
+                std::cerr << "Error: Index out of bounds for list <" << varlist->variable << "> at index <" << i1 << ">." << std::endl;
+                exit(0);
+            }
+            typedStore(array, i1, value);
+            return;
+        }
+        auto i2 = (int)(calculateExpression<T>(varlist->right));
+        if(array->contains(i1, i2)){
+            typedStore(array, i1 * array->cols + i2, value);
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << varlist->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
+    }else if(varlist->type == MathNodeType::BitMatrix){
+        auto bits = reinterpret_cast<BitMatrix*>(varlist->variable);
+        auto i1 = (int)(calculateExpression<T>(varlist->left));
+        auto i2 = (int)(calculateExpression<T>(varlist->right));
+        if(bits->contains(i1, i2)){
+            bits->set(i1, i2, value > 0); // like a condition: values larger than 0 are 1
+        }else{
+            std::cerr << "Error: Index out of bounds for matrix <" << varlist->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+            exit(0);
+        }
     }else{
-        auto mat = reinterpret_cast<std::vector<std::vector<long double>*>*>(varlist->variable);
-        auto i1 = (int)(calculateExpression(varlist->left));
-        auto i2 = (int)(calculateExpression(varlist->right));
-        if(i1 < mat->size() && i2 < (*(*mat)[i1]).size()){
-            (*(*mat)[i1])[i2] = value;
+        auto mat = reinterpret_cast<Matrix<T>*>(varlist->variable);
+        auto i1 = (int)(calculateExpression<T>(varlist->left));
+        auto i2 = (int)(calculateExpression<T>(varlist->right));
+        if(mat->contains(i1, i2)){
+            mat->at(i1, i2) = value;
         }else{
             std::cerr << "Error: Index out of bounds for matrix <" << varlist->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
             exit(0);
@@ -77,12 +111,15 @@ inline std::string removeSpaces(std::string const& str) {
 }
 
 //! Get the Value of a Variable, List or Matrix MathNode
-inline long double getVarListEntry(MathNode* varlist){
+template<typename T>
+inline T getVarListEntry(MathNode* varlist){
     if(varlist->type == MathNodeType::Variable){
-        return *(long double*)varlist->variable;
+        return *(T*)varlist->variable;
+    }else if(varlist->type == MathNodeType::BitMatrix || varlist->type == MathNodeType::Typed){
+        return calculateExpression<T>(varlist);
     }else if(varlist->type == MathNodeType::Array){
-        auto list = reinterpret_cast<std::vector<long double>*>(varlist->variable);
-        auto i = (int)(calculateExpression(varlist->left));
+        auto list = reinterpret_cast<std::vector<T>*>(varlist->variable);
+        auto i = (int)(calculateExpression<T>(varlist->left));
         if(list->size() > i){
             return (*list)[i];
         }else{
@@ -90,11 +127,11 @@ inline long double getVarListEntry(MathNode* varlist){
             exit(0);
         }
     }else{
-        auto mat = reinterpret_cast<std::vector<std::vector<long double>*>*>(varlist->variable);
-        auto i1 = (int)(calculateExpression(varlist->left));
-        auto i2 = (int)(calculateExpression(varlist->right));
-        if(i1 < mat->size() && i2 < (*(*mat)[i1]).size()){
-            return (*(*mat)[i1])[i2];
+        auto mat = reinterpret_cast<Matrix<T>*>(varlist->variable);
+        auto i1 = (int)(calculateExpression<T>(varlist->left));
+        auto i2 = (int)(calculateExpression<T>(varlist->right));
+        if(mat->contains(i1, i2)){
+            return mat->at(i1, i2);
         }else{
             std::cerr << "Error: Index out of bounds for matrix <" << varlist->variable << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
             exit(0);
@@ -103,112 +140,134 @@ inline long double getVarListEntry(MathNode* varlist){
 }
 
 //! Round Value of Variable to Specific Precision
-inline long double round_to(long double value, long double precision) {
+template<typename T>
+inline T round_to(T value, T precision) {
     return round(value / precision) * precision;
 }
 
 // COMMAND FUNCTIONS ##############################################################
 
 //! Command: Define A Single Variable (CVAR)
-inline void command_cvar(long double* varname, MathNode* expression){
-    *varname = calculateExpression(expression);
+template<typename T>
+inline void command_cvar(T* varname, MathNode* expression){
+    *varname = calculateExpression<T>(expression);
 }
 
 //! Command: Define Multiple Variables (MVAR)
-inline void command_mvar(std::vector<long double*>* variables, MathNode* val){
-    long double tmp_val = calculateExpression(val);
-    for(long double* svars : *variables){
+template<typename T>
+inline void command_mvar(std::vector<T*>* variables, MathNode* val){
+    T tmp_val = calculateExpression<T>(val);
+    for(T* svars : *variables){
         *svars = tmp_val;
     }
 }
 
 //! Command: Define A List (CLIST)
-inline void command_clist(std::vector<long double>* listid, MathNode* expression){
-    listid->resize((int)calculateExpression(expression));
+template<typename T>
+inline void command_clist(std::vector<T>* listid, MathNode* expression){
+    listid->resize((int)calculateExpression<T>(expression));
 }
 
 //! Command: Define A Matrix (CMAT)
-inline void command_cmat(std::vector<std::vector<long double>* >* matid, MathNode* dim1, MathNode* dim2){
-    for(int i = 0; i < (int)calculateExpression(dim1); i++){
-        auto vct = new std::vector<long double>((int)calculateExpression(dim2));
-        matid->push_back(vct);
-    }
+template<typename T>
+inline void command_cmat(Matrix<T>* matid, MathNode* dim1, MathNode* dim2){
+    int rows = (int)calculateExpression<T>(dim1);
+    int cols = (int)calculateExpression<T>(dim2);
+    matid->resize(std::max(rows, 0), std::max(cols, 0));
 }
 
 //! Command: Assign A Value to Variable or Matrix / List Entry (SET)
+template<typename T>
 inline void command_set(MathNode* varlist, MathNode* expression){
-    setVarListEntry(varlist,calculateExpression(expression));
+    setVarListEntry<T>(varlist,calculateExpression<T>(expression));
+}
+
+//! Command: Assign an Expression to All Entries of a List / Matrix (SETARRAY)
+template<typename T>
+inline void command_setarray(void* target, const ArrayProgram<T>* program){
+    assignArrayExpression<T>(program, target);
 }
 
 //! Command: Round Value of Variable Up (CEIL)
+template<typename T>
 inline void command_ceil(MathNode* varlist){
-    setVarListEntry(varlist, ceil(getVarListEntry(varlist)));
+    setVarListEntry<T>(varlist, ceil(getVarListEntry<T>(varlist)));
 }
 
 //! Command: Round Value of Variable Off (FLOOR)
+template<typename T>
 inline void command_floor(MathNode* varlist){
-    setVarListEntry(varlist, floor(getVarListEntry(varlist)));
+    setVarListEntry<T>(varlist, floor(getVarListEntry<T>(varlist)));
 }
 
 //! Command: Get Absolute Value of Variable (ABS)
+template<typename T>
 inline void command_abs(MathNode* varlist){
-    setVarListEntry(varlist, abs(getVarListEntry(varlist)));
+    setVarListEntry<T>(varlist, abs(getVarListEntry<T>(varlist)));
 }
 
 //! Command: Round Value to Specicic Accuracy (ROUND)
+template<typename T>
 inline void command_round(MathNode* varlist, MathNode* precision){
-    long double prec = calculateExpression(precision);
-    setVarListEntry(varlist, round_to(getVarListEntry(varlist),prec));
+    T prec = calculateExpression<T>(precision);
+    setVarListEntry<T>(varlist, round_to<T>(getVarListEntry<T>(varlist),prec));
 }
 
 //! Command: Print String and Break Line (PRINT)
 inline void command_print(const std::string& stri){
     std::string str = extract_string(stri);
-    std::cout << str << std::endl;
+    *out_stream << str << std::endl;
 }
 
 //! Command: Print String Without Breaking The Line (PRINTB)
 inline void command_printb(const std::string& stri){
     std::string str = extract_string(stri);
-    std::cout << str;
+    *out_stream << str;
 }
 
 //! Command: Print Value of Variable (PRINTV)
+template<typename T>
 inline void command_printv(MathNode* expression) {
-    std::cout << calculateExpression(expression); // print output of processed expression
+    *out_stream << calculateExpression<T>(expression); // print output of processed expression
 }
 
 //! Command: Print Matrix to Screen (PRINTM)
-inline void command_printm(std::vector<std::vector<long double>*>* matrix) {
-    for(auto row : *matrix){
-        for(auto val : *row){
-            std::cout << val << " ";
+template<typename T>
+inline void command_printm(Matrix<T>* matrix) {
+    for(size_t i = 0; i < matrix->rows; i++){
+        const T* row = matrix->row(i);
+        for(size_t j = 0; j < matrix->cols; j++){
+            *out_stream << row[j] << " ";
         }
-        std::cout << std::endl;
+        *out_stream << std::endl;
     }
 }
 
 //! Command: Increment Value of Variable (INC)
+template<typename T>
 inline void command_inc(MathNode* varlist) {
-    setVarListEntry(varlist, getVarListEntry(varlist) + 1);
+    setVarListEntry<T>(varlist, getVarListEntry<T>(varlist) + 1);
 }
 
 //! Command: Decrement Value of Variable (DEC)
+template<typename T>
 inline void command_dec(MathNode* varlist) {
-    setVarListEntry(varlist, getVarListEntry(varlist) - 1);
+    setVarListEntry<T>(varlist, getVarListEntry<T>(varlist) - 1);
 }
 
 //! Command: Get Input from CLI and Save to Variable (INPUT)
+template<typename T>
 inline void command_input(MathNode* varlist) {
-    long double inputval;
+    T inputval;
     std::cin >> inputval;
-    setVarListEntry(varlist, inputval);
+    setVarListEntry<T>(varlist, inputval);
 }
 
 //! Command: Calculate Trigonometric Function and Save to Target (TRIG)
+template<typename T>
 inline void command_trig(MathNode* varlist, MathNode* source, TokenType func){
-    long double inpVal = calculateExpression(source); // get x
-    long double outVal;
+    T inpVal = calculateExpression<T>(source); // get x
+    T outVal;
     if(func == SIN){
         outVal = sin(inpVal);
     }else if(func == COS){
@@ -240,34 +299,79 @@ inline void command_trig(MathNode* varlist, MathNode* source, TokenType func){
         }
         outVal = atan(inpVal);
     }
-    setVarListEntry(varlist, outVal);
+    setVarListEntry<T>(varlist, outVal);
 }
 
 //! Command: Save the Length of a List (GETL)
-inline void command_getl(MathNode* varlist, std::vector<long double>* listid){
-    setVarListEntry(varlist, (long double)listid->size());
+template<typename T>
+inline void command_getl(MathNode* varlist, std::vector<T>* listid){
+    setVarListEntry<T>(varlist, (T)listid->size());
 }
 
 //! Command: Save the Dimensions of a Matrix (GETDIM)
-inline void command_getdim(MathNode* rows, MathNode* columns, std::vector<std::vector<long double>*>* listid){
-    setVarListEntry(rows, (long double)listid->size());
-    setVarListEntry(columns, (long double)((*listid)[0])->size());
+template<typename T>
+inline void command_getdim(MathNode* rows, MathNode* columns, Matrix<T>* matid){
+    setVarListEntry<T>(rows, (T)matid->rows);
+    setVarListEntry<T>(columns, (T)matid->cols);
+}
+
+//! Command: The List and Matrix Commands for a Typed List or Matrix (CLIST, CMAT, GETL, GETDIM, PUSH, POP, CHSL, READF, WRITEF)
+template<typename T>
+inline void command_typed(Node* statement){
+    const auto& children = statement->children;
+    switch(statement->type){
+        case CLIST:
+        case CHSL: {
+            int length = (int)calculateExpression<T>(children[1]->expression);
+            ((TypedArray*)children[0]->value)->resize(std::max(length, 0));
+            break;
+        }
+        case CMAT: {
+            int rows = (int)calculateExpression<T>(children[1]->expression);
+            int cols = (int)calculateExpression<T>(children[2]->expression);
+            ((TypedArray*)children[0]->value)->resize(std::max(rows, 0), std::max(cols, 0));
+            break;
+        }
+        case GETL:
+            setVarListEntry<T>(children[0]->expression, (T)((TypedArray*)children[1]->value)->size());
+            break;
+        case GETDIM:
+            setVarListEntry<T>(children[0]->expression, (T)((TypedArray*)children[2]->value)->rows);
+            setVarListEntry<T>(children[1]->expression, (T)((TypedArray*)children[2]->value)->cols);
+            break;
+        case PUSH:
+            typedPush((TypedArray*)children[1]->value, calculateExpression<T>(children[0]->expression));
+            break;
+        case POP:
+            setVarListEntry<T>(children[0]->expression, typedPop<T>((TypedArray*)children[1]->value));
+            break;
+        case READF:
+            read_csv(extract_string(*(std::string*)children[1]->value), (TypedArray*)children[0]->value);
+            break;
+        case WRITEF:
+            write_csv(extract_string(*(std::string*)children[1]->value), (TypedArray*)children[0]->value);
+            break;
+        default:
+            break;
+    }
 }
 
 //! Command: Calculate a Specific Root of the Variable and Save it (XROOT)
+template<typename T>
 inline void command_xroot(MathNode* varlist, MathNode* source, MathNode* root){
-    long double inpVal = calculateExpression(source);
-    long double roottype = calculateExpression(root);
-    long double outVal = pow(inpVal, 1.0/roottype);
-    setVarListEntry(varlist, outVal);
+    T inpVal = calculateExpression<T>(source);
+    T roottype = calculateExpression<T>(root);
+    T outVal = pow(inpVal, 1.0/roottype);
+    setVarListEntry<T>(varlist, outVal);
 }
 
 //! Command: Calculate a Specific Logarithm of the Variable and Save it (LOG)
+template<typename T>
 inline void command_log(MathNode* varlist, MathNode* source, MathNode* exp){ //HERE
-    long double inpVal = calculateExpression(source);
-    long double expVal = calculateExpression(exp);
-    long double outVal = (log10(inpVal)/log10(expVal));
-    setVarListEntry(varlist, outVal);
+    T inpVal = calculateExpression<T>(source);
+    T expVal = calculateExpression<T>(exp);
+    T outVal = (log10(inpVal)/log10(expVal));
+    setVarListEntry<T>(varlist, outVal);
 }
 
 //! Command: Declare a Void Function Without Parameters (FUNCT)
@@ -281,70 +385,380 @@ inline void command_declarefunct(const std::string& identifier, Node* exec_block
 }
 
 //! Command: Pop The Last Value Of a List And Save It To a Variable(POP)
-inline void command_poplist(MathNode* varlist, std::vector<long double>* listid){
-    setVarListEntry(varlist, listid->back());
+template<typename T>
+inline void command_poplist(MathNode* varlist, std::vector<T>* listid){
+    setVarListEntry<T>(varlist, listid->back());
     listid->pop_back();
 }
 
 //! Command: Push A Specific Value to A List (PUSH)
-inline void command_pushlist(MathNode* expr, std::vector<long double>* listid){
-    long double val = calculateExpression(expr);
+template<typename T>
+inline void command_pushlist(MathNode* expr, std::vector<T>* listid){
+    T val = calculateExpression<T>(expr);
     listid->push_back(val);
 }
 
+//! Command: Take the Value with the Smallest Priority of a Heap, and its Priority if Requested (HPOP / HPEEK)
+template<typename T>
+inline void command_heapfront(Node* statement, bool remove){
+    Heap<T>* heap = heapFront((Heap<T>*)statement->children[1]->value);
+    setVarListEntry<T>(statement->children[0]->expression, heap->values[0]);
+    if(statement->children.size() > 2){
+        setVarListEntry<T>(statement->children[2]->expression, heap->priorities[0]);
+    }
+    if(remove){
+        heap->pop();
+    }
+}
+
 //! Command: Change The Size of A List (CHSL)
-inline void command_chsl(MathNode* expr, std::vector<long double>* listid){
-    int new_l = (int)calculateExpression(expr);
+template<typename T>
+inline void command_chsl(MathNode* expr, std::vector<T>* listid){
+    int new_l = (int)calculateExpression<T>(expr);
     listid->resize(new_l);
 }
 
 //! Command: Define a List With Predefined Values (LDEF)
-inline void command_ldef(std::vector<long double>* listid, std::string* stri){
+template<typename T>
+inline void command_ldef(std::vector<T>* listid, std::string* stri){
     std::string content = removeSpaces(extract_list_string(*stri));
     parse_numbers(content,listid);
 }
 
 //! Command: Define a Matrix With Predefined Values (MDEF)
-inline void command_mdef(std::vector<std::vector<long double>* >* matid, std::string* stri){
+template<typename T>
+inline void command_mdef(Matrix<T>* matid, std::string* stri){
     parse_matrix(*stri,matid);
 }
 
 //! Command: Read a CSV File and Save it to a Matrix (READF)
-inline void command_readf(std::vector<std::vector<long double>*>* listid, std::string* filename){
+template<typename T>
+inline void command_readf(Matrix<T>* listid, std::string* filename){
     std::string filepath = extract_string(*filename);
     read_csv(filepath,listid);
 }
 
 //! Command: Write a Matrix to a CSV File (WRITEF)
-inline void command_writef(std::vector<std::vector<long double>*>* listid, std::string* filename){
+template<typename T>
+inline void command_writef(Matrix<T>* listid, std::string* filename){
     std::string filepath = extract_string(*filename);
     write_csv(filepath,listid);
 }
 
 //! Command: Define a Random Value in the Closed Interval From Max to Min and Save it to a Variable (RANDOM)
+template<typename T>
 inline void command_random(MathNode* varlist, MathNode* max, MathNode* min){
     std::random_device rd;
     std::seed_seq seed{ rd(), static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()) };
     std::mt19937_64 eng(seed);
-    std::uniform_real_distribution<long double> distr(calculateExpression(min), calculateExpression(max));
-    setVarListEntry(varlist,distr(eng));
+    std::uniform_real_distribution<T> distr(calculateExpression<T>(min), calculateExpression<T>(max));
+    setVarListEntry<T>(varlist,distr(eng));
 }
 
 //! Command: Sleep for a defined amount of ms (SLEEP)
+template<typename T>
 inline void command_sleep(MathNode* expr){
-    std::this_thread::sleep_for(std::chrono::milliseconds(size_t(calculateExpression(expr))));
+    std::this_thread::sleep_for(std::chrono::milliseconds(size_t(calculateExpression<T>(expr))));
+}
+
+//! Command: Elementwise Operation of Two Lists / Matrices or of a List / Matrix and a Value (LADD, LSUB, LMUL, LDIV, ...)
+template<typename T, typename Op>
+inline void command_elementwise(Node* target, Node* source, Node* operand){
+    if(target->type == MATIDENT){
+        if(operand->type == EXPRESSION){
+            matrixBinaryScalar<Op>((Matrix<T>*)target->value, (Matrix<T>*)source->value, calculateExpression<T>(operand->expression));
+        }else{
+            matrixBinary<Op>((Matrix<T>*)target->value, (Matrix<T>*)source->value, (Matrix<T>*)operand->value);
+        }
+    }else{
+        if(operand->type == EXPRESSION){
+            listBinaryScalar<Op>((std::vector<T>*)target->value, (std::vector<T>*)source->value, calculateExpression<T>(operand->expression));
+        }else{
+            listBinary<Op>((std::vector<T>*)target->value, (std::vector<T>*)source->value, (std::vector<T>*)operand->value);
+        }
+    }
+}
+
+//! Command: Compare Lists / Matrices Elementwise and Save the Mask of Ones and Zeros (LCMP, MCMP)
+template<typename T>
+inline void command_compare(Node* target, Node* source, std::string* op, Node* operand){
+    switch(getComparisonType(*op)){
+        case MathOperatorType::EQ:
+            command_elementwise<T, KernelEq>(target, source, operand);
+            break;
+        case MathOperatorType::NEQ:
+            command_elementwise<T, KernelNeq>(target, source, operand);
+            break;
+        case MathOperatorType::LESS:
+            command_elementwise<T, KernelLess>(target, source, operand);
+            break;
+        case MathOperatorType::LESSEQ:
+            command_elementwise<T, KernelLessEq>(target, source, operand);
+            break;
+        case MathOperatorType::LARGER:
+            command_elementwise<T, KernelLarger>(target, source, operand);
+            break;
+        default:
+            command_elementwise<T, KernelLargerEq>(target, source, operand);
+            break;
+    }
+}
+
+//! Command: Add a Scaled List / Matrix to the Target (LAXPY, MAXPY)
+template<typename T>
+inline void command_axpy(Node* target, MathNode* factor, Node* source){
+    if(target->type == MATIDENT){
+        matrixAxpy((Matrix<T>*)target->value, calculateExpression<T>(factor), (Matrix<T>*)source->value);
+    }else{
+        listAxpy((std::vector<T>*)target->value, calculateExpression<T>(factor), (std::vector<T>*)source->value);
+    }
+}
+
+//! Command: Limit All Entries of a List / Matrix to an Interval (LCLAMP, MCLAMP)
+template<typename T>
+inline void command_clamp(Node* target, Node* source, MathNode* min, MathNode* max){
+    if(target->type == MATIDENT){
+        matrixClamp((Matrix<T>*)target->value, (Matrix<T>*)source->value, calculateExpression<T>(min), calculateExpression<T>(max));
+    }else{
+        listClamp((std::vector<T>*)target->value, (std::vector<T>*)source->value, calculateExpression<T>(min), calculateExpression<T>(max));
+    }
+}
+
+//! Command: Apply a Function to All Entries of a List / Matrix (VSIN, VCOS, VTAN, VEXP, VLOG, VXROOT)
+template<typename T, typename Fn>
+inline void command_vectormath(Node* target, Node* source, const Fn& fn){
+    if(target->type == MATIDENT){
+        matrixMap((Matrix<T>*)target->value, (Matrix<T>*)source->value, fn);
+    }else{
+        listMap((std::vector<T>*)target->value, (std::vector<T>*)source->value, fn);
+    }
+}
+
+//! Runs the Independent Tasks of the Linear Algebra Kernels on the Thread Pool (One After Another Inside a Parallel Loop)
+struct PoolRunner {
+    void operator()(size_t n, const std::function<void(size_t)>& task) const {
+        if(in_parallel || n < 2){
+            SerialRunner()(n, task);
+            return;
+        }
+        threadPool().parallelFor(n, 1, [&](size_t begin, size_t end, int){
+            for(size_t i = begin; i < end; i++){
+                task(i);
+            }
+        });
+    }
+
+    //! Number of Threads the Tasks are Distributed over
+    size_t threads() const { return in_parallel ? 1 : threadPool().size(); }
+};
+
+//! Command: Multiply Two Matrices, Each may be Transposed (MATMUL)
+template<typename T>
+inline void command_matmul(Matrix<T>* target, Matrix<T>* a, Matrix<T>* b, const std::string& mode){
+    PoolRunner run;
+    matrixMultiply(target, a, b, mode[0] == 't', mode[1] == 't', run.threads(), run);
+}
+
+//! Command: Weighted Sum of the Neighbourhood of Every Entry (STENCIL)
+template<typename T>
+inline void command_stencil(Matrix<T>* target, Matrix<T>* source, Matrix<T>* kernel, const std::string& border){
+    PoolRunner run;
+    matrixStencil(target, source, kernel, stencilBorder(border), run.threads(), run);
+}
+
+//! Command: Keep the Entries of a Bit Matrix with one of the Given Numbers of Neighbours that are 1 (BMNEIGH)
+inline void command_bmneigh(BitMatrix* target, BitMatrix* source, const std::string& counts){
+    PoolRunner run;
+    bitsNeighbours(target, source, bitsCounts(counts), run.threads(), run);
+}
+
+//! Command: Build a Sparse Matrix From the Triplet Lists of its Entries, or an Empty One (CSPARSE)
+template<typename T>
+inline void command_csparse(Node* statement){
+    const auto& children = statement->children;
+    int rows = (int)calculateExpression<T>(children[1]->expression);
+    int cols = (int)calculateExpression<T>(children[2]->expression);
+    std::vector<T> none;
+    bool triplets = children.size() == 6;
+    sparseBuild((SparseMatrix<T>*)children[0]->value, std::max(rows, 0), std::max(cols, 0), triplets ? *(std::vector<T>*)children[3]->value : none,
+                triplets ? *(std::vector<T>*)children[4]->value : none, triplets ? *(std::vector<T>*)children[5]->value : none);
+}
+
+//! Command: Let a View Show a Block of a Matrix (MVIEW)
+template<typename T>
+inline void command_mview(Node* statement){
+    const auto& children = statement->children;
+    matrixView((Matrix<T>*)children[0]->value, (Matrix<T>*)children[1]->value, (int)calculateExpression<T>(children[2]->expression),
+               (int)calculateExpression<T>(children[3]->expression), (int)calculateExpression<T>(children[4]->expression),
+               (int)calculateExpression<T>(children[5]->expression));
+}
+
+//! Command: Multiply a Sparse Matrix with a List (SPMV)
+template<typename T>
+inline void command_spmv(std::vector<T>* target, SparseMatrix<T>* matrix, std::vector<T>* source){
+    PoolRunner run;
+    sparseMultiply(target, matrix, source, run.threads(), run);
+}
+
+//! Get the Reduction of a Command
+inline ReduceOp getReduceOp(TokenType type){
+    switch(type){
+        case LMIN: return ReduceOp::MIN;
+        case LMAX: return ReduceOp::MAX;
+        case LARGMAX: return ReduceOp::ARGMAX;
+        case LMEAN: return ReduceOp::MEAN;
+        case LVAR: return ReduceOp::VAR;
+        case LDOT: return ReduceOp::DOT;
+        default: return ReduceOp::SUM;
+    }
+}
+
+//! Command: Reduce a List or Matrix to a Variable, or Every Row or Column of a Matrix to a List (LSUM, LMIN, ..., LDOT)
+template<typename T>
+inline void command_reduce(Node* statement){
+    PoolRunner run;
+    ReduceOp op = getReduceOp(statement->type);
+    Node* target = statement->children[0];
+    Node* a = statement->children[1];
+    Node* b = statement->type == LDOT ? statement->children[2] : nullptr;
+    const std::string& mode = *(std::string*)statement->children.back()->value;
+    bool kahan = mode[2] == 'k';
+    if(a->type == LISTIDENT){
+        T result = reduceList(op, (std::vector<T>*)a->value, b == nullptr ? nullptr : (std::vector<T>*)b->value, kahan, run.threads(), run);
+        setVarListEntry<T>(target->expression, result);
+        return;
+    }
+    Matrix<T>* mb = b == nullptr ? nullptr : (Matrix<T>*)b->value;
+    if(mode[0] == 'r'){
+        reduceRows(op, (std::vector<T>*)target->value, (Matrix<T>*)a->value, mb, kahan, run.threads(), run);
+    }else if(mode[0] == 'c'){
+        reduceCols(op, (std::vector<T>*)target->value, (Matrix<T>*)a->value, mb, kahan, run.threads(), run);
+    }else{
+        setVarListEntry<T>(target->expression, reduceMatrix(op, (Matrix<T>*)a->value, mb, kahan, run.threads(), run));
+    }
+}
+
+//! Command: Prefix Sums of a List, or Along the Rows or Columns of a Matrix (LSCAN)
+template<typename T>
+inline void command_lscan(Node* target, Node* source, const std::string& mode){
+    PoolRunner run;
+    if(target->type == MATIDENT){
+        matrixScan((Matrix<T>*)target->value, (Matrix<T>*)source->value, mode[0] == 'c', mode[1] == 'e', mode[2] == 'k', run.threads(), run);
+    }else{
+        listScan((std::vector<T>*)target->value, (std::vector<T>*)source->value, mode[1] == 'e', mode[2] == 'k', run);
+    }
+}
+
+//! Command: Sort a List, or the Positions of its Entries (LSORT, LSORTIDX)
+template<typename T>
+inline void command_lsort(std::vector<T>* target, std::vector<T>* source, const std::string& order, bool positions){
+    PoolRunner run;
+    if(positions){
+        listSortIndex(target, source, order == "desc", run.threads(), run);
+    }else{
+        listSort(target, source, order == "desc", run.threads(), run);
+    }
+}
+
+//! Command: Distinct Entries of a List, or Union / Intersection of Two Lists (LUNIQUE, LUNION, LINTERSECT)
+template<typename T>
+inline void command_lset(Node* statement){
+    PoolRunner run;
+    std::vector<T>* target = (std::vector<T>*)statement->children[0]->value;
+    std::vector<T>* a = (std::vector<T>*)statement->children[1]->value;
+    if(statement->type == LUNIQUE){
+        listUnique(target, a, run.threads(), run);
+    }else{
+        listSetOperation(target, a, (std::vector<T>*)statement->children[2]->value, statement->type == LINTERSECT, run.threads(), run);
+    }
+}
+
+//! Command: Value of a Key of a Dictionary, or the Default Value if it is Missing (DGET)
+template<typename T>
+inline void command_dget(Node* statement){
+    auto dict = (Dict<T>*)statement->children[1]->value;
+    T key = calculateExpression<T>(statement->children[2]->expression);
+    if(statement->children.size() > 3){
+        setVarListEntry<T>(statement->children[0]->expression, dictGet(dict, key, calculateExpression<T>(statement->children[3]->expression)));
+    }else{
+        setVarListEntry<T>(statement->children[0]->expression, dictGet(dict, key));
+    }
+}
+
+//! Command: Solve a Linear System for a List or for Every Column of a Matrix (MSOLVE)
+template<typename T>
+inline void command_msolve(Node* target, Matrix<T>* a, Node* b){
+    PoolRunner run;
+    if(target->type == MATIDENT){
+        matrixSolve((Matrix<T>*)target->value, a, (Matrix<T>*)b->value, run.threads(), run);
+    }else{
+        listSolve((std::vector<T>*)target->value, a, (std::vector<T>*)b->value, run.threads(), run);
+    }
+}
+
+//! Command: Save the Determinant of a Matrix (MDET)
+template<typename T>
+inline void command_mdet(MathNode* varlist, Matrix<T>* a){
+    PoolRunner run;
+    setVarListEntry<T>(varlist, matrixDeterminant(a, run.threads(), run));
+}
+
+//! Command: Invert a Matrix (MINV)
+template<typename T>
+inline void command_minv(Matrix<T>* target, Matrix<T>* a){
+    PoolRunner run;
+    matrixInverse(target, a, run.threads(), run);
+}
+
+//! Command: LU Decomposition with Partial Pivoting (MLU)
+template<typename T>
+inline void command_mlu(Matrix<T>* lu, std::vector<T>* perm, Matrix<T>* a){
+    PoolRunner run;
+    matrixLU(lu, perm, a, run.threads(), run);
 }
 
 // MAIN FUNCTIONS FOR THE EXECUTION OF COMMANDS
 
+//! Run the Rest of a Hot Loop as Native Code (JIT); Returns False if the Loop Must Stay Interpreted
+template<typename T>
+inline bool runNativeLoop(Node* node, int counter){
+    if constexpr (!std::is_same<T, long double>::value){
+        return false; // the JIT emits x87 code and only supports long double
+    }
+    if(node->native == nullptr){
+        if(!jit_enabled || node->hits < 0 || ++node->hits < JIT_THRESHOLD){
+            return false;
+        }
+        if(!jitCompileLoop(node)){
+            node->hits = -1; // never try again
+            return false;
+        }
+    }
+    node->native(counter);
+    return true;
+}
+
 //! Determine the Specific Function to Call for The Command
-inline void executeCommand(Node* statement) {
+template<typename T>
+void executeCommand(Node* statement) {
     switch (statement->type) {
         case CVAR:
-            command_cvar((long double*)statement->children[0]->value, statement->children[1]->expression);
+            command_cvar<T>((T*)statement->children[0]->value, statement->children[1]->expression);
             break;
         case SET:
-            command_set(statement->children[0]->expression, statement->children[1]->expression);
+            command_set<T>(statement->children[0]->expression, statement->children[1]->expression);
+            break;
+        case PLOOP:
+            runParallelLoop<T>(statement);
+            break;
+        case SPAWN:
+            spawnTask<T>(statement);
+            break;
+        case JOIN:
+            joinTasks<T>();
+            break;
+        case SETARRAY:
+            command_setarray<T>(statement->children[0]->value, (ArrayProgram<T>*)statement->value);
             break;
         case PRINT:
             command_print(*(std::string*)statement->children[0]->value);
@@ -353,158 +767,394 @@ inline void executeCommand(Node* statement) {
             command_printb(*(std::string*)statement->children[0]->value);
             break;
         case PRINTV:
-            command_printv(statement->children[0]->expression);
+            command_printv<T>(statement->children[0]->expression);
             break;
         case PRINTM:
-            command_printm((std::vector<std::vector<long double>* >*)statement->children[0]->value);
+            command_printm<T>((Matrix<T>*)statement->children[0]->value);
             break;
         case DEC:
-            command_dec(statement->children[0]->expression);
+            command_dec<T>(statement->children[0]->expression);
             break;
         case INC:
-            command_inc(statement->children[0]->expression);
+            command_inc<T>(statement->children[0]->expression);
             break;
         case CLIST:
-            command_clist((std::vector<long double>*)statement->children[0]->value, statement->children[1]->expression);
+            if(statement->children[0]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_clist<T>((std::vector<T>*)statement->children[0]->value, statement->children[1]->expression);
             break;
         case CMAT:
-            command_cmat((std::vector<std::vector<long double>* >*)statement->children[0]->value, statement->children[1]->expression, statement->children[2]->expression);
+            if(statement->children[0]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_cmat<T>((Matrix<T>*)statement->children[0]->value, statement->children[1]->expression, statement->children[2]->expression);
             break;
         case INPUT:
             command_printb(*(std::string*)statement->children[1]->value);
-            command_input(statement->children[0]->expression);
+            command_input<T>(statement->children[0]->expression);
             break;
         case MVAR:
-            command_mvar((std::vector<long double*>*)statement->children[0]->value, statement->children[1]->expression);
+            command_mvar<T>((std::vector<T*>*)statement->children[0]->value, statement->children[1]->expression);
             break;
         case ROUND:
-            command_round(statement->children[0]->expression, statement->children[1]->expression);
+            command_round<T>(statement->children[0]->expression, statement->children[1]->expression);
             break;
         case CEIL:
-            command_ceil(statement->children[0]->expression);
+            command_ceil<T>(statement->children[0]->expression);
             break;
         case FLOOR:
-            command_floor(statement->children[0]->expression);
+            command_floor<T>(statement->children[0]->expression);
             break;
         case ABS:
-            command_abs(statement->children[0]->expression);
+            command_abs<T>(statement->children[0]->expression);
             break;
         case SIN:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, SIN);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, SIN);
             break;
         case COS:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, COS);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, COS);
             break;
         case TAN:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, TAN);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, TAN);
             break;
         case CSC:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, CSC);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, CSC);
             break;
         case SEC:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, SEC);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, SEC);
             break;
         case COT:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, COT);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, COT);
             break;
         case ASIN:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, ASIN);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, ASIN);
             break;
         case ACOS:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, ACOS);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, ACOS);
             break;
         case ATAN:
-            command_trig(statement->children[0]->expression, statement->children[1]->expression, ATAN);
+            command_trig<T>(statement->children[0]->expression, statement->children[1]->expression, ATAN);
             break;
         case GETL:
-            command_getl(statement->children[0]->expression, (std::vector<long double>*)statement->children[1]->value);
+            if(statement->children[1]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_getl<T>(statement->children[0]->expression, (std::vector<T>*)statement->children[1]->value);
             break;
         case GETDIM:
-            command_getdim(statement->children[0]->expression, statement->children[1]->expression, (std::vector<std::vector<long double>*>*)statement->children[2]->value);
+            if(statement->children[2]->type == SPARSEIDENT){
+                setVarListEntry<T>(statement->children[0]->expression, (T)((SparseMatrix<T>*)statement->children[2]->value)->rows);
+                setVarListEntry<T>(statement->children[1]->expression, (T)((SparseMatrix<T>*)statement->children[2]->value)->cols);
+                break;
+            }
+            if(statement->children[2]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_getdim<T>(statement->children[0]->expression, statement->children[1]->expression, (Matrix<T>*)statement->children[2]->value);
             break;
         case XROOT:
-            command_xroot(statement->children[0]->expression, statement->children[1]->expression, statement->children[2]->expression);
+            command_xroot<T>(statement->children[0]->expression, statement->children[1]->expression, statement->children[2]->expression);
             break;
         case LOG:
-            command_log(statement->children[0]->expression, statement->children[1]->expression, statement->children[2]->expression);
+            command_log<T>(statement->children[0]->expression, statement->children[1]->expression, statement->children[2]->expression);
             break;
         case FUNCT:
             command_declarefunct(*(std::string*)statement->children[0]->value, statement->children[1]);
             break;
         case PUSH:
-            command_pushlist(statement->children[0]->expression,(std::vector<long double>*)statement->children[1]->value);
+            if(statement->children[1]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_pushlist<T>(statement->children[0]->expression,(std::vector<T>*)statement->children[1]->value);
             break;
         case POP:
-            command_poplist(statement->children[0]->expression,(std::vector<long double>*)statement->children[1]->value);
+            if(statement->children[1]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_poplist<T>(statement->children[0]->expression,(std::vector<T>*)statement->children[1]->value);
             break;
         case CHSL:
-            command_chsl(statement->children[1]->expression,(std::vector<long double>*)statement->children[0]->value);
+            if(statement->children[0]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_chsl<T>(statement->children[1]->expression,(std::vector<T>*)statement->children[0]->value);
             break;
         case NEWL:
-            std::cout << std::endl;
+            *out_stream << std::endl;
             break;
         case READF:
-            command_readf((std::vector<std::vector<long double>*>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
+            if(statement->children[0]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            if(statement->children[0]->type == SPARSEIDENT){
+                read_csv(extract_string(*(std::string*)statement->children[1]->value), (SparseMatrix<T>*)statement->children[0]->value);
+                break;
+            }
+            command_readf<T>((Matrix<T>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
             break;
         case WRITEF:
-            command_writef((std::vector<std::vector<long double>*>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
+            if(statement->children[0]->type == TYPEDIDENT){
+                command_typed<T>(statement);
+                break;
+            }
+            command_writef<T>((Matrix<T>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
             break;
         case LDEF:
-            command_ldef((std::vector<long double>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
+            command_ldef<T>((std::vector<T>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
             break;
         case MDEF:
-            command_mdef((std::vector<std::vector<long double>* >*)statement->children[0]->value, (std::string*)statement->children[1]->value);
+            command_mdef<T>((Matrix<T>*)statement->children[0]->value, (std::string*)statement->children[1]->value);
             break;
         case RANDOM:
-            command_random(statement->children[0]->expression,statement->children[1]->expression,statement->children[2]->expression);
+            command_random<T>(statement->children[0]->expression,statement->children[1]->expression,statement->children[2]->expression);
             break;
         case SLEEP:
-            command_sleep(statement->children[0]->expression);
+            command_sleep<T>(statement->children[0]->expression);
+            break;
+        case LADD:
+        case MADD:
+            command_elementwise<T, KernelAdd>(statement->children[0], statement->children[1], statement->children[2]);
+            break;
+        case LSUB:
+        case MSUB:
+            command_elementwise<T, KernelSub>(statement->children[0], statement->children[1], statement->children[2]);
+            break;
+        case LMUL:
+        case MMUL:
+            command_elementwise<T, KernelMul>(statement->children[0], statement->children[1], statement->children[2]);
+            break;
+        case LDIV:
+        case MDIV:
+            command_elementwise<T, KernelDiv>(statement->children[0], statement->children[1], statement->children[2]);
+            break;
+        case LCMP:
+        case MCMP:
+            command_compare<T>(statement->children[0], statement->children[1], (std::string*)statement->children[2]->value, statement->children[3]);
+            break;
+        case LAXPY:
+        case MAXPY:
+            command_axpy<T>(statement->children[0], statement->children[1]->expression, statement->children[2]);
+            break;
+        case MATMUL:
+            command_matmul<T>((Matrix<T>*)statement->children[0]->value, (Matrix<T>*)statement->children[1]->value, (Matrix<T>*)statement->children[2]->value, *(std::string*)statement->children[3]->value);
+            break;
+        case MSOLVE:
+            command_msolve<T>(statement->children[0], (Matrix<T>*)statement->children[1]->value, statement->children[2]);
+            break;
+        case MDET:
+            command_mdet<T>(statement->children[0]->expression, (Matrix<T>*)statement->children[1]->value);
+            break;
+        case MINV:
+            command_minv<T>((Matrix<T>*)statement->children[0]->value, (Matrix<T>*)statement->children[1]->value);
+            break;
+        case MTRANS:
+            matrixTranspose((Matrix<T>*)statement->children[0]->value, (Matrix<T>*)statement->children[1]->value);
+            break;
+        case LSUM:
+        case LMIN:
+        case LMAX:
+        case LARGMAX:
+        case LMEAN:
+        case LVAR:
+        case LDOT:
+            command_reduce<T>(statement);
+            break;
+        case LSCAN:
+            command_lscan<T>(statement->children[0], statement->children[1], *(std::string*)statement->children[2]->value);
+            break;
+        case LSORT:
+        case LSORTIDX:
+            command_lsort<T>((std::vector<T>*)statement->children[0]->value, (std::vector<T>*)statement->children[1]->value, *(std::string*)statement->children[2]->value, statement->type == LSORTIDX);
+            break;
+        case LBSEARCH:
+            setVarListEntry<T>(statement->children[0]->expression, listSearch((std::vector<T>*)statement->children[1]->value, calculateExpression<T>(statement->children[2]->expression)));
+            break;
+        case LUNIQUE:
+        case LUNION:
+        case LINTERSECT:
+            command_lset<T>(statement);
+            break;
+        case CDICT:
+            ((Dict<T>*)statement->children[0]->value)->clear();
+            break;
+        case DSET:
+            dictSet((Dict<T>*)statement->children[0]->value, calculateExpression<T>(statement->children[1]->expression), calculateExpression<T>(statement->children[2]->expression));
+            break;
+        case DDEL:
+            ((Dict<T>*)statement->children[0]->value)->erase(calculateExpression<T>(statement->children[1]->expression));
+            break;
+        case DGET:
+            command_dget<T>(statement);
+            break;
+        case DHAS:
+            setVarListEntry<T>(statement->children[0]->expression, ((Dict<T>*)statement->children[1]->value)->find(calculateExpression<T>(statement->children[2]->expression)) != nullptr);
+            break;
+        case DLEN:
+            setVarListEntry<T>(statement->children[0]->expression, (T)((Dict<T>*)statement->children[1]->value)->size());
+            break;
+        case CHEAP:
+            ((Heap<T>*)statement->children[0]->value)->clear();
+            break;
+        case HPUSH:
+            heapPush((Heap<T>*)statement->children[2]->value, calculateExpression<T>(statement->children[0]->expression), calculateExpression<T>(statement->children[1]->expression));
+            break;
+        case HPOP:
+        case HPEEK:
+            command_heapfront<T>(statement, statement->type == HPOP);
+            break;
+        case HLEN:
+            setVarListEntry<T>(statement->children[0]->expression, (T)((Heap<T>*)statement->children[1]->value)->size());
+            break;
+        case CBMAT: {
+            int rows = (int)calculateExpression<T>(statement->children[1]->expression);
+            int cols = (int)calculateExpression<T>(statement->children[2]->expression);
+            ((BitMatrix*)statement->children[0]->value)->resize(std::max(rows, 0), std::max(cols, 0));
+            break;
+        }
+        case BMAND:
+        case BMOR:
+        case BMXOR:
+            bitsBinary((BitMatrix*)statement->children[0]->value, (BitMatrix*)statement->children[1]->value, (BitMatrix*)statement->children[2]->value,
+                       statement->type == BMAND ? BitOp::AND : statement->type == BMOR ? BitOp::OR : BitOp::XOR);
+            break;
+        case BMNOT:
+            bitsNot((BitMatrix*)statement->children[0]->value, (BitMatrix*)statement->children[1]->value);
+            break;
+        case BMCOUNT:
+            setVarListEntry<T>(statement->children[0]->expression, (T)bitsCount((BitMatrix*)statement->children[1]->value));
+            break;
+        case BMNEIGH:
+            command_bmneigh((BitMatrix*)statement->children[0]->value, (BitMatrix*)statement->children[1]->value, *(std::string*)statement->children[2]->value);
+            break;
+        case CSPARSE:
+            command_csparse<T>(statement);
+            break;
+        case LSWAP:
+            ((std::vector<T>*)statement->children[0]->value)->swap(*(std::vector<T>*)statement->children[1]->value);
+            break;
+        case MSWAP:
+            ((Matrix<T>*)statement->children[0]->value)->swap(*(Matrix<T>*)statement->children[1]->value);
+            break;
+        case LCOPY:
+            listCopy((std::vector<T>*)statement->children[0]->value, (std::vector<T>*)statement->children[1]->value);
+            break;
+        case MCOPY:
+            matrixCopy((Matrix<T>*)statement->children[0]->value, (Matrix<T>*)statement->children[1]->value);
+            break;
+        case LFILL:
+            listFill((std::vector<T>*)statement->children[0]->value, calculateExpression<T>(statement->children[1]->expression));
+            break;
+        case MFILL:
+            matrixFill((Matrix<T>*)statement->children[0]->value, calculateExpression<T>(statement->children[1]->expression));
+            break;
+        case MVIEW:
+            command_mview<T>(statement);
+            break;
+        case MMAT:
+            matrixMapFile((Matrix<T>*)statement->children[0]->value, extract_string(*(std::string*)statement->children[1]->value),
+                          (int)calculateExpression<T>(statement->children[2]->expression), (int)calculateExpression<T>(statement->children[3]->expression));
+            break;
+        case SPMV:
+            command_spmv((std::vector<T>*)statement->children[0]->value, (SparseMatrix<T>*)statement->children[1]->value, (std::vector<T>*)statement->children[2]->value);
+            break;
+        case STENCIL:
+            command_stencil<T>((Matrix<T>*)statement->children[0]->value, (Matrix<T>*)statement->children[1]->value, (Matrix<T>*)statement->children[2]->value, *(std::string*)statement->children[3]->value);
+            break;
+        case FFT:
+        case IFFT:
+            listFft((std::vector<T>*)statement->children[0]->value, (std::vector<T>*)statement->children[1]->value, statement->type == IFFT);
+            break;
+        case LCONV:
+            listConvolve((std::vector<T>*)statement->children[0]->value, (std::vector<T>*)statement->children[1]->value, (std::vector<T>*)statement->children[2]->value);
+            break;
+        case MLU:
+            command_mlu<T>((Matrix<T>*)statement->children[0]->value, (std::vector<T>*)statement->children[1]->value, (Matrix<T>*)statement->children[2]->value);
+            break;
+        case VSIN:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorSin<T>());
+            break;
+        case VCOS:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorCos<T>());
+            break;
+        case VTAN:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorTan<T>());
+            break;
+        case VEXP:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorExp<T>());
+            break;
+        case VLOG:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorLog<T>(calculateExpression<T>(statement->children[2]->expression)));
+            break;
+        case VXROOT:
+            command_vectormath<T>(statement->children[0], statement->children[1], VectorRoot<T>(calculateExpression<T>(statement->children[2]->expression)));
+            break;
+        case LCLAMP:
+        case MCLAMP:
+            command_clamp<T>(statement->children[0], statement->children[1], statement->children[2]->expression, statement->children[3]->expression);
             break;
     }
 }
 
 //! Execute the Tree Recursively and Implement Control Structures
+template<typename T>
 int execute(Node* node){
     int loopc;
     switch (node->type) {
         case EXEC:
         case ROOT:
             for(Node* com : node->children){
-                if(execute(com) == -1){ // execute all statements in ROOT or EXEC iteratively
+                if(execute<T>(com) == -1){ // execute all statements in ROOT or EXEC iteratively
                     return -1;
                 }
             }
             break;
         case LOOP:
-            while (getVarListEntry(node->children[0]->expression) > 0) {
-                if (execute(node->children[1]) == -1) {
+            while (getVarListEntry<T>(node->children[0]->expression) > 0) {
+                if (execute<T>(node->children[1]) == -1) {
                     return -1;
                 }
-                setVarListEntry(node->children[0]->expression, getVarListEntry(node->children[0]->expression)-1);
+                setVarListEntry<T>(node->children[0]->expression, getVarListEntry<T>(node->children[0]->expression)-1);
+                if (runNativeLoop<T>(node, 0)) {
+                    break;
+                }
             }
             break;
         case AUTOLOOP:
-            setVarListEntry(node->children[0]->expression, calculateExpression(node->children[1]->expression));
-            while (getVarListEntry(node->children[0]->expression) > 0) {
-                if (execute(node->children[2]) == -1) {
+            setVarListEntry<T>(node->children[0]->expression, calculateExpression<T>(node->children[1]->expression));
+            while (getVarListEntry<T>(node->children[0]->expression) > 0) {
+                if (execute<T>(node->children[2]) == -1) {
                     return -1;
                 }
-                setVarListEntry(node->children[0]->expression, getVarListEntry(node->children[0]->expression)-1);
+                setVarListEntry<T>(node->children[0]->expression, getVarListEntry<T>(node->children[0]->expression)-1);
+                if (runNativeLoop<T>(node, 0)) {
+                    break;
+                }
             }
             break;
         case SLOOP:
-            loopc = (int)calculateExpression(node->children[0]->expression);
+            loopc = (int)calculateExpression<T>(node->children[0]->expression);
             for(; loopc > 0; loopc--){
-                if (execute(node->children[1]) == -1) {
+                if (execute<T>(node->children[1]) == -1) {
                     return -1;
                 }
+                if (runNativeLoop<T>(node, loopc - 1)) {
+                    break;
+                }
             }
             break;
         case IF:
-            if(calculateExpression(node->children[0]->expression) > 0){
+            if(calculateExpression<T>(node->children[0]->expression) > 0){
                 if_state = false;
-                if (execute(node->children[1]) == -1) {
+                if (execute<T>(node->children[1]) == -1) {
                     return -1;
                 }
             }else{
@@ -513,9 +1163,9 @@ int execute(Node* node){
             break;
         case ELIF:
             if(if_state){
-                if(calculateExpression(node->children[0]->expression) > 0){
+                if(calculateExpression<T>(node->children[0]->expression) > 0){
                     if_state = false;
-                    if (execute(node->children[1]) == -1) {
+                    if (execute<T>(node->children[1]) == -1) {
                         return -1;
                     }
                 }else{
@@ -526,24 +1176,30 @@ int execute(Node* node){
         case ELSE:
             if(if_state){
                 if_state = false;
-                if (execute(node->children[0]) == -1) {
+                if (execute<T>(node->children[0]) == -1) {
                     return -1;
                 }
             }
             break;
         case WHILE:
-            while(calculateExpression(node->children[0]->expression) > 0){
-                if (execute(node->children[1]) == -1) {
+            while(calculateExpression<T>(node->children[0]->expression) > 0){
+                if (execute<T>(node->children[1]) == -1) {
                     return -1;
                 }
+                if (runNativeLoop<T>(node, 0)) {
+                    break;
+                }
             }
             break;
         case CALL:
-            if(funcs.find(*((std::string*)node->children[0]->value)) == funcs.end()){
+            if(node->children.size() > 1){
+                execute<T>(node->children[1]); // private copy of the function inside ploop
+            }else if(funcs.find(*((std::string*)node->children[0]->value)) == funcs.end()){
                 std::cerr << "Error: function <" << node->children[0]->value << "> is not defined" << std::endl;
                 exit(0);
+            }else{
+                execute<T>(funcs[*(std::string*)(node->children[0]->value)]);
             }
-            execute(funcs[*(std::string*)(node->children[0]->value)]);
             if_state = false;
             break;
         case EXIT:
@@ -552,8 +1208,17 @@ int execute(Node* node){
             return -1;
         default:
             // handle standard commands
-            executeCommand(node);
+            executeCommand<T>(node);
             break;
     }
     return 0;
 }
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template void load_math_const<double>();
+template void load_math_const<long double>();
+template void executeCommand<double>(Node* statement);
+template void executeCommand<long double>(Node* statement);
+template int execute<double>(Node* node);
+template int execute<long double>(Node* node);
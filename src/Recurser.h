@@ -23,9 +23,27 @@
 #include <chrono>
 
 #include "Tokens.h"
+#include "Kernels.h"
+#include "Linalg.h"
+#include "Spectral.h"
+#include "Stencil.h"
+#include "Reduce.h"
+#include "Sort.h"
+#include "VectorMath.h"
 
+extern std::unordered_map<std::string, Node*> funcs; // global map for all functions
+
+extern thread_local bool if_state; // was the previous if or elif false --> enables execution of next elif or else
+
+extern thread_local std::ostream* out_stream; // output of the print commands (buffered per chunk inside ploop)
+
+template<typename T>
 int execute(Node* node);
 
+template<typename T>
+void executeCommand(Node* statement);
+
+template<typename T>
 void load_math_const();
 
 // FilesIO Declarations
@@ -34,12 +52,23 @@ std::string extract_string(const std::string& input);
 
 std::string extract_list_string(const std::string& input);
 
-void read_csv(const std::string& filename, std::vector<std::vector<long double>*>* output);
+template<typename T>
+void read_csv(const std::string& filename, Matrix<T>* output);
+
+template<typename T>
+void write_csv(const std::string& filename, Matrix<T>* numbers);
+
+void read_csv(const std::string& filename, TypedArray* output);
+
+template<typename T>
+void read_csv(const std::string& filename, SparseMatrix<T>* output);
 
-void write_csv(const std::string& filename, std::vector<std::vector<long double>*>* numbers);
+void write_csv(const std::string& filename, TypedArray* numbers);
 
-void parse_numbers(const std::string& input, std::vector<long double>* output);
+template<typename T>
+void parse_numbers(const std::string& input, std::vector<T>* output);
 
-void parse_matrix(std::string& matrix_string, std::vector<std::vector<long double>* >* matrix);
+template<typename T>
+void parse_matrix(std::string& matrix_string, Matrix<T>* matrix);
 
 #endif //SQBRA_RECURSER_H
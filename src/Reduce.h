@@ -0,0 +1,537 @@
+#pragma once
+#ifndef SQBRA_REDUCE_H
+#define SQBRA_REDUCE_H
+
+/*
+ *  REDUCE.H
+ *  This file contains the reductions (sum, minimum, maximum, position of the maximum, mean, variance, dot product) and
+ *  the prefix sums of lists and matrices, over all entries or for every row or column of a matrix.
+ *  Sums are computed in blocks of REDUCE_BLOCK entries with several vector accumulators, and the sums of the blocks
+ *  are added pairwise; optionally every sum is compensated (Kahan-Babuska). The blocks do not depend on the number
+ *  of threads, so the results are the same for every value of --threads.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "Kernels.h"
+
+const size_t REDUCE_BLOCK = 2048;     // entries that are summed directly before the pairwise summation
+const size_t REDUCE_PARALLEL = 65536; // lists and matrices with fewer entries are reduced by one thread
+const size_t SCAN_BLOCK = 65536;      // prefix sums of longer lists are computed in blocks of this length in parallel
+
+enum class ReduceOp { SUM, MIN, MAX, ARGMAX, MEAN, VAR, DOT };
+
+//! Rows of Entries with a Fixed Distance (a List is a Single Row)
+template<typename T>
+struct ReduceView {
+    const T* data;
+    size_t rows;
+    size_t cols;
+    size_t stride;
+
+    const T* row(size_t i) const { return data + i * stride; }
+    size_t size() const { return rows * cols; }
+};
+
+template<typename T>
+ReduceView<T> reduceView(const std::vector<T>* list){ return ReduceView<T>{list->data(), 1, list->size(), list->size()}; }
+
+template<typename T>
+ReduceView<T> reduceView(const Matrix<T>* matrix){ return ReduceView<T>{matrix->data, matrix->rows, matrix->cols, matrix->stride}; }
+
+// RANGE KERNELS ####################################################################
+
+//! Sum That Carries the Rounding Error of Every Addition (Kahan-Babuska / Neumaier)
+template<typename T>
+struct CompensatedSum {
+    T sum = 0;
+    T error = 0;
+
+    void add(T x){
+        T t = sum + x;
+        error += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    }
+    void add(const CompensatedSum& other){
+        add(other.sum);
+        add(other.error);
+    }
+    T value() const { return sum + error; }
+};
+
+#ifdef SQBRA_SIMD
+//! Sum of f(x[i], y[i]) with Four Vector Accumulators (f: 0 = x, 1 = x * y, 2 = (x - y[0])^2)
+template<int F>
+SQBRA_AVX2 double rangeAvx2(const double* x, const double* y, size_t n){
+    __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d center = F == 2 ? _mm256_set1_pd(y[0]) : _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        for(int k = 0; k < 4; k++){
+            __m256d v = _mm256_loadu_pd(x + i + 4 * k);
+            if(F == 1){
+                v = _mm256_mul_pd(v, _mm256_loadu_pd(y + i + 4 * k));
+            }else if(F == 2){
+                v = _mm256_sub_pd(v, center);
+                v = _mm256_mul_pd(v, v);
+            }
+            acc[k] = _mm256_add_pd(acc[k], v);
+        }
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3])));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < n; i++){
+        double v = F == 1 ? x[i] * y[i] : F == 2 ? (x[i] - y[0]) * (x[i] - y[0]) : x[i];
+        sum += v;
+    }
+    return sum;
+}
+
+//! Maximum (Larger = true) or Minimum of n >= 1 Entries
+template<bool Larger>
+SQBRA_AVX2 double extremeAvx2(const double* x, size_t n){
+    size_t i = 0;
+    double result = x[0];
+    if(n >= 4){
+        __m256d acc = _mm256_loadu_pd(x);
+        for(i = 4; i + 4 <= n; i += 4){
+            acc = Larger ? _mm256_max_pd(acc, _mm256_loadu_pd(x + i)) : _mm256_min_pd(acc, _mm256_loadu_pd(x + i));
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        for(double lane : lanes){
+            result = Larger ? (lane > result ? lane : result) : (lane < result ? lane : result);
+        }
+    }
+    for(; i < n; i++){
+        result = Larger ? (x[i] > result ? x[i] : result) : (x[i] < result ? x[i] : result);
+    }
+    return result;
+}
+#endif
+
+//! Sum of f(x[i], y[i]) for f: 0 = x, 1 = x * y, 2 = (x - y[0])^2 (Plain or Compensated)
+template<int F, typename T>
+T rangeSum(const T* x, const T* y, size_t n, bool compensated){
+    if(compensated){
+        CompensatedSum<T> sum;
+        for(size_t i = 0; i < n; i++){
+            sum.add(F == 1 ? x[i] * y[i] : F == 2 ? (x[i] - y[0]) * (x[i] - y[0]) : x[i]);
+        }
+        return sum.value();
+    }
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        if(kernelAvx2()){
+            return rangeAvx2<F>(x, y, n);
+        }
+    }
+#endif
+    T acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        for(size_t k = 0; k < 4; k++){
+            acc[k] += F == 1 ? x[i + k] * y[i + k] : F == 2 ? (x[i + k] - y[0]) * (x[i + k] - y[0]) : x[i + k];
+        }
+    }
+    for(; i < n; i++){
+        acc[0] += F == 1 ? x[i] * y[i] : F == 2 ? (x[i] - y[0]) * (x[i] - y[0]) : x[i];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+//! Maximum (Larger = true) or Minimum of n >= 1 Entries
+template<bool Larger, typename T>
+T rangeExtreme(const T* x, size_t n){
+#ifdef SQBRA_SIMD
+    if constexpr (std::is_same<T, double>::value){
+        if(kernelAvx2()){
+            return extremeAvx2<Larger>(x, n);
+        }
+    }
+#endif
+    T result = x[0];
+    for(size_t i = 1; i < n; i++){
+        result = Larger ? (x[i] > result ? x[i] : result) : (x[i] < result ? x[i] : result);
+    }
+    return result;
+}
+
+// REDUCTION OF ALL ENTRIES #########################################################
+
+//! Compute leaf(row, first column, count) for Blocks of at Most REDUCE_BLOCK Entries of Every Row; Returns the Results in Order
+template<typename Partial, typename T, typename Leaf, typename Runner>
+std::vector<Partial> reduceBlocks(const ReduceView<T>& view, const Leaf& leaf, size_t threads, const Runner& run){
+    size_t perRow = (view.cols + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    size_t blocks = view.rows * perRow;
+    std::vector<Partial> partials(blocks);
+    size_t tasks = view.size() < REDUCE_PARALLEL ? std::min<size_t>(blocks, 1) : std::min(blocks, 4 * threads);
+    run(tasks, [&](size_t task){
+        for(size_t block = task * blocks / tasks; block < (task + 1) * blocks / tasks; block++){
+            size_t row = block / perRow;
+            size_t first = block % perRow * REDUCE_BLOCK;
+            partials[block] = leaf(row, first, std::min(REDUCE_BLOCK, view.cols - first));
+        }
+    });
+    return partials;
+}
+
+//! Add the Sums of the Blocks Pairwise (Neighbours First), so the Rounding Error Grows with log(Blocks)
+template<typename T>
+T pairwiseSum(std::vector<T> partials){
+    if(partials.empty()){
+        return T(0);
+    }
+    for(size_t width = 1; width < partials.size(); width *= 2){
+        for(size_t i = 0; i + width < partials.size(); i += 2 * width){
+            partials[i] += partials[i + width];
+        }
+    }
+    return partials[0];
+}
+
+//! Sum of f(a, b) over all Entries (see rangeSum)
+template<int F, typename T, typename Runner>
+T reduceSum(const ReduceView<T>& a, const ReduceView<T>& b, bool compensated, size_t threads, const Runner& run){
+    if(compensated){
+        std::vector<CompensatedSum<T> > partials = reduceBlocks<CompensatedSum<T> >(a, [&](size_t row, size_t first, size_t n){
+            CompensatedSum<T> sum;
+            sum.add(rangeSum<F>(a.row(row) + first, F == 1 ? b.row(row) + first : b.data, n, true));
+            return sum;
+        }, threads, run);
+        CompensatedSum<T> total;
+        for(const CompensatedSum<T>& partial : partials){
+            total.add(partial);
+        }
+        return total.value();
+    }
+    return pairwiseSum(reduceBlocks<T>(a, [&](size_t row, size_t first, size_t n){
+        return rangeSum<F>(a.row(row) + first, F == 1 ? b.row(row) + first : b.data, n, false);
+    }, threads, run));
+}
+
+//! Maximum or Minimum over all Entries (at Least One)
+template<bool Larger, typename T, typename Runner>
+T reduceExtreme(const ReduceView<T>& a, size_t threads, const Runner& run){
+    std::vector<T> partials = reduceBlocks<T>(a, [&](size_t row, size_t first, size_t n){
+        return rangeExtreme<Larger>(a.row(row) + first, n);
+    }, threads, run);
+    return rangeExtreme<Larger>(partials.data(), partials.size());
+}
+
+//! Name of the Command of a Reduction (for Error Messages)
+inline const char* reduceName(ReduceOp op){
+    switch(op){
+        case ReduceOp::SUM: return "lsum";
+        case ReduceOp::MIN: return "lmin";
+        case ReduceOp::MAX: return "lmax";
+        case ReduceOp::ARGMAX: return "largmax";
+        case ReduceOp::MEAN: return "lmean";
+        case ReduceOp::VAR: return "lvar";
+        default: return "ldot";
+    }
+}
+
+//! Reduce all Entries of a (and b for the Dot Product); the Position of the Maximum Counts Row by Row from 0
+template<typename T, typename Runner>
+T reduceAll(ReduceOp op, const ReduceView<T>& a, const ReduceView<T>& b, bool compensated, size_t threads, const Runner& run){
+    if(a.size() == 0 && op != ReduceOp::SUM && op != ReduceOp::DOT){
+        std::cerr << "Error: " << reduceName(op) << " needs at least one entry." << std::endl;
+        exit(0);
+    }
+    switch(op){
+        case ReduceOp::SUM:
+            return reduceSum<0>(a, a, compensated, threads, run);
+        case ReduceOp::DOT:
+            return reduceSum<1>(a, b, compensated, threads, run);
+        case ReduceOp::MEAN:
+            return reduceSum<0>(a, a, compensated, threads, run) / T(a.size());
+        case ReduceOp::VAR: {
+            // two passes: the squared distances to the mean do not cancel like the difference of two sums
+            T mean = reduceSum<0>(a, a, compensated, threads, run) / T(a.size());
+            ReduceView<T> center{&mean, 1, 1, 1};
+            return reduceSum<2>(a, center, compensated, threads, run) / T(a.size());
+        }
+        case ReduceOp::MIN:
+            return reduceExtreme<false>(a, threads, run);
+        case ReduceOp::MAX:
+            return reduceExtreme<true>(a, threads, run);
+        default: {
+            T maximum = reduceExtreme<true>(a, threads, run);
+            for(size_t i = 0; i < a.rows; i++){
+                const T* row = a.row(i);
+                for(size_t j = 0; j < a.cols; j++){
+                    if(row[j] == maximum){
+                        return T(i * a.cols + j);
+                    }
+                }
+            }
+            return T(0); // only NaN entries
+        }
+    }
+}
+
+//! Reduce a List (b is Only Used by the Dot Product)
+template<typename T, typename Runner>
+T reduceList(ReduceOp op, const std::vector<T>* a, const std::vector<T>* b, bool compensated, size_t threads, const Runner& run){
+    if(op == ReduceOp::DOT){
+        checkSameLength(a, b);
+    }
+    return reduceAll(op, reduceView(a), reduceView(b == nullptr ? a : b), compensated, threads, run);
+}
+
+//! Reduce all Entries of a Matrix (b is Only Used by the Dot Product)
+template<typename T, typename Runner>
+T reduceMatrix(ReduceOp op, const Matrix<T>* a, const Matrix<T>* b, bool compensated, size_t threads, const Runner& run){
+    if(op == ReduceOp::DOT){
+        checkSameDimensions(a, b);
+    }
+    return reduceAll(op, reduceView(a), reduceView(b == nullptr ? a : b), compensated, threads, run);
+}
+
+// REDUCTION OF ROWS AND COLUMNS ####################################################
+
+//! target[i] = Reduction of Row i of a (and b)
+template<typename T, typename Runner>
+void reduceRows(ReduceOp op, std::vector<T>* target, const Matrix<T>* a, const Matrix<T>* b, bool compensated, size_t threads, const Runner& run){
+    if(op == ReduceOp::DOT){
+        checkSameDimensions(a, b);
+    }
+    ReduceView<T> va = reduceView(a);
+    ReduceView<T> vb = reduceView(b == nullptr ? a : b);
+    std::vector<T> result(a->rows);
+    auto reduceRow = [&](size_t i, size_t rowThreads, const auto& rowRun){
+        ReduceView<T> ra{va.row(i), 1, va.cols, va.stride};
+        ReduceView<T> rb{vb.row(i), 1, vb.cols, vb.stride};
+        result[i] = reduceAll(op, ra, rb, compensated, rowThreads, rowRun);
+    };
+    if(a->rows >= 2 && va.size() >= REDUCE_PARALLEL){
+        size_t tasks = std::min(a->rows, 4 * threads);
+        run(tasks, [&](size_t task){
+            for(size_t i = task * a->rows / tasks; i < (task + 1) * a->rows / tasks; i++){
+                reduceRow(i, 1, SerialRunner());
+            }
+        });
+    }else{
+        for(size_t i = 0; i < a->rows; i++){
+            reduceRow(i, threads, run);
+        }
+    }
+    target->swap(result);
+}
+
+//! sums[j - c0] = Sum of f(a[i][j], b[i][j]) over the Rows [r0, r1) for the Columns [c0, c1) (Pairwise over the Rows)
+template<int F, typename T>
+void columnSums(const ReduceView<T>& a, const ReduceView<T>& b, size_t r0, size_t r1, size_t c0, size_t c1, T* sums){
+    size_t width = c1 - c0;
+    if(r1 - r0 <= 32){
+        std::fill(sums, sums + width, T(0));
+        for(size_t i = r0; i < r1; i++){
+            const T* x = a.row(i) + c0;
+            const T* y = b.row(F == 2 ? 0 : i) + c0;
+            for(size_t j = 0; j < width; j++){
+                sums[j] += F == 1 ? x[j] * y[j] : F == 2 ? (x[j] - y[j]) * (x[j] - y[j]) : x[j];
+            }
+        }
+        return;
+    }
+    size_t middle = r0 + (r1 - r0) / 2;
+    std::vector<T> second(width);
+    columnSums<F>(a, b, r0, middle, c0, c1, sums);
+    columnSums<F>(a, b, middle, r1, c0, c1, second.data());
+    for(size_t j = 0; j < width; j++){
+        sums[j] += second[j];
+    }
+}
+
+//! Compensated Version of columnSums (Row by Row)
+template<int F, typename T>
+void columnSumsCompensated(const ReduceView<T>& a, const ReduceView<T>& b, size_t c0, size_t c1, T* sums){
+    std::vector<CompensatedSum<T> > acc(c1 - c0);
+    for(size_t i = 0; i < a.rows; i++){
+        const T* x = a.row(i) + c0;
+        const T* y = b.row(F == 2 ? 0 : i) + c0;
+        for(size_t j = 0; j < c1 - c0; j++){
+            acc[j].add(F == 1 ? x[j] * y[j] : F == 2 ? (x[j] - y[j]) * (x[j] - y[j]) : x[j]);
+        }
+    }
+    for(size_t j = 0; j < c1 - c0; j++){
+        sums[j] = acc[j].value();
+    }
+}
+
+//! target[j] = Reduction of Column j of a (and b)
+template<typename T, typename Runner>
+void reduceCols(ReduceOp op, std::vector<T>* target, const Matrix<T>* a, const Matrix<T>* b, bool compensated, size_t threads, const Runner& run){
+    if(op == ReduceOp::DOT){
+        checkSameDimensions(a, b);
+    }
+    if(a->rows == 0 && op != ReduceOp::SUM && op != ReduceOp::DOT){
+        std::cerr << "Error: " << reduceName(op) << " needs at least one entry." << std::endl;
+        exit(0);
+    }
+    ReduceView<T> va = reduceView(a);
+    ReduceView<T> vb = reduceView(b == nullptr ? a : b);
+    size_t cols = a->cols;
+    std::vector<T> result(cols);
+    std::vector<T> means;
+    ReduceView<T> center{nullptr, 1, cols, cols};
+    if(op == ReduceOp::VAR){
+        means.resize(cols);
+        reduceCols(ReduceOp::MEAN, &means, a, b, compensated, threads, run);
+        center.data = means.data();
+    }
+    // columns are processed in strips, so every thread reads short contiguous parts of all rows
+    const size_t strip = 256;
+    size_t strips = (cols + strip - 1) / strip;
+    size_t tasks = va.size() < REDUCE_PARALLEL ? std::min<size_t>(strips, 1) : std::min(strips, 4 * threads);
+    run(tasks, [&](size_t task){
+        for(size_t s = task * strips / tasks; s < (task + 1) * strips / tasks; s++){
+            size_t c0 = s * strip;
+            size_t c1 = std::min(cols, c0 + strip);
+            T* out = result.data() + c0;
+            switch(op){
+                case ReduceOp::SUM:
+                case ReduceOp::MEAN:
+                    compensated ? columnSumsCompensated<0>(va, va, c0, c1, out) : columnSums<0>(va, va, 0, va.rows, c0, c1, out);
+                    break;
+                case ReduceOp::DOT:
+                    compensated ? columnSumsCompensated<1>(va, vb, c0, c1, out) : columnSums<1>(va, vb, 0, va.rows, c0, c1, out);
+                    break;
+                case ReduceOp::VAR:
+                    compensated ? columnSumsCompensated<2>(va, center, c0, c1, out) : columnSums<2>(va, center, 0, va.rows, c0, c1, out);
+                    break;
+                default: {
+                    // minimum, maximum and its position: compare row by row
+                    std::copy(va.row(0) + c0, va.row(0) + c1, out);
+                    std::vector<size_t> position(c1 - c0, 0);
+                    for(size_t i = 1; i < va.rows; i++){
+                        const T* x = va.row(i) + c0;
+                        for(size_t j = 0; j < c1 - c0; j++){
+                            if(op == ReduceOp::MIN ? x[j] < out[j] : x[j] > out[j]){
+                                out[j] = x[j];
+                                position[j] = i;
+                            }
+                        }
+                    }
+                    if(op == ReduceOp::ARGMAX){
+                        for(size_t j = 0; j < c1 - c0; j++){
+                            out[j] = T(position[j]);
+                        }
+                    }
+                }
+            }
+            if(op == ReduceOp::MEAN || op == ReduceOp::VAR){
+                for(size_t j = 0; j < c1 - c0; j++){
+                    out[j] /= T(va.rows);
+                }
+            }
+        }
+    });
+    target->swap(result);
+}
+
+// PREFIX SUMS ######################################################################
+
+//! dst[i] = src[0] + ... + src[i] (exclusive: + src[i - 1], dst[0] = 0), Starting with offset; dst may be src
+template<typename T>
+void scanRange(const T* src, T* dst, size_t n, T offset, bool exclusive, bool compensated){
+    CompensatedSum<T> sum;
+    sum.add(offset);
+    T plain = offset;
+    for(size_t i = 0; i < n; i++){
+        T x = src[i];
+        if(exclusive){
+            dst[i] = compensated ? sum.value() : plain;
+        }
+        if(compensated){
+            sum.add(x);
+        }else{
+            plain += x;
+        }
+        if(!exclusive){
+            dst[i] = compensated ? sum.value() : plain;
+        }
+    }
+}
+
+//! Prefix Sums of a List; Long Lists are Summed in Blocks in Parallel, then Every Block Adds the Sum of the Blocks Before it
+template<typename T, typename Runner>
+void listScan(std::vector<T>* target, const std::vector<T>* source, bool exclusive, bool compensated, const Runner& run){
+    size_t n = source->size();
+    if(target != source){
+        target->resize(n);
+    }
+    const T* src = source->data();
+    T* dst = target->data();
+    size_t blocks = (n + SCAN_BLOCK - 1) / SCAN_BLOCK;
+    if(blocks <= 1 || compensated){
+        scanRange(src, dst, n, T(0), exclusive, compensated);
+        return;
+    }
+    std::vector<T> offsets(blocks, T(0));
+    run(blocks, [&](size_t block){
+        size_t first = block * SCAN_BLOCK;
+        offsets[block] = rangeSum<0>(src + first, src, std::min(SCAN_BLOCK, n - first), false);
+    });
+    T running = 0;
+    for(size_t block = 0; block < blocks; block++){
+        T sum = offsets[block];
+        offsets[block] = running;
+        running += sum;
+    }
+    run(blocks, [&](size_t block){
+        size_t first = block * SCAN_BLOCK;
+        scanRange(src + first, dst + first, std::min(SCAN_BLOCK, n - first), offsets[block], exclusive, false);
+    });
+}
+
+//! Prefix Sums Along Every Row (columns = false) or Down Every Column of a Matrix
+template<typename T, typename Runner>
+void matrixScan(Matrix<T>* target, const Matrix<T>* source, bool columns, bool exclusive, bool compensated, size_t threads, const Runner& run){
+    if(target == source ? columns || exclusive : target->overlaps(*source)){
+        Matrix<T> result;
+        matrixScan(&result, source, columns, exclusive, compensated, threads, run);
+        matrixAssign(target, &result);
+        return;
+    }
+    shapeLike(target, source);
+    size_t rows = source->rows;
+    size_t cols = source->cols;
+    if(!columns){
+        size_t tasks = rows * cols < REDUCE_PARALLEL ? std::min<size_t>(rows, 1) : std::min(rows, 4 * threads);
+        run(tasks, [&](size_t task){
+            for(size_t i = task * rows / tasks; i < (task + 1) * rows / tasks; i++){
+                scanRange(source->row(i), target->row(i), cols, T(0), exclusive, compensated);
+            }
+        });
+        return;
+    }
+    if(rows == 0){
+        return;
+    }
+    std::vector<CompensatedSum<T> > sums(compensated ? cols : 0);
+    for(size_t i = 0; i < rows; i++){
+        const T* x = source->row(exclusive ? (i == 0 ? 0 : i - 1) : i);
+        T* out = target->row(i);
+        if(exclusive && i == 0){
+            std::fill(out, out + cols, T(0));
+        }else if(compensated){
+            for(size_t j = 0; j < cols; j++){
+                sums[j].add(x[j]);
+                out[j] = sums[j].value();
+            }
+        }else if(i == 0 || (exclusive && i == 1)){
+            std::copy(x, x + cols, out);
+        }else{
+            kernelBinary<KernelAdd>(target->row(i - 1), x, out, cols);
+        }
+    }
+}
+
+#endif //SQBRA_REDUCE_H
@@ -0,0 +1,161 @@
+#pragma once
+#ifndef SQBRA_SORT_H
+#define SQBRA_SORT_H
+
+/*
+ *  SORT.H
+ *  This file contains the sorting of lists (values or the positions of the values), the binary search in sorted lists
+ *  and the set operations (distinct values, union and intersection) on lists.
+ *  Long lists are split into one part per thread; the parts are sorted in parallel and merged pairwise. Ties in the
+ *  positions are broken by the position itself, so every result is the same for every value of --threads.
+ *  Numbers that are not a number (nan) are placed behind all other entries.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+const size_t SORT_PARALLEL = 65536; // lists with fewer entries are sorted by one thread; longer parts have at least this length
+
+//! Strict Order of Two Entries: Ascending or Descending, nan Behind all Numbers
+template<typename T>
+struct SortOrder {
+    bool descending;
+    bool operator()(T a, T b) const {
+        if(a != a || b != b){
+            return a == a; // only a is a number
+        }
+        return descending ? b < a : a < b;
+    }
+};
+
+//! Entry of a List Together with its Position (for the Positions of the Sorted Entries)
+template<typename T>
+struct SortOrderIndexed {
+    SortOrder<T> order;
+    bool operator()(const std::pair<T, size_t>& a, const std::pair<T, size_t>& b) const {
+        if(order(a.first, b.first)){
+            return true;
+        }
+        return !order(b.first, a.first) && a.second < b.second;
+    }
+};
+
+//! Sort the n Entries from first: Parts of the List are Sorted in Parallel, then Merged Pairwise in log(Parts) Rounds
+template<typename Iterator, typename Less, typename Runner>
+void parallelSort(Iterator first, size_t n, Less less, size_t threads, const Runner& run){
+    size_t parts = n < 2 * SORT_PARALLEL ? 1 : std::min(std::max(threads, (size_t)1), n / SORT_PARALLEL);
+    if(parts == 1){
+        std::sort(first, first + n, less);
+        return;
+    }
+    std::vector<size_t> bounds(parts + 1);
+    for(size_t i = 0; i <= parts; i++){
+        bounds[i] = i * n / parts;
+    }
+    run(parts, [&](size_t part){
+        std::sort(first + bounds[part], first + bounds[part + 1], less);
+    });
+    for(size_t width = 1; width < parts; width *= 2){
+        size_t merges = (parts + 2 * width - 1) / (2 * width);
+        run(merges, [&](size_t merge){
+            size_t low = 2 * width * merge;
+            size_t middle = std::min(low + width, parts);
+            size_t high = std::min(low + 2 * width, parts);
+            std::inplace_merge(first + bounds[low], first + bounds[middle], first + bounds[high], less);
+        });
+    }
+}
+
+//! Sort the Entries of source into target (target may be source)
+template<typename T, typename Runner>
+void listSort(std::vector<T>* target, const std::vector<T>* source, bool descending, size_t threads, const Runner& run){
+    if(target != source){
+        *target = *source;
+    }
+    // nan is moved behind the numbers first, so the numbers are sorted with a plain comparison
+    size_t numbers = std::partition(target->begin(), target->end(), [](T x){ return x == x; }) - target->begin();
+    if(descending){
+        parallelSort(target->begin(), numbers, std::greater<T>(), threads, run);
+    }else{
+        parallelSort(target->begin(), numbers, std::less<T>(), threads, run);
+    }
+}
+
+//! target[i] = Position (from 0) of the i-th Entry of source in Sorted Order; Equal Entries Keep their Order (target may be source)
+template<typename T, typename Runner>
+void listSortIndex(std::vector<T>* target, const std::vector<T>* source, bool descending, size_t threads, const Runner& run){
+    size_t n = source->size();
+    std::vector<std::pair<T, size_t> > entries(n);
+    for(size_t i = 0; i < n; i++){
+        entries[i] = std::make_pair((*source)[i], i);
+    }
+    parallelSort(entries.begin(), n, SortOrderIndexed<T>{SortOrder<T>{descending}}, threads, run);
+    target->resize(n);
+    for(size_t i = 0; i < n; i++){
+        (*target)[i] = (T)entries[i].second;
+    }
+}
+
+//! Position of the First Entry of the Ascending List that is not Smaller than value (the Length if there is None)
+template<typename T>
+T listSearch(const std::vector<T>* list, T value){
+    return (T)(std::lower_bound(list->begin(), list->end(), value, SortOrder<T>{false}) - list->begin());
+}
+
+// SET OPERATIONS ###################################################################
+
+//! Check Whether the List is Ascending without Repeated Entries
+template<typename T>
+bool isSortedSet(const std::vector<T>* list){
+    SortOrder<T> less{false};
+    for(size_t i = 1; i < list->size(); i++){
+        if(!less((*list)[i - 1], (*list)[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+//! The Distinct Entries of source in Ascending Order (target may be source)
+template<typename T, typename Runner>
+void listUnique(std::vector<T>* target, const std::vector<T>* source, size_t threads, const Runner& run){
+    if(isSortedSet(source)){
+        if(target != source){
+            *target = *source;
+        }
+        return;
+    }
+    listSort(target, source, false, threads, run);
+    SortOrder<T> less{false};
+    target->erase(std::unique(target->begin(), target->end(), [&](T a, T b){ return !less(a, b) && !less(b, a); }), target->end());
+}
+
+//! Distinct Entries of a and b (union) or the Entries that are in Both (intersection), Ascending (target may be a or b)
+template<typename T, typename Runner>
+void listSetOperation(std::vector<T>* target, const std::vector<T>* a, const std::vector<T>* b, bool intersection, size_t threads, const Runner& run){
+    // lists that are not ascending sets already are sorted first, then both are merged in one pass
+    std::vector<T> setA, setB;
+    if(!isSortedSet(a)){
+        listUnique(&setA, a, threads, run);
+        a = &setA;
+    }
+    if(!isSortedSet(b)){
+        listUnique(&setB, b, threads, run);
+        b = &setB;
+    }
+    std::vector<T> result;
+    result.reserve(intersection ? std::min(a->size(), b->size()) : a->size() + b->size());
+    if(intersection){
+        std::set_intersection(a->begin(), a->end(), b->begin(), b->end(), std::back_inserter(result), SortOrder<T>{false});
+    }else{
+        std::set_union(a->begin(), a->end(), b->begin(), b->end(), std::back_inserter(result), SortOrder<T>{false});
+    }
+    target->swap(result);
+}
+
+#endif //SQBRA_SORT_H
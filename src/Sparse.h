@@ -0,0 +1,164 @@
+#pragma once
+#ifndef SQBRA_SPARSE_H
+#define SQBRA_SPARSE_H
+
+/*
+ *  SPARSE.H
+ *  This file declares the sparse matrix type of the SquareBracket language and its commands. Only the entries that
+ *  are not zero are stored, row by row in compressed sparse row (CSR) form: the columns and values of all entries and
+ *  the position of the first entry of every row. A 100000x100000 matrix with 10 entries per row needs 12 to 20 MB
+ *  instead of 80 or 160 GB, and a matrix-vector multiplication reads every entry once.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "Names.h"
+
+const size_t SPARSE_PARALLEL = 65536; // sparse matrices with fewer entries are multiplied by one thread
+
+template<typename T>
+struct SparseMatrix {
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<size_t> start{0};  // the entries of row i are start[i] ... start[i + 1] - 1
+    std::vector<uint32_t> columns; // column of every entry, ascending within a row
+    std::vector<T> values;
+
+    //! Number of Stored Entries
+    size_t entries() const { return values.size(); }
+
+    //! Check Whether the Indices Address an Entry of the Matrix
+    bool contains(int i, int j) const { return i >= 0 && j >= 0 && (size_t)i < rows && (size_t)j < cols; }
+
+    //! Entry Without Bounds Check (Zero if it is not Stored)
+    T at(size_t i, size_t j) const {
+        auto first = columns.begin() + start[i];
+        auto last = columns.begin() + start[i + 1];
+        auto it = std::lower_bound(first, last, (uint32_t)j);
+        return it != last && *it == j ? values[it - columns.begin()] : 0;
+    }
+};
+
+//! Row or Column of a Triplet as an Index (With the Error of the Interpreter if it Lies Outside the Matrix)
+template<typename T>
+inline size_t sparseIndex(const SparseMatrix<T>* matrix, T row, T col, bool column){
+    T index = column ? col : row;
+    size_t bound = column ? matrix->cols : matrix->rows;
+    if(!(index >= 0 && index < (T)bound)){
+        std::cerr << "Error: entry <" << row << "," << col << "> lies outside of sparse matrix <" << containerName(matrix) << "> with dimensions <" << matrix->rows << "x" << matrix->cols << ">." << std::endl;
+        exit(0);
+    }
+    return (size_t)index;
+}
+
+//! Replace the Entries by the Triplets (rows[k], cols[k], values[k]); Entries with the Same Indices are Added
+template<typename T>
+void sparseBuild(SparseMatrix<T>* matrix, size_t rows, size_t cols, const std::vector<T>& r, const std::vector<T>& c, const std::vector<T>& v){
+    if(r.size() != c.size() || r.size() != v.size()){
+        std::cerr << "Error: the triplet lists of sparse matrix <" << containerName(matrix) << "> differ in their lengths (" << r.size() << ", " << c.size() << " and " << v.size() << ")." << std::endl;
+        exit(0);
+    }
+    if(cols > UINT32_MAX){
+        std::cerr << "Error: sparse matrix <" << containerName(matrix) << "> has more than " << UINT32_MAX << " columns." << std::endl;
+        exit(0);
+    }
+    matrix->rows = rows;
+    matrix->cols = cols;
+    // counting sort of the triplets by their rows (the order within a row stays the order of the lists)
+    std::vector<size_t> start(rows + 1, 0);
+    for(size_t k = 0; k < r.size(); k++){
+        start[sparseIndex(matrix, r[k], c[k], false) + 1]++;
+        sparseIndex(matrix, r[k], c[k], true);
+    }
+    for(size_t i = 0; i < rows; i++){
+        start[i + 1] += start[i];
+    }
+    std::vector<std::pair<uint32_t, T> > entries(r.size());
+    std::vector<size_t> next(start.begin(), start.end() - 1);
+    for(size_t k = 0; k < r.size(); k++){
+        entries[next[(size_t)r[k]]++] = std::make_pair((uint32_t)c[k], v[k]);
+    }
+    // sort every row by the columns and add up entries with the same column
+    matrix->columns.clear();
+    matrix->values.clear();
+    matrix->columns.reserve(entries.size());
+    matrix->values.reserve(entries.size());
+    matrix->start.assign(rows + 1, 0);
+    for(size_t i = 0; i < rows; i++){
+        auto first = entries.begin() + start[i];
+        auto last = entries.begin() + start[i + 1];
+        std::stable_sort(first, last, [](const std::pair<uint32_t, T>& a, const std::pair<uint32_t, T>& b){ return a.first < b.first; });
+        for(auto it = first; it != last; ++it){
+            if(it != first && it->first == matrix->columns.back()){
+                matrix->values.back() += it->second;
+            }else{
+                matrix->columns.push_back(it->first);
+                matrix->values.push_back(it->second);
+            }
+        }
+        matrix->start[i + 1] = matrix->values.size();
+    }
+}
+
+//! Append the Entries as Triplets to the Lists
+template<typename T>
+void sparseTriplets(const SparseMatrix<T>* matrix, std::vector<T>& r, std::vector<T>& c, std::vector<T>& v){
+    for(size_t i = 0; i < matrix->rows; i++){
+        for(size_t k = matrix->start[i]; k < matrix->start[i + 1]; k++){
+            r.push_back((T)i);
+            c.push_back((T)matrix->columns[k]);
+            v.push_back(matrix->values[k]);
+        }
+    }
+}
+
+//! First Row of a Task, so that all Tasks Multiply About the Same Number of Entries
+template<typename T>
+inline size_t sparseSplit(const SparseMatrix<T>* matrix, size_t task, size_t tasks){
+    if(task == tasks){
+        return matrix->rows;
+    }
+    size_t entry = matrix->entries() * task / tasks;
+    return std::lower_bound(matrix->start.begin(), matrix->start.begin() + matrix->rows, entry) - matrix->start.begin();
+}
+
+//! y = a * x for a Sparse Matrix and a List with one Value per Column; y may be x
+template<typename T, typename Runner>
+void sparseMultiply(std::vector<T>* y, const SparseMatrix<T>* a, const std::vector<T>* x, size_t threads, const Runner& run){
+    if(x->size() != a->cols){
+        std::cerr << "Error: list <" << containerName(x) << "> of length " << x->size() << " can not be multiplied with sparse matrix <" << containerName(a) << "> of " << a->cols << " columns." << std::endl;
+        exit(0);
+    }
+    if(y == x){
+        std::vector<T> result;
+        sparseMultiply(&result, a, x, threads, run);
+        y->swap(result);
+        return;
+    }
+    y->resize(a->rows);
+    const size_t* start = a->start.data();
+    const uint32_t* columns = a->columns.data();
+    const T* values = a->values.data();
+    const T* in = x->data();
+    T* out = y->data();
+    size_t tasks = a->entries() < SPARSE_PARALLEL ? std::min<size_t>(a->rows, 1) : std::min(a->rows, 4 * threads);
+    run(tasks, [&](size_t task){
+        size_t last = sparseSplit(a, task + 1, tasks);
+        for(size_t i = sparseSplit(a, task, tasks); i < last; i++){
+            T sum = 0;
+            for(size_t k = start[i]; k < start[i + 1]; k++){
+                sum += values[k] * in[columns[k]];
+            }
+            out[i] = sum;
+        }
+    });
+}
+
+#endif //SQBRA_SPARSE_H
@@ -0,0 +1,216 @@
+#pragma once
+#ifndef SQBRA_SPECTRAL_H
+#define SQBRA_SPECTRAL_H
+
+/*
+ *  SPECTRAL.H
+ *  This file contains the fast Fourier transform of lists (real and imaginary part in two lists) and the convolution.
+ *  Lengths that are a power of two use an iterative in-place radix-2 transform; all other lengths are reduced to a
+ *  convolution of power-of-two length (Bluestein), so every transform takes O(n log n) operations.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "Kernels.h"
+
+const size_t CONV_DIRECT = 64; // convolutions with a list of at most this length are computed directly (faster and exact)
+
+//! Check Whether n is a Power of Two
+inline bool isPowerOfTwo(size_t n){
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+//! Smallest Power of Two that is at Least n
+inline size_t nextPowerOfTwo(size_t n){
+    size_t p = 1;
+    while(p < n){
+        p <<= 1;
+    }
+    return p;
+}
+
+// RADIX-2 TRANSFORM ################################################################
+
+//! Twiddle Factors e^(-2 pi i k / 2h) of all Stages: Stage h Uses Entries h ... 2h - 1 (Cached for the Last Length)
+template<typename T>
+const std::vector<T>& fftTwiddles(size_t n, bool imaginary){
+    static thread_local size_t length = 0;
+    static thread_local std::vector<T> cosines;
+    static thread_local std::vector<T> sines;
+    if(length != n){
+        cosines.assign(n, T(0));
+        sines.assign(n, T(0));
+        const T pi = T(3.141592653589793238462643383279502884L);
+        for(size_t half = 1; half < n; half <<= 1){
+            for(size_t k = 0; k < half; k++){
+                T angle = -pi * T(k) / T(half);
+                cosines[half + k] = std::cos(angle);
+                sines[half + k] = std::sin(angle);
+            }
+        }
+        length = n;
+    }
+    return imaginary ? sines : cosines;
+}
+
+//! Forward Transform in Place for a Power-of-Two Length: X[k] = sum x[j] e^(-2 pi i jk / n)
+template<typename T>
+void fftRadix2(T* re, T* im, size_t n){
+    for(size_t i = 1, j = 0; i < n; i++){
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1){
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j){
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    const T* wr = fftTwiddles<T>(n, false).data();
+    const T* wi = fftTwiddles<T>(n, true).data();
+    for(size_t half = 1; half < n; half <<= 1){
+        for(size_t start = 0; start < n; start += 2 * half){
+            T* ar = re + start;
+            T* ai = im + start;
+            T* br = ar + half;
+            T* bi = ai + half;
+            for(size_t k = 0; k < half; k++){
+                T tr = br[k] * wr[half + k] - bi[k] * wi[half + k];
+                T ti = br[k] * wi[half + k] + bi[k] * wr[half + k];
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] += tr;
+                ai[k] += ti;
+            }
+        }
+    }
+}
+
+// ANY LENGTH #######################################################################
+
+//! Forward Transform of Any Length (Bluestein: X[k] = w[k] * sum (x[j] w[j]) conj(w[k - j]) with w[j] = e^(-pi i j^2 / n))
+template<typename T>
+void fftBluestein(T* re, T* im, size_t n){
+    size_t m = nextPowerOfTwo(2 * n - 1);
+    const T pi = T(3.141592653589793238462643383279502884L);
+    std::vector<T> wr(n), wi(n);
+    for(size_t j = 0; j < n; j++){
+        size_t square = (size_t)((unsigned long long)j * j % (2 * n)); // keeps the angle small and exact
+        T angle = -pi * T(square) / T(n);
+        wr[j] = std::cos(angle);
+        wi[j] = std::sin(angle);
+    }
+    std::vector<T> ar(m, T(0)), ai(m, T(0)), br(m, T(0)), bi(m, T(0));
+    for(size_t j = 0; j < n; j++){
+        ar[j] = re[j] * wr[j] - im[j] * wi[j];
+        ai[j] = re[j] * wi[j] + im[j] * wr[j];
+    }
+    br[0] = wr[0];
+    bi[0] = -wi[0];
+    for(size_t j = 1; j < n; j++){
+        br[j] = br[m - j] = wr[j];
+        bi[j] = bi[m - j] = -wi[j];
+    }
+    fftRadix2(ar.data(), ai.data(), m);
+    fftRadix2(br.data(), bi.data(), m);
+    // multiply and transform back: the inverse is the forward transform with real and imaginary part exchanged
+    for(size_t k = 0; k < m; k++){
+        T productRe = ar[k] * br[k] - ai[k] * bi[k];
+        T productIm = ar[k] * bi[k] + ai[k] * br[k];
+        ar[k] = productIm;
+        ai[k] = productRe;
+    }
+    fftRadix2(ar.data(), ai.data(), m);
+    T scale = T(1) / T(m);
+    for(size_t k = 0; k < n; k++){
+        T cr = ai[k] * scale;
+        T ci = ar[k] * scale;
+        re[k] = cr * wr[k] - ci * wi[k];
+        im[k] = cr * wi[k] + ci * wr[k];
+    }
+}
+
+//! Forward Transform of Any Length in Place
+template<typename T>
+void fftAnyLength(T* re, T* im, size_t n){
+    if(n < 2){
+        return;
+    }
+    if(isPowerOfTwo(n)){
+        fftRadix2(re, im, n);
+    }else{
+        fftBluestein(re, im, n);
+    }
+}
+
+//! Discrete Fourier Transform of the Complex List re + i * im in Place (inverse: e^(+2 pi i jk / n) and Divided by n)
+template<typename T>
+void listFft(std::vector<T>* re, std::vector<T>* im, bool inverse){
+    if(re == im){
+        std::cerr << "Error: the real and the imaginary part of fft must be different lists." << std::endl;
+        exit(0);
+    }
+    if(im->empty()){
+        im->assign(re->size(), T(0)); // a real signal
+    }
+    checkSameLength(re, im);
+    size_t n = re->size();
+    if(inverse){
+        // exchanging real and imaginary part before and after the forward transform conjugates it
+        fftAnyLength(im->data(), re->data(), n);
+        T scale = T(1) / T(n);
+        for(size_t i = 0; i < n; i++){
+            (*re)[i] *= scale;
+            (*im)[i] *= scale;
+        }
+    }else{
+        fftAnyLength(re->data(), im->data(), n);
+    }
+}
+
+// CONVOLUTION ######################################################################
+
+//! target[k] = sum a[j] * b[k - j] (Length of a + Length of b - 1; target may be a or b)
+template<typename T>
+void listConvolve(std::vector<T>* target, const std::vector<T>* a, const std::vector<T>* b){
+    if(a->empty() || b->empty()){
+        target->clear();
+        return;
+    }
+    size_t length = a->size() + b->size() - 1;
+    std::vector<T> result(length, T(0));
+    const std::vector<T>* shorter = a->size() < b->size() ? a : b;
+    const std::vector<T>* longer = shorter == a ? b : a;
+    if(shorter->size() <= CONV_DIRECT){
+        for(size_t j = 0; j < shorter->size(); j++){
+            kernelAxpy((*shorter)[j], longer->data(), result.data() + j, longer->size());
+        }
+    }else{
+        // both lists are real: transform a + i * b at once and separate the spectra by symmetry
+        size_t m = nextPowerOfTwo(length);
+        std::vector<T> re(m, T(0)), im(m, T(0));
+        std::copy(a->begin(), a->end(), re.begin());
+        std::copy(b->begin(), b->end(), im.begin());
+        fftRadix2(re.data(), im.data(), m);
+        std::vector<T> pr(m), pi(m);
+        for(size_t k = 0; k < m; k++){
+            size_t l = (m - k) & (m - 1);
+            // A[k] = (Z[k] + conj(Z[m-k])) / 2, B[k] = (Z[k] - conj(Z[m-k])) / 2i, product A[k] * B[k]
+            T xr = (re[k] + re[l]) / 2, xi = (im[k] - im[l]) / 2;
+            T yr = (im[k] + im[l]) / 2, yi = (re[l] - re[k]) / 2;
+            pr[k] = xr * yr - xi * yi;
+            pi[k] = xr * yi + xi * yr;
+        }
+        fftRadix2(pi.data(), pr.data(), m); // inverse transform (real and imaginary part exchanged)
+        for(size_t k = 0; k < length; k++){
+            result[k] = pr[k] / T(m);
+        }
+    }
+    target->swap(result);
+}
+
+#endif //SQBRA_SPECTRAL_H
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef SQBRA_STENCIL_H
+#define SQBRA_STENCIL_H
+
+/*
+ *  STENCIL.H
+ *  This file contains the stencil of matrices: every entry of the target is the sum of its neighbourhood in the source,
+ *  weighted with a small kernel matrix. Each row of the target is accumulated with one scaled addition (axpy) per
+ *  weight of the kernel, so the inner loops run over whole rows with the vector instructions of Kernels.h.
+ *  The header is shared by the interpreter and programs translated with --emit-cpp.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <functional>
+#include <string>
+
+#include "Kernels.h"
+
+const size_t STENCIL_PARALLEL = 65536; // matrices with fewer entries are processed by one thread
+
+//! Value of Neighbours Outside the Matrix
+enum class StencilBorder { ZERO, WRAP, CLAMP };
+
+//! Border Mode for the Name Used in the Program (zero, wrap or clamp)
+inline StencilBorder stencilBorder(const std::string& name){
+    return name == "wrap" ? StencilBorder::WRAP : name == "clamp" ? StencilBorder::CLAMP : StencilBorder::ZERO;
+}
+
+//! Map an Index that may Lie Outside [0, n) into the Matrix; Returns False if the Neighbour is Zero
+inline bool stencilIndex(long index, size_t n, StencilBorder border, size_t& result){
+    long size = (long)n;
+    if(index >= 0 && index < size){
+        result = (size_t)index;
+        return true;
+    }
+    switch(border){
+        case StencilBorder::WRAP:
+            result = (size_t)(((index % size) + size) % size);
+            return true;
+        case StencilBorder::CLAMP:
+            result = index < 0 ? 0 : n - 1;
+            return true;
+        default:
+            return false;
+    }
+}
+
+//! Add weight * Row src Shifted by shift Columns (dst[j] += weight * src[j + shift]) with the Given Border
+template<typename T>
+void stencilRow(T* dst, const T* src, size_t cols, long shift, T weight, StencilBorder border){
+    // columns whose neighbour lies inside the row form one contiguous range
+    size_t first = shift < 0 ? std::min(cols, (size_t)-shift) : 0;
+    size_t last = shift > 0 ? cols - std::min(cols, (size_t)shift) : cols;
+    if(first < last){
+        kernelAxpy(weight, src + first + shift, dst + first, last - first);
+    }
+    size_t column;
+    for(size_t j = 0; j < first; j++){
+        if(stencilIndex((long)j + shift, cols, border, column)){
+            dst[j] += weight * src[column];
+        }
+    }
+    for(size_t j = std::max(first, last); j < cols; j++){
+        if(stencilIndex((long)j + shift, cols, border, column)){
+            dst[j] += weight * src[column];
+        }
+    }
+}
+
+//! dst[i][j] = sum kernel[a][b] * src[i + a - ca][j + b - cb] where (ca, cb) is the Center of the Kernel (dst may be src)
+template<typename T, typename Runner>
+void matrixStencil(Matrix<T>* dst, const Matrix<T>* src, const Matrix<T>* kernel, StencilBorder border, size_t threads, const Runner& run){
+    if(dst->overlaps(*src) || dst->overlaps(*kernel)){
+        Matrix<T> result;
+        matrixStencil(&result, src, kernel, border, threads, run);
+        matrixAssign(dst, &result);
+        return;
+    }
+    shapeLike(dst, src);
+    size_t rows = src->rows;
+    size_t cols = src->cols;
+    if(rows == 0 || cols == 0){
+        return;
+    }
+    long centerRow = (long)kernel->rows / 2;
+    long centerCol = (long)kernel->cols / 2;
+    size_t tasks = rows * cols < STENCIL_PARALLEL ? 1 : std::min(rows, 4 * threads);
+    run(tasks, [&](size_t task){
+        for(size_t i = task * rows / tasks; i < (task + 1) * rows / tasks; i++){
+            T* out = dst->row(i);
+            std::fill(out, out + cols, T(0));
+            for(size_t a = 0; a < kernel->rows; a++){
+                size_t row;
+                if(!stencilIndex((long)(i + a) - centerRow, rows, border, row)){
+                    continue;
+                }
+                for(size_t b = 0; b < kernel->cols; b++){
+                    T weight = kernel->row(a)[b];
+                    if(weight != 0){
+                        stencilRow(out, src->row(row), cols, (long)b - centerCol, weight, border);
+                    }
+                }
+            }
+        }
+    });
+}
+
+#endif //SQBRA_STENCIL_H
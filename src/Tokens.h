@@ -18,18 +18,58 @@
 #include <unordered_map>
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Dict.h"
+#include "Heap.h"
+#include "BitMatrix.h"
+#include "TypedArray.h"
+#include "Sparse.h"
+#include "Mapped.h"
 
 /// MathCore Declarations #############
 
-extern std::unordered_map<std::string, long double*> vars; // global map for all vars (only required during parsing)
-extern std::unordered_map<std::string, std::vector<long double>*> ars; // global map for all arrays (only required during parsing)
-extern std::unordered_map<std::string, std::vector<std::vector<long double>* >*> mars; // global map for all matrices (only required during parsing)
+// The numeric core is a template on the scalar type T (double or long double, selected by --precision)
+template<typename T> inline std::unordered_map<std::string, T*> vars; // global map for all vars (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, std::vector<T>*> ars; // global map for all arrays (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, Matrix<T>*> mars; // global map for all matrices (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, Dict<T>*> dicts; // global map for all dictionaries (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, Heap<T>*> heaps; // global map for all heaps (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, BitMatrix*> bmats; // global map for all bit matrices (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, TypedArray*> typeds; // global map for all typed lists and matrices (only required during parsing)
+template<typename T> inline std::unordered_map<std::string, SparseMatrix<T>*> sparses; // global map for all sparse matrices (only required during parsing)
 
-enum class MathNodeType { Constant, Variable, Array, Matrix, Operator };
+enum class MathNodeType { Constant, Variable, Array, Matrix, Operator, WholeList, WholeMatrix, Select, Dict, BitMatrix, Typed, Sparse };
 enum class MathOperatorType { PLUS, MINUS, MULT, DIV, MOD, EXP, AND, OR, EQ, NEQ, LARGER, LARGEREQ, LESS, LESSEQ, NOTSET };
 
 MathOperatorType getOperatorType(const char c);
 
+MathOperatorType getComparisonType(const std::string& op);
+
+// Instructions of a flattened (postfix) expression; the ...P variants take their right operand from the pointer
+enum class MathCode : uint8_t { PUSH, LIST, MAT, DICT, BITS, TYPED, SPARSE,
+    ADD, SUB, MULT, DIV, MOD, EXP, EQ, NEQ, LARGER, LARGEREQ, LESS, LESSEQ,
+    ADDP, SUBP, MULTP, DIVP, MODP, EXPP, EQP, NEQP, LARGERP, LARGEREQP, LESSP, LESSEQP,
+    ANDJ, ORJ, TRUTH };
+
+struct MathInstr {
+    MathCode code;
+    int jump;        // target of ANDJ and ORJ
+    void* variable;  // value for PUSH and the ...P operators, container for LIST, MAT, DICT, BITS, TYPED and SPARSE
+};
+
+template<typename T>
+struct MathProgram {
+    std::vector<MathInstr> code;
+    std::vector<T> constants; // constants of the expression in the precision of the program
+    int depth;                // maximum size of the value stack
+    int hits = 0;             // number of evaluations (-1 if the JIT could not compile the program)
+    T (*native)() = nullptr;  // native code generated by the JIT
+};
+
 struct MathNode {
     MathNodeType type;
     long double constant;
@@ -37,9 +77,29 @@ struct MathNode {
     void* variable;
     MathNode* left;
     MathNode* right;
-    MathNode(MathNodeType t, void* v) : type(t), variable(v), constant(0), left(nullptr), right(nullptr), opt(MathOperatorType::NOTSET) {}
-    MathNode(MathNodeType t, long double v) : type(t), constant(v), left(nullptr), right(nullptr), opt(MathOperatorType::NOTSET) {}
-    MathNode(MathNodeType t, MathOperatorType s) : type(t), variable(nullptr), constant(0), left(nullptr), right(nullptr), opt(s) {}
+    MathNode* otherwise; // value of where(mask, x, y) if the mask is false (left is the mask, right the value if true)
+    void* program; // flattened version of this subtree as MathProgram<T> (nullptr if not flattened)
+    MathNode(MathNodeType t, void* v) : type(t), variable(v), constant(0), left(nullptr), right(nullptr), otherwise(nullptr), opt(MathOperatorType::NOTSET), program(nullptr) {}
+    MathNode(MathNodeType t, long double v) : type(t), constant(v), left(nullptr), right(nullptr), otherwise(nullptr), opt(MathOperatorType::NOTSET), program(nullptr) {}
+    MathNode(MathNodeType t, MathOperatorType s) : type(t), variable(nullptr), constant(0), left(nullptr), right(nullptr), otherwise(nullptr), opt(s), program(nullptr) {}
+};
+
+// Instructions of a whole-array expression; they process a block of entries at once
+enum class ArrayCode : uint8_t { SCALAR, LOAD, ADD, SUB, MULT, DIV, MOD, EXP, AND, OR, EQ, NEQ, LARGER, LARGEREQ, LESS, LESSEQ, SELECT };
+
+struct ArrayInstr {
+    ArrayCode code;
+    int index;      // slot of the hoisted value for SCALAR
+    MathNode* node; // scalar subtree for SCALAR, list or matrix (node->variable) for LOAD
+};
+
+template<typename T>
+struct ArrayProgram {
+    std::vector<ArrayInstr> code;
+    std::vector<void*> operands; // all distinct lists or matrices of the expression
+    int scalars = 0;             // number of subtrees that are evaluated once per statement
+    int depth = 0;               // maximum size of the block stack
+    bool matrix = false;         // operates on matrices instead of lists
 };
 
 struct MathTypeReturn {
@@ -49,14 +109,34 @@ struct MathTypeReturn {
     std::string ind2;
 };
 
-long double calculateExpression(MathNode* root);
+template<typename T>
+T calculateExpression(MathNode* root);
+
+template<typename T>
+T calculateProgram(const MathProgram<T>* program);
+
+template<typename T>
+void flattenExpression(MathNode* root);
 
 std::string getOperator(MathOperatorType type);
 
+template<typename T>
 MathNode* mathparse(const std::string& expr);
 
+template<typename T>
 MathNode* varparse(const std::string& expr);
 
+template<typename T>
+MathNode* arrayparse(const std::string& expr);
+
+bool usesWholeArrays(MathNode* node);
+
+template<typename T>
+ArrayProgram<T>* compileArrayExpression(MathNode* root, bool matrix);
+
+template<typename T>
+void assignArrayExpression(const ArrayProgram<T>* program, void* target);
+
 std::string getOperator(MathOperatorType type);
 
 // TOKENTYPE (all possible tokens)
@@ -73,6 +153,11 @@ enum TokenType {
     FLOOR,
     LISTIDENT,
     MATIDENT,
+    DICTIDENT,
+    HEAPIDENT,
+    BMATIDENT,
+    TYPEDIDENT,
+    SPARSEIDENT,
     ROUND,
     LOOP,
     SLOOP,
@@ -122,7 +207,83 @@ enum TokenType {
     MDEF,
     READF,
     WRITEF,
-    RANDOM
+    RANDOM,
+    LADD,
+    LSUB,
+    LMUL,
+    LDIV,
+    LAXPY,
+    LCLAMP,
+    LCMP,
+    MADD,
+    MSUB,
+    MMUL,
+    MDIV,
+    MAXPY,
+    MCLAMP,
+    MCMP,
+    VSIN,
+    VCOS,
+    VTAN,
+    VEXP,
+    VLOG,
+    VXROOT,
+    SETARRAY,
+    PLOOP,
+    SPAWN,
+    JOIN,
+    MATMUL,
+    MSOLVE,
+    MDET,
+    MINV,
+    MTRANS,
+    MLU,
+    FFT,
+    IFFT,
+    LCONV,
+    STENCIL,
+    LSUM,
+    LMIN,
+    LMAX,
+    LARGMAX,
+    LMEAN,
+    LVAR,
+    LDOT,
+    LSCAN,
+    LSORT,
+    LSORTIDX,
+    LBSEARCH,
+    LUNIQUE,
+    LUNION,
+    LINTERSECT,
+    CDICT,
+    DSET,
+    DGET,
+    DHAS,
+    DDEL,
+    DLEN,
+    CHEAP,
+    HPUSH,
+    HPOP,
+    HPEEK,
+    HLEN,
+    CBMAT,
+    BMAND,
+    BMOR,
+    BMXOR,
+    BMNOT,
+    BMCOUNT,
+    BMNEIGH,
+    CSPARSE,
+    SPMV,
+    LSWAP,
+    MSWAP,
+    LCOPY,
+    MCOPY,
+    LFILL,
+    MFILL,
+    MVIEW,
+    MMAT
 };
 
 class Node {
@@ -131,10 +292,14 @@ public:
     std::vector<Node*> children;
     void *value;
     MathNode* expression;
+    int line = 0;                    // line of the statement (counted like in the syntax check)
+    int hits = 0;                    // number of loop iterations (-1 if the JIT could not compile the loop)
+    void (*native)(int) = nullptr;   // native code generated by the JIT for the rest of the loop
 };
 
 /// FUNCTIONS
 
+template<typename T>
 Node* parseTree(const std::vector<std::vector<std::string> >& tokens, int startLine);
 
 void printMathTree(MathNode* root, int level);
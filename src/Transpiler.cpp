@@ -0,0 +1,966 @@
+/*
+ *  TRANSPILER.CPP
+ *  This file contains the ahead-of-time translator for the SquareBracket language.
+ *  The translator walks the parsed tree and writes an equivalent C++ program which only needs FilesIO.cpp as runtime.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include "Transpiler.h"
+#include "Recurser.h"
+
+std::ostringstream cpp; // translated statements of the main function
+std::unordered_map<void*, std::string> cppNames; // C++ names of all variables, lists and matrices
+std::vector<std::string> cppFunctions; // names of all declared or called functions
+bool inFunction = false; // is the current statement part of a function body
+int loopDepth = 0; // number of enclosing SLOOPs (each needs its own counter)
+std::unordered_map<void*, bool> declaredVars; // variables declared by the program (all others are predefined constants)
+bool cppLongDouble = true; // is the translated program compiled with scalar = long double (--precision=long)
+std::unordered_map<MathNode*, std::string> cppHoisted; // scalar subtrees of a whole-array expression that are computed before its loop
+
+template<typename T>
+void emitBlock(Node* block, int indent);
+
+// Helpers that are copied in front of the translated program; they mirror the checks of the interpreter
+const char* cppRuntime = R"(// RUNTIME #########################################################################
+
+//! Access a List Entry (With the Bounds Check of the Interpreter)
+inline scalar& sq_list(std::vector<scalar>& list, int i){
+    if(list.size() > i){
+        return list[i];
+    }
+    std::cerr << "Error: Index out of bounds for list <" << &list << "> at index <" << i << ">." << std::endl;
+    exit(0);
+}
+
+//! Access a Matrix Entry (With the Bounds Check of the Interpreter)
+inline scalar& sq_mat(Matrix<scalar>& mat, int i1, int i2){
+    if(mat.contains(i1, i2)){
+        return mat.at(i1, i2);
+    }
+    std::cerr << "Error: Index out of bounds for matrix <" << &mat << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+    exit(0);
+}
+
+//! Entry of a Bit Matrix that can be Read and Assigned Like a Number (Values Larger Than 0 Set the Bit)
+struct sq_bit {
+    BitMatrix& bits;
+    size_t i1;
+    size_t i2;
+    operator scalar() const { return bits.get(i1, i2); }
+    sq_bit& operator=(scalar value){ bits.set(i1, i2, value > 0); return *this; }
+    sq_bit& operator+=(scalar value){ return *this = (scalar)*this + value; }
+    sq_bit& operator-=(scalar value){ return *this = (scalar)*this - value; }
+};
+
+//! Access a Bit Matrix Entry (With the Bounds Check of the Interpreter)
+inline sq_bit sq_bits(BitMatrix& bits, int i1, int i2){
+    if(bits.contains(i1, i2)){
+        return sq_bit{bits, (size_t)i1, (size_t)i2};
+    }
+    std::cerr << "Error: Index out of bounds for matrix <" << &bits << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+    exit(0);
+}
+
+//! Entry of a Typed List or Matrix that can be Read and Assigned Like a Number (Converted to its Element Type)
+struct sq_entry {
+    TypedArray& array;
+    size_t k;
+    operator scalar() const { return array.load<scalar>(k); }
+    sq_entry& operator=(scalar value){ typedStore(&array, k, value); return *this; }
+    sq_entry& operator+=(scalar value){ return *this = (scalar)*this + value; }
+    sq_entry& operator-=(scalar value){ return *this = (scalar)*this - value; }
+};
+
+//! Access a Typed List Entry (With the Bounds Check of the Interpreter)
+inline sq_entry sq_typed(TypedArray& list, int i){
+    if(list.contains(i)){
+        return sq_entry{list, (size_t)i};
+    }
+    std::cerr << "Error: Index out of bounds for list <" << &list << "> at index <" << i << ">." << std::endl;
+    exit(0);
+}
+
+//! Access a Typed Matrix Entry (With the Bounds Check of the Interpreter)
+inline sq_entry sq_typed(TypedArray& mat, int i1, int i2){
+    if(mat.contains(i1, i2)){
+        return sq_entry{mat, (size_t)i1 * mat.cols + (size_t)i2};
+    }
+    std::cerr << "Error: Index out of bounds for matrix <" << &mat << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+    exit(0);
+}
+
+//! Read a Sparse Matrix Entry (With the Bounds Check of the Interpreter)
+inline scalar sq_sparse(const SparseMatrix<scalar>& sparse, int i1, int i2){
+    if(sparse.contains(i1, i2)){
+        return sparse.at(i1, i2);
+    }
+    std::cerr << "Error: Index out of bounds for matrix <" << &sparse << "> at indices <" << i1 << "," << i2 << ">." << std::endl;
+    exit(0);
+}
+
+//! Check the Domain of asin, acos and atan
+inline scalar sq_domain(scalar value, void* target, const char* func){
+    if(value > 1 || value < -1){
+        std::cerr << "Error: <" << target << "> " << func << " only accepts values from 1 to -1" << std::endl;
+        exit(0); // terminate program
+    }
+    return value;
+}
+
+//! Random Value in the Closed Interval From Min to Max
+inline scalar sq_random(scalar max, scalar min){
+    std::random_device rd;
+    std::seed_seq seed{ rd(), static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()) };
+    std::mt19937_64 eng(seed);
+    std::uniform_real_distribution<scalar> distr(min, max);
+    return distr(eng);
+}
+
+)";
+
+// AUXILIARY FUNCTIONS ##############################################################
+
+//! Turn a SquareBracket Identifier into a Valid C++ Identifier
+std::string cppIdentifier(const std::string& prefix, const std::string& name){
+    std::string id = prefix;
+    for(char c : name){
+        if(std::isalnum((unsigned char)c)){
+            id += c;
+        }else{
+            std::ostringstream hex;
+            hex << "_x" << std::hex << (int)(unsigned char)c;
+            id += hex.str();
+        }
+    }
+    return id;
+}
+
+//! Get the C++ Name of a Variable, List or Matrix
+std::string cppName(void* entry){
+    if(cppNames.find(entry) == cppNames.end()){
+        std::cerr << "Error: <" << entry << "> has no name and cannot be translated" << std::endl;
+        exit(0);
+    }
+    return cppNames[entry];
+}
+
+//! Get the C++ Name of a Function
+std::string cppFunction(const std::string& name){
+    if(std::find(cppFunctions.begin(), cppFunctions.end(), name) == cppFunctions.end()){
+        cppFunctions.push_back(name);
+    }
+    return cppIdentifier("f_", name);
+}
+
+//! Write a Number as Exact C++ Literal of Type scalar (Hexadecimal Floating Point)
+std::string cppNumber(long double value){
+    if(std::isnan(value)){
+        return "(scalar)NAN";
+    }
+    if(std::isinf(value)){
+        return value > 0 ? "(scalar)INFINITY" : "(-(scalar)INFINITY)";
+    }
+    std::ostringstream out;
+    if(cppLongDouble){
+        out << std::hexfloat << value << "L";
+    }else{
+        out << std::hexfloat << (double)value;
+    }
+    return value < 0 || std::signbit(value) ? "(" + out.str() + ")" : out.str();
+}
+
+//! Write a String as C++ Literal
+std::string cppString(const std::string& str){
+    std::ostringstream out;
+    out << '"';
+    for(char c : str){
+        if(c == '"' || c == '\\'){
+            out << '\\' << c;
+        }else if(std::isprint((unsigned char)c)){
+            out << c;
+        }else{
+            out << '\\' << std::oct << (int)(unsigned char)c << std::dec;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+//! Statement that Gives a Container its Name for the Errors of the Kernels
+std::string cppNameContainer(void* entry, const std::string& name){
+    return "    nameContainer(&" + cppName(entry) + ", " + cppString(name) + ");\n";
+}
+
+//! Write an Indented Line of the Translated Program
+inline void emitLine(int indent, const std::string& code){
+    cpp << std::string(indent * 4, ' ') << code << "\n";
+}
+
+//! Translate the Terminating Statement of the Current Function (LEAVE)
+inline std::string cppLeave(){
+    return inFunction ? "return;" : "return 0;";
+}
+
+//! Name of the Kernel Operation of an Elementwise Command
+std::string cppElementOperation(TokenType type){
+    switch(type){
+        case LADD: case MADD: return "KernelAdd";
+        case LSUB: case MSUB: return "KernelSub";
+        case LMUL: case MMUL: return "KernelMul";
+        default: return "KernelDiv";
+    }
+}
+
+//! Name of the Reduction of a Command (LSUM, LMIN, LMAX, LARGMAX, LMEAN, LVAR, LDOT)
+std::string cppReduceOp(TokenType type){
+    switch(type){
+        case LMIN: return "ReduceOp::MIN";
+        case LMAX: return "ReduceOp::MAX";
+        case LARGMAX: return "ReduceOp::ARGMAX";
+        case LMEAN: return "ReduceOp::MEAN";
+        case LVAR: return "ReduceOp::VAR";
+        case LDOT: return "ReduceOp::DOT";
+        default: return "ReduceOp::SUM";
+    }
+}
+
+//! Name of the Kernel Operation of a Comparison Operator (LCMP, MCMP)
+std::string cppComparison(const std::string& op){
+    switch(getComparisonType(op)){
+        case MathOperatorType::EQ: return "KernelEq";
+        case MathOperatorType::NEQ: return "KernelNeq";
+        case MathOperatorType::LESS: return "KernelLess";
+        case MathOperatorType::LESSEQ: return "KernelLessEq";
+        case MathOperatorType::LARGER: return "KernelLarger";
+        default: return "KernelLargerEq";
+    }
+}
+
+// EXPRESSIONS ######################################################################
+
+//! Translate a MathTree to a C++ Expression of Type scalar
+std::string cppExpression(MathNode* node){
+    std::string left;
+    std::string right;
+    if(cppHoisted.find(node) != cppHoisted.end()){
+        return cppHoisted[node];
+    }
+    switch(node->type){
+        case MathNodeType::Constant:
+            return cppNumber(node->constant);
+        case MathNodeType::Variable:
+            return cppName(node->variable);
+        case MathNodeType::Array:
+            return "sq_list(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "))";
+        case MathNodeType::Matrix:
+            return "sq_mat(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "), (int)(" + cppExpression(node->right) + "))";
+        case MathNodeType::Typed:
+            if(node->right == nullptr){
+                return "sq_typed(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "))";
+            }
+            return "sq_typed(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "), (int)(" + cppExpression(node->right) + "))";
+        case MathNodeType::Sparse:
+            return "sq_sparse(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "), (int)(" + cppExpression(node->right) + "))";
+        case MathNodeType::BitMatrix:
+            return "sq_bits(" + cppName(node->variable) + ", (int)(" + cppExpression(node->left) + "), (int)(" + cppExpression(node->right) + "))";
+        case MathNodeType::Dict:
+            return "dictGet(&" + cppName(node->variable) + ", (scalar)(" + cppExpression(node->left) + "))";
+        case MathNodeType::WholeList:
+            return cppName(node->variable) + "[sq_i]";
+        case MathNodeType::WholeMatrix:
+            return cppName(node->variable) + ".at(sq_r, sq_c)";
+        case MathNodeType::Select:
+            return "(" + cppExpression(node->left) + " > 0 ? " + cppExpression(node->right) + " : " + cppExpression(node->otherwise) + ")";
+        case MathNodeType::Operator:
+            left = cppExpression(node->left);
+            right = cppExpression(node->right);
+            switch(node->opt){
+                case MathOperatorType::PLUS: return "(" + left + " + " + right + ")";
+                case MathOperatorType::MINUS: return "(" + left + " - " + right + ")";
+                case MathOperatorType::MULT: return "(" + left + " * " + right + ")";
+                case MathOperatorType::DIV: return "(" + left + " / " + right + ")";
+                case MathOperatorType::MOD: return "fmod(" + left + ", " + right + ")";
+                case MathOperatorType::EXP: return "pow(" + left + ", " + right + ")";
+                case MathOperatorType::AND: return "(scalar)(" + left + " > 0 && " + right + " > 0)";
+                case MathOperatorType::OR: return "(scalar)(" + left + " > 0 || " + right + " > 0)";
+                case MathOperatorType::EQ: return "(scalar)(" + left + " == " + right + ")";
+                case MathOperatorType::NEQ: return "(scalar)(" + left + " != " + right + ")";
+                case MathOperatorType::LARGER: return "(scalar)(" + left + " > " + right + ")";
+                case MathOperatorType::LARGEREQ: return "(scalar)(" + left + " >= " + right + ")";
+                case MathOperatorType::LESS: return "(scalar)(" + left + " < " + right + ")";
+                case MathOperatorType::LESSEQ: return "(scalar)(" + left + " <= " + right + ")";
+                default: break;
+            }
+    }
+    return "0.0L";
+}
+
+//! Compute the Scalar Subtrees of a Whole-Array Expression Once Before its Loop
+void emitHoisted(MathNode* node, int indent){
+    if(!usesWholeArrays(node)){
+        if(node->type != MathNodeType::Constant && node->type != MathNodeType::Variable){
+            std::string name = "sq_s" + std::to_string(cppHoisted.size());
+            emitLine(indent, "const scalar " + name + " = " + cppExpression(node) + ";");
+            cppHoisted[node] = name;
+        }
+        return;
+    }
+    if(node->left != nullptr){ emitHoisted(node->left, indent); }
+    if(node->right != nullptr){ emitHoisted(node->right, indent); }
+    if(node->otherwise != nullptr){ emitHoisted(node->otherwise, indent); }
+}
+
+//! Translate an Assignment to a Whole List or Matrix to One Loop (SETARRAY)
+template<typename T>
+void emitArrayAssignment(Node* node, int indent){
+    auto program = (ArrayProgram<T>*)node->value;
+    std::string target = cppName(node->children[0]->value);
+    std::string first = program->operands.empty() ? target : cppName(program->operands[0]);
+    emitLine(indent, "{");
+    for(void* operand : program->operands){
+        emitLine(indent + 1, std::string(program->matrix ? "checkSameDimensions" : "checkSameLength") + "(&" + first + ", &" + cppName(operand) + ");");
+    }
+    emitLine(indent + 1, program->matrix ? "shapeLike(&" + target + ", &" + first + ");" : target + ".resize(" + first + ".size());");
+    emitHoisted(node->children[1]->expression, indent + 1);
+    std::string value = cppExpression(node->children[1]->expression);
+    if(program->matrix){
+        emitLine(indent + 1, "for(size_t sq_r = 0; sq_r < " + target + ".rows; sq_r++){");
+        emitLine(indent + 2, "for(size_t sq_c = 0; sq_c < " + target + ".cols; sq_c++){");
+        emitLine(indent + 3, target + ".at(sq_r, sq_c) = " + value + ";");
+        emitLine(indent + 2, "}");
+    }else{
+        emitLine(indent + 1, "for(size_t sq_i = 0; sq_i < " + target + ".size(); sq_i++){");
+        emitLine(indent + 2, target + "[sq_i] = " + value + ";");
+    }
+    emitLine(indent + 1, "}");
+    emitLine(indent, "}");
+    cppHoisted.clear();
+}
+
+//! Address of the Variable, List or Matrix Behind a Target (Used in Error Messages)
+inline std::string cppAddress(MathNode* varlist){
+    return "(void*)&" + cppName(varlist->variable);
+}
+
+// STATEMENTS #######################################################################
+
+//! Translate a Single Statement
+template<typename T>
+void emitStatement(Node* node, int indent){
+    std::string target;
+    std::string counter;
+    switch(node->type){
+        case EXEC:
+        case ROOT:
+            emitBlock<T>(node, indent);
+            break;
+        case END:
+            break;
+        case CVAR:
+            declaredVars[node->children[0]->value] = true;
+            emitLine(indent, cppName(node->children[0]->value) + " = " + cppExpression(node->children[1]->expression) + ";");
+            break;
+        case MVAR:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar value = " + cppExpression(node->children[1]->expression) + ";");
+            for(T* var : *(std::vector<T*>*)node->children[0]->value){
+                declaredVars[var] = true;
+                emitLine(indent + 1, cppName(var) + " = value;");
+            }
+            emitLine(indent, "}");
+            break;
+        case SET:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = " + cppExpression(node->children[1]->expression) + ";");
+            break;
+        case SETARRAY:
+            emitArrayAssignment<T>(node, indent);
+            break;
+        case INC:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " += 1;");
+            break;
+        case DEC:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " -= 1;");
+            break;
+        case CEIL:
+        case FLOOR:
+        case ABS:
+            target = cppExpression(node->children[0]->expression);
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar& target = " + target + ";");
+            emitLine(indent + 1, std::string("target = ") + (node->type == CEIL ? "ceil" : node->type == FLOOR ? "floor" : "abs") + "(target);");
+            emitLine(indent, "}");
+            break;
+        case ROUND:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar prec = " + cppExpression(node->children[1]->expression) + ";");
+            emitLine(indent + 1, "scalar& target = " + cppExpression(node->children[0]->expression) + ";");
+            emitLine(indent + 1, "target = round(target / prec) * prec;");
+            emitLine(indent, "}");
+            break;
+        case SIN:
+        case COS:
+        case TAN:
+        case CSC:
+        case SEC:
+        case COT:
+        case ASIN:
+        case ACOS:
+        case ATAN:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar inpVal = " + cppExpression(node->children[1]->expression) + ";");
+            switch(node->type){
+                case SIN: target = "sin(inpVal)"; break;
+                case COS: target = "cos(inpVal)"; break;
+                case TAN: target = "tan(inpVal)"; break;
+                case CSC: target = "1/(sin(inpVal))"; break;
+                case SEC: target = "1/(cos(inpVal))"; break;
+                case COT: target = "(cos(inpVal)/sin(inpVal))"; break;
+                case ASIN: target = "asin(sq_domain(inpVal, " + cppAddress(node->children[0]->expression) + ", \"asin\"))"; break;
+                case ACOS: target = "acos(sq_domain(inpVal, " + cppAddress(node->children[0]->expression) + ", \"acos\"))"; break;
+                default: target = "atan(sq_domain(inpVal, " + cppAddress(node->children[0]->expression) + ", \"atan\"))"; break;
+            }
+            emitLine(indent + 1, "scalar outVal = " + target + ";");
+            emitLine(indent + 1, cppExpression(node->children[0]->expression) + " = outVal;");
+            emitLine(indent, "}");
+            break;
+        case XROOT:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar inpVal = " + cppExpression(node->children[1]->expression) + ";");
+            emitLine(indent + 1, "scalar roottype = " + cppExpression(node->children[2]->expression) + ";");
+            emitLine(indent + 1, cppExpression(node->children[0]->expression) + " = pow(inpVal, 1.0/roottype);");
+            emitLine(indent, "}");
+            break;
+        case LOG:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar inpVal = " + cppExpression(node->children[1]->expression) + ";");
+            emitLine(indent + 1, "scalar expVal = " + cppExpression(node->children[2]->expression) + ";");
+            emitLine(indent + 1, cppExpression(node->children[0]->expression) + " = (log10(inpVal)/log10(expVal));");
+            emitLine(indent, "}");
+            break;
+        case RANDOM:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = sq_random(" + cppExpression(node->children[1]->expression) + ", " + cppExpression(node->children[2]->expression) + ");");
+            break;
+        case INPUT:
+            emitLine(indent, "std::cout << " + cppString(extract_string(*(std::string*)node->children[1]->value)) + ";");
+            emitLine(indent, "{");
+            emitLine(indent + 1, "scalar inputval;");
+            emitLine(indent + 1, "std::cin >> inputval;");
+            emitLine(indent + 1, cppExpression(node->children[0]->expression) + " = inputval;");
+            emitLine(indent, "}");
+            break;
+        case PRINT:
+            emitLine(indent, "std::cout << " + cppString(extract_string(*(std::string*)node->children[0]->value)) + " << std::endl;");
+            break;
+        case PRINTB:
+            emitLine(indent, "std::cout << " + cppString(extract_string(*(std::string*)node->children[0]->value)) + ";");
+            break;
+        case PRINTV:
+            emitLine(indent, "std::cout << " + cppExpression(node->children[0]->expression) + ";");
+            break;
+        case PRINTM:
+            target = cppName(node->children[0]->value);
+            emitLine(indent, "for(size_t i = 0; i < " + target + ".rows; i++){");
+            emitLine(indent + 1, "for(size_t j = 0; j < " + target + ".cols; j++){");
+            emitLine(indent + 2, "std::cout << " + target + ".at(i, j) << \" \";");
+            emitLine(indent + 1, "}");
+            emitLine(indent + 1, "std::cout << std::endl;");
+            emitLine(indent, "}");
+            break;
+        case NEWL:
+            emitLine(indent, "std::cout << std::endl;");
+            break;
+        case CLIST:
+            if(node->children[0]->type == TYPEDIDENT){
+                emitLine(indent, cppName(node->children[0]->value) + ".resize(std::max((int)" + cppExpression(node->children[1]->expression) + ", 0));");
+                break;
+            }
+            emitLine(indent, cppName(node->children[0]->value) + ".resize((int)" + cppExpression(node->children[1]->expression) + ");");
+            break;
+        case CMAT:
+            emitLine(indent, cppName(node->children[0]->value) + ".resize(std::max((int)" + cppExpression(node->children[1]->expression) + ", 0), std::max((int)" + cppExpression(node->children[2]->expression) + ", 0));");
+            break;
+        case GETL:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)" + cppName(node->children[1]->value) + ".size();");
+            break;
+        case GETDIM:
+            target = cppName(node->children[2]->value);
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)" + target + ".rows;");
+            emitLine(indent, cppExpression(node->children[1]->expression) + " = (scalar)" + target + ".cols;");
+            break;
+        case PUSH:
+            if(node->children[1]->type == TYPEDIDENT){
+                emitLine(indent, "typedPush(&" + cppName(node->children[1]->value) + ", (scalar)(" + cppExpression(node->children[0]->expression) + "));");
+                break;
+            }
+            emitLine(indent, cppName(node->children[1]->value) + ".push_back(" + cppExpression(node->children[0]->expression) + ");");
+            break;
+        case POP:
+            target = cppName(node->children[1]->value);
+            if(node->children[1]->type == TYPEDIDENT){
+                emitLine(indent, cppExpression(node->children[0]->expression) + " = typedPop<scalar>(&" + target + ");");
+                break;
+            }
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = " + target + ".back();");
+            emitLine(indent, target + ".pop_back();");
+            break;
+        case CHSL:
+            if(node->children[0]->type == TYPEDIDENT){
+                emitLine(indent, cppName(node->children[0]->value) + ".resize(std::max((int)" + cppExpression(node->children[1]->expression) + ", 0));");
+                break;
+            }
+            emitLine(indent, cppName(node->children[0]->value) + ".resize((int)" + cppExpression(node->children[1]->expression) + ");");
+            break;
+        case LDEF: {
+            std::string content = extract_list_string(*(std::string*)node->children[1]->value);
+            content.erase(std::remove_if(content.begin(), content.end(), [](char ch){ return std::isspace(ch); }), content.end());
+            emitLine(indent, "parse_numbers(" + cppString(content) + ", &" + cppName(node->children[0]->value) + ");");
+            break;
+        }
+        case MDEF:
+            emitLine(indent, "{");
+            emitLine(indent + 1, "std::string matrix_string = " + cppString(*(std::string*)node->children[1]->value) + ";");
+            emitLine(indent + 1, "parse_matrix(matrix_string, &" + cppName(node->children[0]->value) + ");");
+            emitLine(indent, "}");
+            break;
+        case READF:
+            emitLine(indent, "read_csv(" + cppString(extract_string(*(std::string*)node->children[1]->value)) + ", &" + cppName(node->children[0]->value) + ");");
+            break;
+        case WRITEF:
+            emitLine(indent, "write_csv(" + cppString(extract_string(*(std::string*)node->children[1]->value)) + ", &" + cppName(node->children[0]->value) + ");");
+            break;
+        case LADD:
+        case LSUB:
+        case LMUL:
+        case LDIV:
+        case LCMP:
+        case MADD:
+        case MSUB:
+        case MMUL:
+        case MDIV:
+        case MCMP: {
+            Node* operand = node->children.back();
+            std::string kernel = (node->children[0]->type == MATIDENT ? "matrixBinary" : "listBinary") + std::string(operand->type == EXPRESSION ? "Scalar" : "");
+            std::string op = node->children.size() == 4 ? cppComparison(*(std::string*)node->children[2]->value) : cppElementOperation(node->type);
+            std::string arg = operand->type == EXPRESSION ? "(scalar)(" + cppExpression(operand->expression) + ")" : "&" + cppName(operand->value);
+            emitLine(indent, kernel + "<" + op + ">(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", " + arg + ");");
+            break;
+        }
+        case VSIN:
+        case VCOS:
+        case VTAN:
+        case VEXP:
+        case VLOG:
+        case VXROOT: {
+            std::string fn = node->type == VSIN ? "VectorSin" : node->type == VCOS ? "VectorCos" : node->type == VTAN ? "VectorTan" : node->type == VEXP ? "VectorExp" : node->type == VLOG ? "VectorLog" : "VectorRoot";
+            std::string arg = node->children.size() > 2 ? "(scalar)(" + cppExpression(node->children[2]->expression) + ")" : "";
+            std::string map = node->children[0]->type == MATIDENT ? "matrixMap" : "listMap";
+            emitLine(indent, map + "(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", " + fn + "<scalar>(" + arg + "));");
+            break;
+        }
+        case MATMUL: {
+            std::string mode = *(std::string*)node->children[3]->value;
+            emitLine(indent, "matrixMultiply(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value)
+                     + ", " + (mode[0] == 't' ? "true" : "false") + ", " + (mode[1] == 't' ? "true" : "false") + ", 1, SerialRunner());");
+            break;
+        }
+        case MSOLVE:
+            emitLine(indent, std::string(node->children[0]->type == MATIDENT ? "matrixSolve" : "listSolve") + "(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value)
+                     + ", &" + cppName(node->children[2]->value) + ", 1, SerialRunner());");
+            break;
+        case MDET:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = matrixDeterminant(&" + cppName(node->children[1]->value) + ", 1, SerialRunner());");
+            break;
+        case MINV:
+            emitLine(indent, "matrixInverse(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", 1, SerialRunner());");
+            break;
+        case MTRANS:
+            emitLine(indent, "matrixTranspose(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ");");
+            break;
+        case LSUM:
+        case LMIN:
+        case LMAX:
+        case LARGMAX:
+        case LMEAN:
+        case LVAR:
+        case LDOT: {
+            const std::string& mode = *(std::string*)node->children.back()->value;
+            std::string sources = "&" + cppName(node->children[1]->value) + ", " + (node->type == LDOT ? "&" + cppName(node->children[2]->value) : "nullptr");
+            std::string rest = std::string(mode[2] == 'k' ? "true" : "false") + ", 1, SerialRunner());";
+            if(mode[0] != 'a'){
+                std::string reduce = mode[0] == 'r' ? "reduceRows<scalar>(" : "reduceCols<scalar>(";
+                emitLine(indent, reduce + cppReduceOp(node->type) + ", &" + cppName(node->children[0]->value) + ", " + sources + ", " + rest);
+            }else{
+                std::string reduce = node->children[1]->type == MATIDENT ? "reduceMatrix<scalar>(" : "reduceList<scalar>(";
+                emitLine(indent, cppExpression(node->children[0]->expression) + " = " + reduce + cppReduceOp(node->type) + ", " + sources + ", " + rest);
+            }
+            break;
+        }
+        case LSCAN: {
+            const std::string& mode = *(std::string*)node->children[2]->value;
+            std::string flags = std::string(mode[1] == 'e' ? "true" : "false") + ", " + (mode[2] == 'k' ? "true" : "false");
+            if(node->children[0]->type == MATIDENT){
+                emitLine(indent, "matrixScan(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", " + (mode[0] == 'c' ? "true" : "false") + ", " + flags + ", 1, SerialRunner());");
+            }else{
+                emitLine(indent, "listScan(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", " + flags + ", SerialRunner());");
+            }
+            break;
+        }
+        case CDICT:
+            emitLine(indent, cppName(node->children[0]->value) + ".clear();");
+            break;
+        case DSET:
+            emitLine(indent, "dictSet(&" + cppName(node->children[0]->value) + ", (scalar)(" + cppExpression(node->children[1]->expression) + "), (scalar)(" + cppExpression(node->children[2]->expression) + "));");
+            break;
+        case DDEL:
+            emitLine(indent, cppName(node->children[0]->value) + ".erase(" + cppExpression(node->children[1]->expression) + ");");
+            break;
+        case DGET:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = dictGet(&" + cppName(node->children[1]->value) + ", (scalar)(" + cppExpression(node->children[2]->expression) + ")"
+                     + (node->children.size() > 3 ? ", (scalar)(" + cppExpression(node->children[3]->expression) + ")" : std::string()) + ");");
+            break;
+        case DHAS:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)(" + cppName(node->children[1]->value) + ".find(" + cppExpression(node->children[2]->expression) + ") != nullptr);");
+            break;
+        case DLEN:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)" + cppName(node->children[1]->value) + ".size();");
+            break;
+        case CHEAP:
+            emitLine(indent, cppName(node->children[0]->value) + ".clear();");
+            break;
+        case HPUSH:
+            emitLine(indent, "heapPush(&" + cppName(node->children[2]->value) + ", (scalar)(" + cppExpression(node->children[0]->expression) + "), (scalar)(" + cppExpression(node->children[1]->expression) + "));");
+            break;
+        case HPOP:
+        case HPEEK: {
+            std::string heap = cppName(node->children[1]->value);
+            emitLine(indent, "heapFront(&" + heap + ");");
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = " + heap + ".values[0];");
+            if(node->children.size() > 2){
+                emitLine(indent, cppExpression(node->children[2]->expression) + " = " + heap + ".priorities[0];");
+            }
+            if(node->type == HPOP){
+                emitLine(indent, heap + ".pop();");
+            }
+            break;
+        }
+        case HLEN:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)" + cppName(node->children[1]->value) + ".size();");
+            break;
+        case CBMAT:
+            emitLine(indent, cppName(node->children[0]->value) + ".resize(std::max((int)" + cppExpression(node->children[1]->expression) + ", 0), std::max((int)" + cppExpression(node->children[2]->expression) + ", 0));");
+            break;
+        case BMAND:
+        case BMOR:
+        case BMXOR:
+            emitLine(indent, "bitsBinary(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value) + ", "
+                     + (node->type == BMAND ? "BitOp::AND" : node->type == BMOR ? "BitOp::OR" : "BitOp::XOR") + ");");
+            break;
+        case BMNOT:
+            emitLine(indent, "bitsNot(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ");");
+            break;
+        case BMCOUNT:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = (scalar)bitsCount(&" + cppName(node->children[1]->value) + ");");
+            break;
+        case BMNEIGH:
+            emitLine(indent, "bitsNeighbours(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", bitsCounts(\"" + *(std::string*)node->children[2]->value + "\"), 1, SerialRunner());");
+            break;
+        case LSORT:
+        case LSORTIDX:
+            emitLine(indent, std::string(node->type == LSORTIDX ? "listSortIndex" : "listSort") + "(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", "
+                     + (*(std::string*)node->children[2]->value == "desc" ? "true" : "false") + ", 1, SerialRunner());");
+            break;
+        case LBSEARCH:
+            emitLine(indent, cppExpression(node->children[0]->expression) + " = listSearch(&" + cppName(node->children[1]->value) + ", (scalar)(" + cppExpression(node->children[2]->expression) + "));");
+            break;
+        case LUNIQUE:
+            emitLine(indent, "listUnique(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", 1, SerialRunner());");
+            break;
+        case LUNION:
+        case LINTERSECT:
+            emitLine(indent, "listSetOperation(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value) + ", "
+                     + (node->type == LINTERSECT ? "true" : "false") + ", 1, SerialRunner());");
+            break;
+        case CSPARSE: {
+            std::string triplets = "std::vector<scalar>(), std::vector<scalar>(), std::vector<scalar>()";
+            if(node->children.size() == 6){
+                triplets = cppName(node->children[3]->value) + ", " + cppName(node->children[4]->value) + ", " + cppName(node->children[5]->value);
+            }
+            emitLine(indent, "sparseBuild(&" + cppName(node->children[0]->value) + ", std::max((int)" + cppExpression(node->children[1]->expression) + ", 0), std::max((int)"
+                     + cppExpression(node->children[2]->expression) + ", 0), " + triplets + ");");
+            break;
+        }
+        case SPMV:
+            emitLine(indent, "sparseMultiply(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value) + ", 1, SerialRunner());");
+            break;
+        case LSWAP:
+        case MSWAP:
+            emitLine(indent, cppName(node->children[0]->value) + ".swap(" + cppName(node->children[1]->value) + ");");
+            break;
+        case LCOPY:
+        case MCOPY:
+            emitLine(indent, std::string(node->type == LCOPY ? "listCopy" : "matrixCopy") + "(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ");");
+            break;
+        case LFILL:
+        case MFILL:
+            emitLine(indent, std::string(node->type == LFILL ? "listFill" : "matrixFill") + "(&" + cppName(node->children[0]->value) + ", (scalar)(" + cppExpression(node->children[1]->expression) + "));");
+            break;
+        case MVIEW:
+            emitLine(indent, "matrixView(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", (int)" + cppExpression(node->children[2]->expression) + ", (int)"
+                     + cppExpression(node->children[3]->expression) + ", (int)" + cppExpression(node->children[4]->expression) + ", (int)" + cppExpression(node->children[5]->expression) + ");");
+            break;
+        case MMAT:
+            emitLine(indent, "matrixMapFile(&" + cppName(node->children[0]->value) + ", " + cppString(extract_string(*(std::string*)node->children[1]->value)) + ", (int)"
+                     + cppExpression(node->children[2]->expression) + ", (int)" + cppExpression(node->children[3]->expression) + ");");
+            break;
+        case STENCIL:
+            emitLine(indent, "matrixStencil(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value)
+                     + ", stencilBorder(\"" + *(std::string*)node->children[3]->value + "\"), 1, SerialRunner());");
+            break;
+        case FFT:
+        case IFFT:
+            emitLine(indent, "listFft(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", " + (node->type == IFFT ? "true" : "false") + ");");
+            break;
+        case LCONV:
+            emitLine(indent, "listConvolve(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value) + ");");
+            break;
+        case MLU:
+            emitLine(indent, "matrixLU(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", &" + cppName(node->children[2]->value) + ", 1, SerialRunner());");
+            break;
+        case LAXPY:
+        case MAXPY:
+            emitLine(indent, std::string(node->type == MAXPY ? "matrixAxpy" : "listAxpy") + "(&" + cppName(node->children[0]->value) + ", (scalar)(" + cppExpression(node->children[1]->expression) + "), &" + cppName(node->children[2]->value) + ");");
+            break;
+        case LCLAMP:
+        case MCLAMP:
+            emitLine(indent, std::string(node->type == MCLAMP ? "matrixClamp" : "listClamp") + "(&" + cppName(node->children[0]->value) + ", &" + cppName(node->children[1]->value) + ", (scalar)(" + cppExpression(node->children[2]->expression) + "), (scalar)(" + cppExpression(node->children[3]->expression) + "));");
+            break;
+        case SLEEP:
+            emitLine(indent, "std::this_thread::sleep_for(std::chrono::milliseconds(size_t(" + cppExpression(node->children[0]->expression) + ")));");
+            break;
+        case LOOP:
+            target = cppExpression(node->children[0]->expression);
+            emitLine(indent, "while(" + target + " > 0){");
+            emitBlock<T>(node->children[1], indent + 1);
+            emitLine(indent + 1, target + " = " + target + " - 1;");
+            emitLine(indent, "}");
+            break;
+        case AUTOLOOP:
+            target = cppExpression(node->children[0]->expression);
+            emitLine(indent, target + " = " + cppExpression(node->children[1]->expression) + ";");
+            emitLine(indent, "while(" + target + " > 0){");
+            emitBlock<T>(node->children[2], indent + 1);
+            emitLine(indent + 1, target + " = " + target + " - 1;");
+            emitLine(indent, "}");
+            break;
+        case PLOOP:
+            // translated to a sequential loop (same iterations and output as the interpreter)
+            target = cppExpression(node->children[0]->expression);
+            emitLine(indent, target + " = " + cppExpression(node->children[1]->expression) + ";");
+            emitLine(indent, "while(" + target + " > 0){");
+            emitBlock<T>(node->children[2], indent + 1);
+            emitLine(indent + 1, target + " = " + target + " - 1;");
+            emitLine(indent, "}");
+            break;
+        case SLOOP:
+            counter = "loopc" + std::to_string(loopDepth++);
+            emitLine(indent, "for(int " + counter + " = (int)" + cppExpression(node->children[0]->expression) + "; " + counter + " > 0; " + counter + "--){");
+            emitBlock<T>(node->children[1], indent + 1);
+            emitLine(indent, "}");
+            loopDepth--;
+            break;
+        case WHILE:
+            emitLine(indent, "while(" + cppExpression(node->children[0]->expression) + " > 0){");
+            emitBlock<T>(node->children[1], indent + 1);
+            emitLine(indent, "}");
+            break;
+        case IF:
+            emitLine(indent, "if(" + cppExpression(node->children[0]->expression) + " > 0){");
+            emitLine(indent + 1, "if_state = false;");
+            emitBlock<T>(node->children[1], indent + 1);
+            emitLine(indent, "}else{");
+            emitLine(indent + 1, "if_state = true;");
+            emitLine(indent, "}");
+            break;
+        case ELIF:
+            emitLine(indent, "if(if_state){");
+            emitLine(indent + 1, "if(" + cppExpression(node->children[0]->expression) + " > 0){");
+            emitLine(indent + 2, "if_state = false;");
+            emitBlock<T>(node->children[1], indent + 2);
+            emitLine(indent + 1, "}else{");
+            emitLine(indent + 2, "if_state = true;");
+            emitLine(indent + 1, "}");
+            emitLine(indent, "}");
+            break;
+        case ELSE:
+            emitLine(indent, "if(if_state){");
+            emitLine(indent + 1, "if_state = false;");
+            emitBlock<T>(node->children[0], indent + 1);
+            emitLine(indent, "}");
+            break;
+        case FUNCT: {
+            std::string name = *(std::string*)node->children[0]->value;
+            std::string function = cppFunction(name);
+            emitLine(indent, "if(" + function + "){");
+            emitLine(indent + 1, "std::cerr << \"Error: function <\" << " + cppString(name) + " << \"> is aleady defined\" << std::endl;");
+            emitLine(indent + 1, "exit(0); // terminate program");
+            emitLine(indent, "}");
+            emitLine(indent, function + " = [&](){");
+            bool outer = inFunction;
+            int outerDepth = loopDepth;
+            inFunction = true;
+            loopDepth = 0;
+            emitBlock<T>(node->children[1], indent + 1);
+            inFunction = outer;
+            loopDepth = outerDepth;
+            emitLine(indent, "};");
+            break;
+        }
+        case CALL:
+        case SPAWN: {
+            // spawned functions run when they are spawned (the same results as the interpreter)
+            std::string name = *(std::string*)node->children[0]->value;
+            std::string function = cppFunction(name);
+            emitLine(indent, "if(!" + function + "){");
+            emitLine(indent + 1, "std::cerr << \"Error: function <\" << " + cppString(name) + " << \"> is not defined\" << std::endl;");
+            emitLine(indent + 1, "exit(0);");
+            emitLine(indent, "}");
+            emitLine(indent, function + "();");
+            emitLine(indent, "if_state = false;");
+            break;
+        }
+        case JOIN:
+            break;
+        case LEAVE:
+            emitLine(indent, cppLeave());
+            break;
+        case EXIT:
+            emitLine(indent, "exit(0);");
+            break;
+        default:
+            std::cerr << "Error: command <" << node->type << "> cannot be translated to C++" << std::endl;
+            exit(0);
+    }
+}
+
+//! Translate All Statements of a Block
+template<typename T>
+void emitBlock(Node* block, int indent){
+    for(Node* statement : block->children){
+        emitStatement<T>(statement, indent);
+    }
+}
+
+//! Sorted Names of a Symbol Table
+template<typename T>
+std::vector<std::string> sortedNames(const std::unordered_map<std::string, T>& table){
+    std::vector<std::string> names;
+    for(const auto& entry : table){
+        names.push_back(entry.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+//! Translate the Parsed Tree to a Standalone C++ Program and Write it to filename
+template<typename T>
+void emitCpp(Node* root, const std::string& filename, const std::string& source){
+    cppLongDouble = std::is_same<T, long double>::value;
+    for(const auto& entry : vars<T>){
+        cppNames[entry.second] = cppIdentifier("v_", entry.first);
+    }
+    for(const auto& entry : ars<T>){
+        cppNames[entry.second] = cppIdentifier("l_", entry.first);
+    }
+    for(const auto& entry : mars<T>){
+        cppNames[entry.second] = cppIdentifier("m_", entry.first);
+    }
+    for(const auto& entry : dicts<T>){
+        cppNames[entry.second] = cppIdentifier("d_", entry.first);
+    }
+    for(const auto& entry : heaps<T>){
+        cppNames[entry.second] = cppIdentifier("h_", entry.first);
+    }
+    for(const auto& entry : bmats<T>){
+        cppNames[entry.second] = cppIdentifier("b_", entry.first);
+    }
+    for(const auto& entry : typeds<T>){
+        cppNames[entry.second] = cppIdentifier("t_", entry.first);
+    }
+    for(const auto& entry : sparses<T>){
+        cppNames[entry.second] = cppIdentifier("s_", entry.first);
+    }
+    emitBlock<T>(root, 1);
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file: " << filename << std::endl;
+        exit(0);
+    }
+    file << "/*\n";
+    file << " *  Translated from " << source << " by sqbra --emit-cpp (Version 2.2.3).\n";
+    file << " *  Build: g++ -O2 -std=c++17 -I<sqbra>/src " << filename << " <sqbra>/src/FilesIO.cpp\n";
+    file << " */\n\n";
+    file << "#include \"Recurser.h\"\n#include <cstring>\n#include <functional>\n#include <thread>\n\n";
+    file << "typedef " << (cppLongDouble ? "long double" : "double") << " scalar; // --precision=" << (cppLongDouble ? "long" : "double") << "\n\n";
+    file << cppRuntime;
+    file << "// PROGRAM #########################################################################\n\n";
+    file << "int main(int argc, char *argv[]) {\n";
+    file << "    std::cout.precision(17); // set precision for output\n";
+    file << "    bool if_state = false; // was the previous if or elif false --> enables execution of next elif or else\n";
+    for(const std::string& name : sortedNames(vars<T>)){
+        // predefined constants keep their value, all other variables start at zero
+        T value = declaredVars.find(vars<T>[name]) == declaredVars.end() ? *vars<T>[name] : 0;
+        file << "    scalar " << cppName(vars<T>[name]) << " = " << cppNumber(value) << ";\n";
+    }
+    for(const std::string& name : sortedNames(ars<T>)){
+        file << "    std::vector<scalar> " << cppName(ars<T>[name]) << ";\n";
+        file << cppNameContainer(ars<T>[name], name);
+    }
+    for(const std::string& name : sortedNames(mars<T>)){
+        file << "    Matrix<scalar> " << cppName(mars<T>[name]) << ";\n";
+        file << cppNameContainer(mars<T>[name], name);
+        if(mars<T>[name]->view){
+            file << "    " << cppName(mars<T>[name]) << ".view = true;\n";
+        }
+    }
+    for(const std::string& name : sortedNames(dicts<T>)){
+        file << "    Dict<scalar> " << cppName(dicts<T>[name]) << ";\n";
+        file << cppNameContainer(dicts<T>[name], name);
+    }
+    for(const std::string& name : sortedNames(heaps<T>)){
+        file << "    Heap<scalar> " << cppName(heaps<T>[name]) << ";\n";
+        file << cppNameContainer(heaps<T>[name], name);
+    }
+    for(const std::string& name : sortedNames(bmats<T>)){
+        file << "    BitMatrix " << cppName(bmats<T>[name]) << ";\n";
+        file << cppNameContainer(bmats<T>[name], name);
+    }
+    for(const std::string& name : sortedNames(sparses<T>)){
+        file << "    SparseMatrix<scalar> " << cppName(sparses<T>[name]) << ";\n";
+        file << cppNameContainer(sparses<T>[name], name);
+    }
+    for(const std::string& name : sortedNames(typeds<T>)){
+        TypedArray* array = typeds<T>[name];
+        file << "    TypedArray " << cppName(array) << "(ElementType::" << (char)std::toupper(elementName(array->type)[0]) << (elementName(array->type) + 1) << ", " << (array->matrix ? "true" : "false") << ");\n";
+        file << cppNameContainer(array, name);
+    }
+    for(const std::string& name : cppFunctions){
+        file << "    std::function<void()> " << cppIdentifier("f_", name) << ";\n";
+    }
+    if(ars<T>.find("args") != ars<T>.end()){
+        // input values are given like for the interpreter: [-I] value1 value2 ...
+        file << "    for (int i = 1; i < argc; i++) {\n";
+        file << "        if (strcmp(argv[i], \"-I\") != 0) {\n";
+        file << "            " << cppName(ars<T>["args"]) << ".push_back((scalar)std::stold(argv[i]));\n";
+        file << "        }\n";
+        file << "    }\n";
+    }
+    file << "\n" << cpp.str();
+    file << "    return 0;\n";
+    file << "}\n";
+}
+
+// INSTANTIATIONS (double and long double) ##########################################
+
+template void emitCpp<double>(Node* root, const std::string& filename, const std::string& source);
+template void emitCpp<long double>(Node* root, const std::string& filename, const std::string& source);
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef SQBRA_TRANSPILER_H
+#define SQBRA_TRANSPILER_H
+
+/*
+ *  TRANSPILER.H
+ *  This file declares the ahead-of-time translation of a parsed program to C++.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <string>
+
+#include "Tokens.h"
+
+/// FUNCTIONS
+
+template<typename T>
+void emitCpp(Node* root, const std::string& filename, const std::string& source);
+
+#endif //SQBRA_TRANSPILER_H
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef SQBRA_TYPEDARRAY_H
+#define SQBRA_TYPEDARRAY_H
+
+/*
+ *  TYPEDARRAY.H
+ *  This file declares the typed lists and matrices of the SquareBracket language (clist name n i32, cmat name r c f32).
+ *  Their entries are stored as 32 or 64 bit integers or floating point numbers instead of the numbers of the program,
+ *  which needs 2 to 4 times less memory than a long double. Every read converts an entry to a number of the program
+ *  and every write converts it back: integer types drop the fraction (like an index) and reject values out of range.
+ *  Copyright (c) 2023, Patrick De Smet
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Names.h"
+
+//! Type of the Entries of a Typed List or Matrix
+enum class ElementType : uint8_t { I32, I64, F32, F64 };
+
+//! Element Type for its Name in the Program (i32, i64, f32 or f64); Returns False for Other Names
+inline bool elementType(const std::string& name, ElementType& type){
+    if(name == "i32"){ type = ElementType::I32; }
+    else if(name == "i64"){ type = ElementType::I64; }
+    else if(name == "f32"){ type = ElementType::F32; }
+    else if(name == "f64"){ type = ElementType::F64; }
+    else{ return false; }
+    return true;
+}
+
+//! Name of an Element Type in the Program
+inline const char* elementName(ElementType type){
+    switch(type){
+        case ElementType::I32: return "i32";
+        case ElementType::I64: return "i64";
+        case ElementType::F32: return "f32";
+        default: return "f64";
+    }
+}
+
+//! Size of an Entry in Bytes
+inline size_t elementSize(ElementType type){
+    return type == ElementType::I32 || type == ElementType::F32 ? 4 : 8;
+}
+
+struct TypedArray {
+    ElementType type;
+    bool matrix;
+    size_t rows = 0;
+    size_t cols;                     // a list is one column
+    std::vector<unsigned char> bytes; // all entries row by row
+
+    TypedArray(ElementType type, bool matrix) : type(type), matrix(matrix), cols(matrix ? 0 : 1) {}
+
+    //! Number of Entries
+    size_t size() const { return rows * cols; }
+
+    //! Check Whether the Index Addresses an Entry of the List
+    bool contains(int i) const { return i >= 0 && (size_t)i < size(); }
+
+    //! Check Whether the Indices Address an Entry of the Matrix
+    bool contains(int i, int j) const { return i >= 0 && j >= 0 && (size_t)i < rows && (size_t)j < cols; }
+
+    //! Entry k (Row by Row) Converted to a Number of the Program
+    template<typename T>
+    T load(size_t k) const {
+        const unsigned char* data = bytes.data();
+        switch(type){
+            case ElementType::I32: return (T)((const int32_t*)data)[k];
+            case ElementType::I64: return (T)((const int64_t*)data)[k];
+            case ElementType::F32: return (T)((const float*)data)[k];
+            default: return (T)((const double*)data)[k];
+        }
+    }
+
+    //! Set Entry k (Row by Row); Returns False if the Value does not Fit Into an Integer Entry
+    template<typename T>
+    bool store(size_t k, T value){
+        unsigned char* data = bytes.data();
+        switch(type){
+            case ElementType::I32:
+                if(!(value > (T)-2147483649.0 && value < (T)2147483648.0)){
+                    return false;
+                }
+                ((int32_t*)data)[k] = (int32_t)value;
+                return true;
+            case ElementType::I64:
+                if(!(value >= (T)-9223372036854775808.0 && value < (T)9223372036854775808.0)){
+                    return false;
+                }
+                ((int64_t*)data)[k] = (int64_t)value;
+                return true;
+            case ElementType::F32:
+                ((float*)data)[k] = (float)value;
+                return true;
+            default:
+                ((double*)data)[k] = (double)value;
+                return true;
+        }
+    }
+
+    //! Change the Length of a List; Existing Entries Stay, New Entries are Zero
+    void resize(size_t length){
+        resize(length, 1);
+    }
+
+    //! Change the Dimensions; Existing Entries Keep Their Position, New Entries are Zero
+    void resize(size_t newRows, size_t newCols){
+        size_t entry = elementSize(type);
+        if(newCols == cols || rows == 0){
+            bytes.resize(newRows * newCols * entry);
+        }else{
+            std::vector<unsigned char> result(newRows * newCols * entry);
+            for(size_t i = 0; i < rows && i < newRows; i++){
+                std::memcpy(result.data() + i * newCols * entry, bytes.data() + i * cols * entry, std::min(cols, newCols) * entry);
+            }
+            bytes.swap(result);
+        }
+        rows = newRows;
+        cols = newCols;
+    }
+};
+
+//! Set Entry k of a Typed List or Matrix (With the Error of the Interpreter if the Value does not Fit)
+template<typename T>
+inline void typedStore(TypedArray* array, size_t k, T value){
+    if(!array->store(k, value)){
+        std::cerr << "Error: value <" << value << "> does not fit into the " << elementName(array->type) << " entries of <" << containerName(array) << ">." << std::endl;
+        exit(0);
+    }
+}
+
+//! Append a Value to a Typed List
+template<typename T>
+inline void typedPush(TypedArray* list, T value){
+    list->resize(list->size() + 1);
+    typedStore(list, list->size() - 1, value);
+}
+
+//! Remove the Last Value of a Typed List and Return it
+template<typename T>
+inline T typedPop(TypedArray* list){
+    if(list->size() == 0){
+        std::cerr << "Error: list <" << containerName(list) << "> is empty." << std::endl;
+        exit(0);
+    }
+    T value = list->load<T>(list->size() - 1);
+    list->resize(list->size() - 1);
+    return value;
+}
+
+#endif //SQBRA_TYPEDARRAY_H
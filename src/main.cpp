@@ -6,6 +6,10 @@
 #include "Lexer.h"
 #include "Tokens.h"
 #include "Recurser.h"
+#include "Bytecode.h"
+#include "Jit.h"
+#include "Transpiler.h"
+#include "Parallel.h"
 
 /*
  *  MAIN.CPP
@@ -17,18 +21,72 @@ void print_man_page() {
     std::cout << "Usage: sqbra <flags> path-to-code.sqbr [input]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "\t-pt\tPrints the parsing tree without executing the code" << std::endl;
+    std::cout << "\t-pb\tPrints the compiled bytecode without executing the code" << std::endl;
     std::cout << "\t-c\tChecks the code and prints potential errors" << std::endl;
     std::cout << "\t-I\tIndicates that some initial input variables are given" << std::endl;
     std::cout << "\t-v\tPrints the current version of the interpreter" << std::endl;
+    std::cout << "\t--engine=tree|vm\tExecutes the code with the tree walker (default) or the bytecode machine" << std::endl;
+    std::cout << "\t--precision=double|long\tComputes with double or long double (default) values" << std::endl;
+    std::cout << "\t--jit\tCompiles hot expressions and simple loops to native code (x86-64 Linux)" << std::endl;
+    std::cout << "\t--threads=<n>\tNumber of threads of ploop (default: number of hardware threads)" << std::endl;
+    std::cout << "\t--auto-parallel\tRuns autoloop and sloop in parallel if their iterations are independent and reports the decisions" << std::endl;
+    std::cout << "\t--emit-cpp <file>\tTranslates the code to a standalone C++ program without executing it" << std::endl;
 }
 
-std::string parse_inputcommand(int argc, char** argv, bool& pt, bool& c, bool& v, bool& inp) {
+std::string parse_inputcommand(int argc, char** argv, bool& pt, bool& pb, bool& c, bool& v, bool& inp, bool& vm, bool& dbl, std::string& cpp, std::vector<long double>& input) {
     std::string codepath;
     for (int i = 1; i < argc; i++) {
         if (argv[i][0] == '-') {
             if (strcmp(argv[i], "-pt") == 0) {
                 pt = true;
             }
+            else if (strcmp(argv[i], "-pb") == 0) {
+                pb = true;
+            }
+            else if (strcmp(argv[i], "--engine=tree") == 0) {
+                vm = false;
+            }
+            else if (strcmp(argv[i], "--engine=vm") == 0) {
+                vm = true;
+            }
+            else if (strcmp(argv[i], "--precision=double") == 0) {
+                dbl = true;
+            }
+            else if (strcmp(argv[i], "--precision=long") == 0) {
+                dbl = false;
+            }
+            else if (strncmp(argv[i], "--precision=", 12) == 0) {
+                std::cout << "Error: unknown precision <" << argv[i] + 12 << "> (use double or long)" << std::endl;
+                exit(1);
+            }
+            else if (strcmp(argv[i], "--jit") == 0) {
+                if (jitSupported()) {
+                    jit_enabled = true;
+                } else {
+                    std::cerr << "Warning: --jit is not supported on this platform, the code is interpreted" << std::endl;
+                }
+            }
+            else if (strncmp(argv[i], "--threads=", 10) == 0) {
+                thread_count = atoi(argv[i] + 10);
+                if (thread_count < 1) {
+                    std::cout << "Error: --threads requires a positive number" << std::endl;
+                    exit(1);
+                }
+            }
+            else if (strcmp(argv[i], "--auto-parallel") == 0) {
+                auto_parallel = true;
+            }
+            else if (strcmp(argv[i], "--emit-cpp") == 0) {
+                if (i + 1 >= argc) {
+                    std::cout << "Error: --emit-cpp requires an output file" << std::endl;
+                    exit(1);
+                }
+                cpp = argv[++i];
+            }
+            else if (strncmp(argv[i], "--engine=", 9) == 0) {
+                std::cout << "Error: unknown engine <" << argv[i] + 9 << "> (use tree or vm)" << std::endl;
+                exit(1);
+            }
             else if (strcmp(argv[i], "-c") == 0) {
                 c = true;
             }
@@ -37,7 +95,6 @@ std::string parse_inputcommand(int argc, char** argv, bool& pt, bool& c, bool& v
             }
             else if (strcmp(argv[i], "-I") == 0) {
                 inp = true;
-                ars["args"] = new std::vector<long double>;
             }
             else if (strcmp(argv[i], "--help") == 0) {
                 print_man_page();
@@ -46,29 +103,61 @@ std::string parse_inputcommand(int argc, char** argv, bool& pt, bool& c, bool& v
             else if (isdigit(argv[i][1]) && inp){
                 std::string as_text = argv[i];
                 long double val = stod(as_text);
-                ars["args"]->push_back(val);
+                input.push_back(val);
             }
         } else if (codepath.empty()){
             codepath = argv[i];
         } else if (inp && !codepath.empty()) {
             std::string as_text = argv[i];
             long double val = stod(as_text);
-            ars["args"]->push_back(val);
+            input.push_back(val);
         }
     }
     return codepath;
 }
 
+//! Parse and Execute the Code with Values of Type T (double or long double)
+template<typename T>
+void interpret(const std::string& code, const std::string& path_to_code, bool pt, bool pb, bool c, bool inp, bool vm, const std::string& cpp, const std::vector<long double>& input) {
+    load_math_const<T>();
+    if (inp) {
+        ars<T>["args"] = new std::vector<T>(input.begin(), input.end());
+        nameContainer(ars<T>["args"], "args");
+    }
+
+    std::vector<std::vector<std::string> > tokens = lexer(code); // call the lexer to tokenize code
+    repairTokens(&tokens); // fix small errors in the token vector
+    if(c){ checkSyntax(tokens, true);} // if flag -c is activated -> only check code
+    checkSyntax(tokens, false); // check code without being verbose
+    Node* program_root = parseTree<T>(tokens,0); // parse the tokens and create tree
+    prepareTasks<T>(program_root); // analyze which spawned functions can run concurrently
+    if(pt){ printTreeRoot(program_root); exit(0);} // print tree and stop if flag -pt is set
+    if(!cpp.empty()){ emitCpp<T>(program_root, cpp, path_to_code); exit(0);} // translate to C++ and stop if flag --emit-cpp is set
+    if(auto_parallel){ parallelizeLoops<T>(program_root);} // run independent loops in parallel if flag --auto-parallel is set
+    if(vm || pb){
+        Program<T>* program = compileProgram<T>(program_root); // compile tree to bytecode
+        if(pb){ printBytecode(program); exit(0);} // print bytecode and stop if flag -pb is set
+        runProgram(program); // execute bytecode
+    }else{
+        execute<T>(program_root); // execute code
+    }
+}
+
 int main(int argc, char *argv[]) {
     std::cout.precision(17); // set precision for output
     std::string path_to_code; // the path to the code file
     bool pt = false; // flag for printing the parseTree
+    bool pb = false; // flag for printing the bytecode
     bool c = false; // bool for checking the syntax only
     bool v = false; // print version
     bool inp = false; // bool for reading input
+    bool vm = false; // execute with the bytecode machine instead of the tree walker
+    bool dbl = false; // compute with double instead of long double values
+    std::string cpp; // output file of the C++ translation
+    std::vector<long double> input; // initial input values (flag -I)
 
     // PARSE INPUT COMMANDS
-    path_to_code = parse_inputcommand(argc, argv, pt, c, v, inp);
+    path_to_code = parse_inputcommand(argc, argv, pt, pb, c, v, inp, vm, dbl, cpp, input);
 
     if (v) {
         std::cout << "SquareBracket Interpreter (Version 2.2.3 -- Rapid Red Panda / 2023)" << std::endl;
@@ -94,14 +183,14 @@ int main(int argc, char *argv[]) {
     } // read code line by line
 
     // INITIATE INTERPRETATION
-    load_math_const();
-
-    std::vector<std::vector<std::string> > tokens = lexer(code); // call the lexer to tokenize code
-    repairTokens(&tokens); // fix small errors in the token vector
-    if(c){ checkSyntax(tokens, true);} // if flag -c is activated -> only check code
-    checkSyntax(tokens, false); // check code without being verbose
-    Node* program_root = parseTree(tokens,0); // parse the tokens and create tree
-    if(pt){ printTreeRoot(program_root); exit(0);} // print tree and stop if flag -pt is set
-    execute(program_root); // execute code
+    if (dbl) {
+        if (jit_enabled) {
+            std::cerr << "Warning: --jit only supports --precision=long, the code is interpreted" << std::endl;
+            jit_enabled = false;
+        }
+        interpret<double>(code, path_to_code, pt, pb, c, inp, vm, cpp, input);
+    } else {
+        interpret<long double>(code, path_to_code, pt, pb, c, inp, vm, cpp, input);
+    }
     return 0;
 }